@@ -0,0 +1,159 @@
+/*
+** Throughput benchmark for the parsers that lemon generates.
+**
+** A random but deterministic token stream for bench.y is generated once
+** and then parsed repeatedly.  The best time of all repetitions is
+** reported together with a checksum of the semantic values, which must
+** be the same for every build of the grammar.
+**
+**     bench_table [NTOKEN [NREPEAT]]
+**     bench_direct [NTOKEN [NREPEAT]]
+**     bench_pipeline [NTOKEN [NREPEAT]]
+**
+** bench_pipeline is bench_table built with YYPIPELINE, and hands the
+** tokens to the parser on a second thread with ParsePipelinePush().
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "bench.h"
+
+void *BenchAlloc(void *(*)(size_t));
+void Bench(void*, int, int, int*);
+void BenchFree(void*, void (*)(void*));
+#ifdef YYPIPELINE
+void *BenchPipelineStart(void*, void *(*)(size_t), int*);
+void BenchPipelinePush(void*, int, int);
+void BenchPipelineFinish(void*, void (*)(void*));
+#endif
+
+static int *aMajor;      /* Token codes */
+static int *aMinor;      /* Token values */
+static int nToken;       /* Number of tokens in the stream */
+static int nAlloc;       /* Space allocated for aMajor[] and aMinor[] */
+static unsigned int rnd = 1;
+
+static unsigned int next_rand(unsigned int n){
+  rnd = rnd*1103515245 + 12345;
+  return (rnd>>16) % n;
+}
+
+static void emit(int major, int minor){
+  if( nToken>=nAlloc ){
+    nAlloc = nAlloc*2 + 1024;
+    aMajor = (int*)realloc(aMajor, nAlloc*sizeof(int));
+    aMinor = (int*)realloc(aMinor, nAlloc*sizeof(int));
+    if( aMajor==0 || aMinor==0 ){
+      fprintf(stderr, "out of memory\n");
+      exit(1);
+    }
+  }
+  aMajor[nToken] = major;
+  aMinor[nToken] = minor;
+  nToken++;
+}
+
+static void gen_expr(int depth){
+  static const int aOp[] = {
+    OR, AND, EQ, NE, LT, GT, PLUS, MINUS, TIMES, DIVIDE, MOD
+  };
+  int i, n;
+  switch( depth>0 ? next_rand(8) : next_rand(2) ){
+    case 0:  emit(NUM, next_rand(100)); break;
+    case 1:  emit(ID, next_rand(26)); break;
+    case 2:  emit(NOT, 0); gen_expr(depth-1); break;
+    case 3:  emit(MINUS, 0); gen_expr(depth-1); break;
+    case 4:  emit(LP, 0); gen_expr(depth-1); emit(RP, 0); break;
+    case 5:
+      emit(ID, next_rand(26));
+      emit(LP, 0);
+      n = next_rand(4);
+      for(i=0; i<n; i++){
+        if( i>0 ) emit(COMMA, 0);
+        gen_expr(depth-1);
+      }
+      emit(RP, 0);
+      break;
+    default:
+      gen_expr(depth-1);
+      emit(aOp[next_rand(sizeof(aOp)/sizeof(aOp[0]))], 0);
+      gen_expr(depth-1);
+      break;
+  }
+}
+
+static void gen_stmt(int depth){
+  int i, n;
+  switch( depth>0 ? next_rand(6) : next_rand(2) ){
+    case 0:  gen_expr(4); emit(SEMI, 0); break;
+    case 1:
+      emit(ID, next_rand(26));
+      emit(ASSIGN, 0);
+      gen_expr(4);
+      emit(SEMI, 0);
+      break;
+    case 2:
+    case 3:
+      emit(IF, 0);
+      emit(LP, 0);
+      gen_expr(3);
+      emit(RP, 0);
+      gen_stmt(depth-1);
+      if( next_rand(2) ){
+        emit(ELSE, 0);
+        gen_stmt(depth-1);
+      }
+      break;
+    default:
+      emit(LB, 0);
+      n = next_rand(4);
+      for(i=0; i<n; i++) gen_stmt(depth-1);
+      emit(RB, 0);
+      break;
+  }
+}
+
+static double now(void){
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec*1e-9;
+}
+
+int main(int argc, char **argv){
+  int nWant = argc>1 ? atoi(argv[1]) : 1000000;
+  int nRepeat = argc>2 ? atoi(argv[2]) : 10;
+  double best = 0.0;
+  int i, k, sum = 0;
+
+  while( nToken<nWant ) gen_stmt(3);
+  for(k=0; k<nRepeat; k++){
+    void *p;
+    double t0, t;
+    sum = 0;
+    t0 = now();
+    p = BenchAlloc(malloc);
+#ifdef YYPIPELINE
+    {
+      void *q = BenchPipelineStart(p, malloc, &sum);
+      if( q==0 ){
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+      }
+      for(i=0; i<nToken; i++) BenchPipelinePush(q, aMajor[i], aMinor[i]);
+      BenchPipelinePush(q, 0, 0);
+      BenchPipelineFinish(q, free);
+    }
+#else
+    for(i=0; i<nToken; i++) Bench(p, aMajor[i], aMinor[i], &sum);
+    Bench(p, 0, 0, &sum);
+#endif
+    BenchFree(p, free);
+    t = now() - t0;
+    if( k==0 || t<best ) best = t;
+  }
+  printf("%s: %d tokens, best of %d: %.4f s, %.1f Mtokens/s, checksum %d\n",
+         argv[0], nToken, nRepeat, best, nToken/best/1e6, sum);
+  free(aMajor);
+  free(aMinor);
+  return 0;
+}
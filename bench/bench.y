@@ -0,0 +1,54 @@
+/*
+** A small statement and expression grammar used to time the parsers
+** that lemon generates.  See bench.c.  The same grammar is built once
+** with the table-driven template and once with "lemon -d", so that the
+** two can be compared on an identical token stream.
+*/
+%name Bench
+%token_type {int}
+%type expr {int}
+%type args {int}
+%extra_argument {int *pSum}
+%include {
+#include <assert.h>
+}
+%syntax_error { (*pSum)--; }
+
+%nonassoc IF.
+%nonassoc ELSE.
+%left OR.
+%left AND.
+%left EQ NE LT GT.
+%left PLUS MINUS.
+%left TIMES DIVIDE MOD.
+%right NOT.
+
+program ::= stmts.
+stmts ::= stmts stmt.
+stmts ::= .
+stmt ::= expr(A) SEMI.                      { *pSum += A; }
+stmt ::= ID ASSIGN expr(A) SEMI.            { *pSum ^= A; }
+stmt ::= IF LP expr(C) RP stmt ELSE stmt.   { *pSum += C!=0; }
+stmt ::= IF LP expr(C) RP stmt. [IF]        { *pSum += C!=0; }
+stmt ::= LB stmts RB.
+stmt ::= error SEMI.
+expr(A) ::= expr(B) OR expr(C).             { A = B || C; }
+expr(A) ::= expr(B) AND expr(C).            { A = B && C; }
+expr(A) ::= expr(B) EQ expr(C).             { A = B==C; }
+expr(A) ::= expr(B) NE expr(C).             { A = B!=C; }
+expr(A) ::= expr(B) LT expr(C).             { A = B<C; }
+expr(A) ::= expr(B) GT expr(C).             { A = B>C; }
+expr(A) ::= expr(B) PLUS expr(C).           { A = B+C; }
+expr(A) ::= expr(B) MINUS expr(C).          { A = B-C; }
+expr(A) ::= expr(B) TIMES expr(C).          { A = B*C; }
+expr(A) ::= expr(B) DIVIDE expr(C).         { A = C ? B/C : 0; }
+expr(A) ::= expr(B) MOD expr(C).            { A = C ? B%C : 0; }
+expr(A) ::= NOT expr(B).                    { A = !B; }
+expr(A) ::= MINUS expr(B). [NOT]            { A = -B; }
+expr(A) ::= LP expr(B) RP.                  { A = B; }
+expr(A) ::= ID(X) LP args(B) RP.            { A = X+B; }
+expr(A) ::= ID(X) LP RP.                    { A = X; }
+expr(A) ::= ID(X).                          { A = X; }
+expr(A) ::= NUM(X).                         { A = X; }
+args(A) ::= expr(A).
+args(A) ::= args(B) COMMA expr(C).          { A = B+C; }
@@ -0,0 +1,493 @@
+/*
+** The author disclaims copyright to this source code.  In place of
+** a legal notice, here is a blessing:
+**
+**    May you do good and not evil.
+**    May you find forgiveness for yourself and forgive others.
+**    May you share freely, never taking more than you give.
+**
+*************************************************************************
+** The shared LEMON parser engine.
+**
+** This is the driver of lempar.c with every grammar-specific constant
+** replaced by a field of the lemonrt_grammar descriptor, and every piece
+** of grammar code replaced by a call through it.  See lemonrt.h.
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "lemonrt.h"
+
+/* The semantic value of stack entry I of parser P */
+#define rtMinor(P,I) \
+  ((void*)((P)->aMinor + (size_t)(I)*(size_t)(P)->pGrammar->szMinor))
+
+#ifndef NDEBUG
+static FILE *rtTraceFILE = 0;
+static char *rtTracePrompt = 0;
+
+/* The name of symbol X of grammar G, for tracing */
+#define rtTokenName(G,X) ((G)->azTokenName ? (G)->azTokenName[X] : "?")
+#endif /* NDEBUG */
+
+/*
+** Turn tracing on by giving a stream to which to write the trace and a
+** prompt to preface each trace message.  Tracing is turned off by making
+** either argument NULL.  The setting applies to every parser.
+*/
+void lemonrt_trace(FILE *TraceFILE, char *zTracePrompt){
+#ifndef NDEBUG
+  rtTraceFILE = TraceFILE;
+  rtTracePrompt = zTracePrompt;
+  if( rtTraceFILE==0 ) rtTracePrompt = 0;
+  else if( rtTracePrompt==0 ) rtTraceFILE = 0;
+#endif
+}
+
+/*
+** Try to increase the size of the parser stack.  The stack does not grow
+** beyond the nStackDepth of the grammar.  Return non-zero if the stack
+** could not grow.
+*/
+static int rtGrowStack(lemonrt_parser *p){
+  const lemonrt_grammar *pG = p->pGrammar;
+  int newSize;
+  lemonrt_entry *pNew;
+  char *pNewMinor;
+
+  newSize = p->stksz*2 + 100;
+  if( pG->nStackDepth>0 ){
+    if( p->stksz>=pG->nStackDepth ) return 1;
+    if( newSize>pG->nStackDepth ) newSize = pG->nStackDepth;
+  }
+  pNew = (lemonrt_entry*)realloc(p->aStack, newSize*sizeof(pNew[0]));
+  if( pNew==0 ) return 1;
+  p->aStack = pNew;
+  pNewMinor = (char*)realloc(p->aMinor, newSize*(size_t)pG->szMinor);
+  if( pNewMinor==0 ) return 1;
+  p->aMinor = pNewMinor;
+  p->stksz = newSize;
+#ifndef NDEBUG
+  if( rtTraceFILE ){
+    fprintf(rtTraceFILE,"%sStack grows to %d entries!\n",
+            rtTracePrompt, p->stksz);
+  }
+#endif
+  return 0;
+}
+
+/*
+** Initialize a parser for grammar pG.
+*/
+void lemonrt_init(lemonrt_parser *p, const lemonrt_grammar *pG){
+  p->pGrammar = pG;
+  p->idx = -1;
+  p->idxMax = 0;
+  p->errcnt = -1;
+  p->stksz = 0;
+  p->aStack = 0;
+  p->aMinor = 0;
+  rtGrowStack(p);
+}
+
+/*
+** Pop the parser's stack once, running the destructor of the value that
+** is popped.
+*/
+static void rtPopParserStack(lemonrt_parser *p){
+  lemonrt_entry *yytos;
+  assert( p->idx>=0 );
+  yytos = &p->aStack[p->idx];
+#ifndef NDEBUG
+  if( rtTraceFILE ){
+    fprintf(rtTraceFILE,"%sPopping %s\n", rtTracePrompt,
+            rtTokenName(p->pGrammar, yytos->major));
+  }
+#endif
+  p->idx--;
+  p->pGrammar->xDestructor(p, yytos->major, rtMinor(p, p->idx+1));
+}
+
+/*
+** Destroy a parser.  Destructors are called for all stack elements.  The
+** memory of the lemonrt_parser object itself is not freed.
+*/
+void lemonrt_finalize(lemonrt_parser *p){
+  while( p->idx>=0 ) rtPopParserStack(p);
+  free(p->aStack);
+  free(p->aMinor);
+  p->aStack = 0;
+  p->aMinor = 0;
+  p->stksz = 0;
+}
+
+/*
+** Return the peak depth of the stack for a parser.
+*/
+int lemonrt_stack_peak(const lemonrt_parser *p){
+  return p->idxMax;
+}
+
+/*
+** Find the appropriate action for a parser given the terminal
+** look-ahead token iLookAhead.
+*/
+static unsigned int rtFindShiftAction(lemonrt_parser *p, int iLookAhead){
+  const lemonrt_grammar *pG = p->pGrammar;
+  int i;
+  int stateno = p->aStack[p->idx].stateno;
+
+  if( stateno>=pG->minReduce ) return stateno;
+  if( stateno>pG->shiftCount ) return pG->aDefault[stateno];
+  do{
+    i = pG->aShiftOfst[stateno];
+    if( i==pG->shiftUseDflt ) return pG->aDefault[stateno];
+    assert( iLookAhead!=pG->nNoCode );
+    i += iLookAhead;
+    if( i<0 || i>=pG->nActTab || pG->aLookahead[i]!=iLookAhead ){
+      if( iLookAhead>0 ){
+        int iFallback;            /* Fallback token */
+        int j;
+        if( iLookAhead<pG->nFallback
+               && (iFallback = pG->aFallback[iLookAhead])!=0 ){
+#ifndef NDEBUG
+          if( rtTraceFILE ){
+            fprintf(rtTraceFILE, "%sFALLBACK %s => %s\n", rtTracePrompt,
+               rtTokenName(pG, iLookAhead), rtTokenName(pG, iFallback));
+          }
+#endif
+          assert( pG->aFallback[iFallback]==0 ); /* Loop must terminate */
+          iLookAhead = iFallback;
+          continue;
+        }
+        j = i - iLookAhead + pG->iWildcard;
+        if( pG->iWildcard && j>=0 && j<pG->nActTab
+         && pG->aLookahead[j]==pG->iWildcard ){
+#ifndef NDEBUG
+          if( rtTraceFILE ){
+            fprintf(rtTraceFILE, "%sWILDCARD %s => %s\n", rtTracePrompt,
+               rtTokenName(pG, iLookAhead), rtTokenName(pG, pG->iWildcard));
+          }
+#endif
+          return pG->aAction[j];
+        }
+      }
+      return pG->aDefault[stateno];
+    }else{
+      return pG->aAction[i];
+    }
+  }while(1);
+}
+
+/*
+** Find the appropriate action for a parser given the non-terminal
+** look-ahead token iLookAhead.
+*/
+static int rtFindReduceAction(
+  const lemonrt_grammar *pG,   /* The grammar */
+  int stateno,                 /* Current state number */
+  int iLookAhead               /* The look-ahead token */
+){
+  int i;
+  /* Unlike lempar.c, the lookups are bounds-checked even without an error
+  ** symbol, since the tables may come from a file (see lemonrt_load()) */
+  if( stateno>pG->reduceCount ){
+    assert( pG->iErrorSymbol );
+    return pG->aDefault[stateno];
+  }
+  i = pG->aReduceOfst[stateno];
+  assert( i!=pG->reduceUseDflt );
+  assert( iLookAhead!=pG->nNoCode );
+  i += iLookAhead;
+  if( i<0 || i>=pG->nActTab || pG->aLookahead[i]!=iLookAhead ){
+    assert( pG->iErrorSymbol );
+    return pG->aDefault[stateno];
+  }
+  return pG->aAction[i];
+}
+
+/*
+** The following routine is called if the stack overflows.
+*/
+static void rtStackOverflow(lemonrt_parser *p){
+  p->idx--;
+#ifndef NDEBUG
+  if( rtTraceFILE ){
+    fprintf(rtTraceFILE,"%sStack Overflow!\n",rtTracePrompt);
+  }
+#endif
+  while( p->idx>=0 ) rtPopParserStack(p);
+  p->pGrammar->xStackOverflow(p);
+}
+
+/*
+** Print tracing information for a SHIFT action
+*/
+#ifndef NDEBUG
+static void rtTraceShift(lemonrt_parser *p, int yyNewState){
+  if( rtTraceFILE ){
+    const lemonrt_grammar *pG = p->pGrammar;
+    if( yyNewState<pG->nState ){
+      fprintf(rtTraceFILE,"%sShift '%s', go to state %d\n", rtTracePrompt,
+         rtTokenName(pG, p->aStack[p->idx].major), yyNewState);
+    }else{
+      fprintf(rtTraceFILE,"%sShift '%s'\n", rtTracePrompt,
+         rtTokenName(pG, p->aStack[p->idx].major));
+    }
+  }
+}
+#else
+# define rtTraceShift(X,Y)
+#endif
+
+/*
+** Perform a shift action.
+*/
+static void rtShift(
+  lemonrt_parser *p,            /* The parser to be shifted */
+  int yyNewState,               /* The new state to shift in */
+  int yyMajor,                  /* The major token to shift in */
+  void *pMinor                  /* The minor token to shift in */
+){
+  lemonrt_entry *yytos;
+  p->idx++;
+  if( p->idx>p->idxMax ){
+    p->idxMax = p->idx;
+  }
+  if( p->idx>=p->stksz ){
+    if( rtGrowStack(p) || p->idx>=p->stksz ){
+      rtStackOverflow(p);
+      return;
+    }
+  }
+  yytos = &p->aStack[p->idx];
+  yytos->stateno = (lemonrt_action)yyNewState;
+  yytos->major = (lemonrt_code)yyMajor;
+  memcpy(rtMinor(p, p->idx), pMinor, p->pGrammar->szMinor);
+  rtTraceShift(p, yyNewState);
+}
+
+/*
+** The following is executed when the parser accepts
+*/
+static void rtAccept(lemonrt_parser *p){
+#ifndef NDEBUG
+  if( rtTraceFILE ){
+    fprintf(rtTraceFILE,"%sAccept!\n",rtTracePrompt);
+  }
+#endif
+  while( p->idx>=0 ) rtPopParserStack(p);
+  p->pGrammar->xAccept(p);
+}
+
+/*
+** The following code executes when the parse fails
+*/
+static void rtParseFailed(lemonrt_parser *p){
+#ifndef NDEBUG
+  if( rtTraceFILE ){
+    fprintf(rtTraceFILE,"%sFail!\n",rtTracePrompt);
+  }
+#endif
+  while( p->idx>=0 ) rtPopParserStack(p);
+  p->pGrammar->xParseFailed(p);
+}
+
+/*
+** Perform a reduce action and the shift that must immediately
+** follow the reduce.  The return value is as for yy_reduce() in
+** lempar.c.
+*/
+static int rtReduce(lemonrt_parser *p, int yyruleno){
+  const lemonrt_grammar *pG = p->pGrammar;
+  int yygoto;                     /* The next state */
+  int yyact;                      /* The next action */
+  lemonrt_entry *yymsp;           /* The top of the parser's stack */
+  int yysize;                     /* Amount to pop the stack */
+
+  assert( yyruleno<pG->nRule );
+  yysize = pG->aRuleInfo[yyruleno].nrhs;
+#ifndef NDEBUG
+  if( rtTraceFILE && pG->azRuleName ){
+    fprintf(rtTraceFILE, "%sReduce [%s], go to state %d.\n", rtTracePrompt,
+      pG->azRuleName[yyruleno], p->aStack[p->idx-yysize].stateno);
+  }
+#endif /* NDEBUG */
+
+  /* Check that the stack is large enough to grow by a single entry
+  ** if the RHS of the rule is empty.  This ensures that there is room
+  ** enough on the stack to push the LHS value */
+  if( yysize==0 ){
+    if( p->idx>p->idxMax ){
+      p->idxMax = p->idx;
+    }
+    if( p->idx>=p->stksz-1 ){
+      rtGrowStack(p);
+      if( p->idx>=p->stksz-1 ){
+        rtStackOverflow(p);
+        return pG->noAction;
+      }
+    }
+  }
+
+  yymsp = &p->aStack[p->idx];
+  pG->xReduce(p, yyruleno, yymsp, rtMinor(p, p->idx));
+  yygoto = pG->aRuleInfo[yyruleno].lhs;
+  yyact = rtFindReduceAction(pG, yymsp[-yysize].stateno, yygoto);
+  if( yyact <= pG->maxShiftReduce ){
+    if( yyact>pG->maxShift ) yyact += pG->minReduce - pG->minShiftReduce;
+    p->idx -= yysize - 1;
+    yymsp -= yysize-1;
+    yymsp->stateno = (lemonrt_action)yyact;
+    yymsp->major = (lemonrt_code)yygoto;
+    rtTraceShift(p, yyact);
+  }else{
+    assert( yyact == pG->acceptAction );
+    p->idx -= yysize;
+    rtAccept(p);
+  }
+  return yyact;
+}
+
+/* The main parser program.  This is Parse() of lempar.c, except that
+** the minor token is passed as a pointer to a complete semantic value
+** whose yy0 member holds the token.
+*/
+void lemonrt_parse(
+  lemonrt_parser *p,           /* The parser */
+  int yymajor,                 /* The major token code number */
+  void *pMinor                 /* The value for the token */
+){
+  const lemonrt_grammar *pG = p->pGrammar;
+  unsigned int yyact;          /* The parser action. */
+  int yyendofinput;            /* True if we are at the end of input */
+  int yyerrorhit = 0;          /* True if yymajor has invoked an error */
+
+  /* (re)initialize the parser, if necessary */
+  if( p->idx<0 ){
+    if( p->stksz<=0 ){
+      p->idx = 0;
+      rtStackOverflow(p);
+      return;
+    }
+    p->idx = 0;
+    p->errcnt = -1;
+    p->aStack[0].stateno = 0;
+    p->aStack[0].major = 0;
+#ifndef NDEBUG
+    if( rtTraceFILE ){
+      fprintf(rtTraceFILE,"%sInitialize. Empty stack. State 0\n",
+              rtTracePrompt);
+    }
+#endif
+  }
+  yyendofinput = (yymajor==0);
+
+#ifndef NDEBUG
+  if( rtTraceFILE ){
+    fprintf(rtTraceFILE,"%sInput '%s'\n",rtTracePrompt,
+            rtTokenName(pG, yymajor));
+  }
+#endif
+
+  do{
+    yyact = rtFindShiftAction(p, yymajor);
+    if( yyact <= (unsigned)pG->maxShiftReduce ){
+      if( yyact > (unsigned)pG->maxShift ){
+        yyact += pG->minReduce - pG->minShiftReduce;
+      }
+      rtShift(p, yyact, yymajor, pMinor);
+      p->errcnt--;
+      yymajor = pG->nNoCode;
+      if( !pG->lazyReduce ){
+        /* The new state can only reduce, so do that now rather than when
+        ** the next token arrives */
+        while( yyact>=(unsigned)pG->minReduce
+            && yyact<=(unsigned)pG->maxReduce && p->idx>=0 ){
+          yyact = rtReduce(p, yyact-pG->minReduce);
+        }
+      }
+    }else if( yyact <= (unsigned)pG->maxReduce ){
+      /* Run reductions back-to-back for as long as each goto lands in
+      ** a state that can only reduce */
+      do{
+        yyact = rtReduce(p, yyact-pG->minReduce);
+      }while( yyact>=(unsigned)pG->minReduce
+           && yyact<=(unsigned)pG->maxReduce );
+    }else{
+      assert( yyact == (unsigned)pG->errorAction );
+#ifndef NDEBUG
+      if( rtTraceFILE ){
+        fprintf(rtTraceFILE,"%sSyntax Error!\n",rtTracePrompt);
+      }
+#endif
+      if( pG->iErrorSymbol ){
+        /* Report the error, then pop the stack until the error symbol
+        ** can be shifted, and accept no new error until three tokens
+        ** have been shifted.  See lempar.c. */
+        int yymx;
+        if( p->errcnt<0 ){
+          pG->xSyntaxError(p, yymajor, pMinor);
+        }
+        yymx = p->aStack[p->idx].major;
+        if( yymx==pG->iErrorSymbol || yyerrorhit ){
+#ifndef NDEBUG
+          if( rtTraceFILE ){
+            fprintf(rtTraceFILE,"%sDiscard input token %s\n",
+               rtTracePrompt,rtTokenName(pG, yymajor));
+          }
+#endif
+          pG->xDestructor(p, yymajor, pMinor);
+          yymajor = pG->nNoCode;
+        }else{
+          while(
+            p->idx >= 0 &&
+            yymx != pG->iErrorSymbol &&
+            (yyact = rtFindReduceAction(pG, p->aStack[p->idx].stateno,
+                                        pG->iErrorSymbol))
+                   >= (unsigned)pG->minReduce
+          ){
+            rtPopParserStack(p);
+          }
+          if( p->idx < 0 || yymajor==0 ){
+            pG->xDestructor(p, yymajor, pMinor);
+            rtParseFailed(p);
+            yymajor = pG->nNoCode;
+          }else if( yymx!=pG->iErrorSymbol ){
+            rtShift(p, yyact, pG->iErrorSymbol, pMinor);
+          }
+        }
+        p->errcnt = 3;
+        yyerrorhit = 1;
+      }else if( pG->noErrorRecovery ){
+        /* Report the error and go on as if nothing had happened */
+        pG->xSyntaxError(p, yymajor, pMinor);
+        pG->xDestructor(p, yymajor, pMinor);
+        yymajor = pG->nNoCode;
+      }else{
+        /* Report the error, throw away the input token and fail the
+        ** parse at the end of the input */
+        if( p->errcnt<=0 ){
+          pG->xSyntaxError(p, yymajor, pMinor);
+        }
+        p->errcnt = 3;
+        pG->xDestructor(p, yymajor, pMinor);
+        if( yyendofinput ){
+          rtParseFailed(p);
+        }
+        yymajor = pG->nNoCode;
+      }
+    }
+  }while( yymajor!=pG->nNoCode && p->idx>=0 );
+#ifndef NDEBUG
+  if( rtTraceFILE ){
+    int i;
+    fprintf(rtTraceFILE,"%sReturn. Stack=",rtTracePrompt);
+    for(i=1; i<=p->idx; i++)
+      fprintf(rtTraceFILE,"%c%s", i==1 ? '[' : ' ',
+              rtTokenName(pG, p->aStack[i].major));
+    fprintf(rtTraceFILE,"]\n");
+  }
+#endif
+  return;
+}
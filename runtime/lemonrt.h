@@ -0,0 +1,190 @@
+/*
+** The author disclaims copyright to this source code.  In place of
+** a legal notice, here is a blessing:
+**
+**    May you do good and not evil.
+**    May you find forgiveness for yourself and forgive others.
+**    May you share freely, never taking more than you give.
+**
+*************************************************************************
+** Interface to the shared LEMON parser engine.
+**
+** A parser generated with the "-e" option of lemon does not contain its
+** own copy of the shift/reduce engine.  It holds only the parsing tables
+** of its grammar, the code of the grammar actions and a descriptor, an
+** instance of lemonrt_grammar that points to both.  The engine in
+** lemonrt.c runs any number of such grammars.  It keeps no state of its
+** own apart from the trace stream, so parsers of different grammars can
+** be used side by side, and on different threads.
+*/
+#ifndef LEMONRT_H
+#define LEMONRT_H
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The types of the parsing tables of a grammar for the shared engine.
+** lemon checks that the action codes and the symbol codes of a grammar
+** fit into them. */
+typedef unsigned short lemonrt_action;   /* An action code */
+typedef unsigned short lemonrt_code;     /* A symbol code */
+typedef int lemonrt_offset;              /* An offset into the action table */
+
+typedef struct lemonrt_entry lemonrt_entry;
+typedef struct lemonrt_rule lemonrt_rule;
+typedef struct lemonrt_grammar lemonrt_grammar;
+typedef struct lemonrt_parser lemonrt_parser;
+
+/* One entry of the parser's stack.  The semantic values are kept in a
+** separate array, as with lemon's -S option. */
+struct lemonrt_entry {
+  lemonrt_action stateno;   /* The state-number, or the reduce action of a
+                            ** SHIFTREDUCE */
+  lemonrt_code major;       /* The major token value */
+};
+
+/* The symbol on the left-hand side and the length of a rule */
+struct lemonrt_rule {
+  lemonrt_code lhs;         /* Symbol on the left-hand side of the rule */
+  unsigned char nrhs;       /* Number of right-hand side symbols */
+};
+
+/* The description of a grammar.  Generated parsers define one of these
+** as a constant and hand it to lemonrt_init().  The meaning of the
+** numbers is that of the YY... macros of the same names in lempar.c.
+*/
+struct lemonrt_grammar {
+  int nState;               /* YYNSTATE */
+  int nRule;                /* YYNRULE */
+  int nNoCode;              /* YYNOCODE */
+  int szMinor;              /* sizeof(YYMINORTYPE) */
+  int nStackDepth;          /* YYSTACKDEPTH, or 0 for no limit */
+  int iErrorSymbol;         /* YYERRORSYMBOL, or 0 without error recovery */
+  int noErrorRecovery;      /* True if YYNOERRORRECOVERY is defined */
+  int lazyReduce;           /* True if YYLAZYREDUCE is defined */
+  unsigned int fingerprint; /* YYFINGERPRINT, a hash of symbols and rules */
+  int nRhsMax;              /* YYNRHSMAX */
+  int maxShift;             /* YY_MAX_SHIFT */
+  int minShiftReduce;       /* YY_MIN_SHIFTREDUCE */
+  int maxShiftReduce;       /* YY_MAX_SHIFTREDUCE */
+  int minReduce;            /* YY_MIN_REDUCE */
+  int maxReduce;            /* YY_MAX_REDUCE */
+  int errorAction;          /* YY_ERROR_ACTION */
+  int acceptAction;         /* YY_ACCEPT_ACTION */
+  int noAction;             /* YY_NO_ACTION */
+  int nActTab;              /* YY_ACTTAB_COUNT */
+  const lemonrt_action *aAction;      /* yy_action[] */
+  const lemonrt_code *aLookahead;     /* yy_lookahead[] */
+  int shiftUseDflt;         /* YY_SHIFT_USE_DFLT */
+  int shiftCount;           /* YY_SHIFT_COUNT */
+  const lemonrt_offset *aShiftOfst;   /* yy_shift_ofst[] */
+  int reduceUseDflt;        /* YY_REDUCE_USE_DFLT */
+  int reduceCount;          /* YY_REDUCE_COUNT */
+  const lemonrt_offset *aReduceOfst;  /* yy_reduce_ofst[] */
+  const lemonrt_action *aDefault;     /* yy_default[] */
+  int nFallback;            /* Entries in aFallback[] */
+  const lemonrt_code *aFallback;      /* yyFallback[], or NULL */
+  int iWildcard;            /* YYWILDCARD, or 0 */
+  const lemonrt_rule *aRuleInfo;      /* yyRuleInfo[] */
+  const char *const *azTokenName;     /* yyTokenName[], or NULL */
+  const char *const *azRuleName;      /* yyRuleName[], or NULL */
+
+  /* The code of the grammar.  xReduce() runs the action of rule ruleno.
+  ** yymsp is the top of the stack and yymvp the semantic value of the
+  ** top of the stack. */
+  void (*xReduce)(lemonrt_parser*, int ruleno, lemonrt_entry *yymsp,
+                  void *yymvp);
+  void (*xDestructor)(lemonrt_parser*, int major, void *pMinor);
+  void (*xStackOverflow)(lemonrt_parser*);
+  void (*xSyntaxError)(lemonrt_parser*, int major, void *pMinor);
+  void (*xParseFailed)(lemonrt_parser*);
+  void (*xAccept)(lemonrt_parser*);
+};
+
+/* The state of one parser.  A generated parser embeds this as the first
+** member of its own parser object. */
+struct lemonrt_parser {
+  const lemonrt_grammar *pGrammar;  /* The grammar being parsed */
+  int idx;                  /* Index of top element in stack */
+  int idxMax;               /* Maximum value of idx */
+  int errcnt;               /* Shifts left before out of the error */
+  int stksz;                /* Current size of the stack */
+  lemonrt_entry *aStack;    /* The parser's stack */
+  char *aMinor;             /* Semantic values, szMinor bytes each */
+};
+
+/* The header of a table file, as written by the "-B" option of lemon.
+** A table file holds the parsing tables of a grammar in the layout of the
+** lemonrt_grammar arrays, so that lemonrt_load() can map the file into
+** memory and use the tables in place.  All numbers are in the byte order
+** of the machine that wrote the file.  Each table starts at a multiple of
+** 8 bytes from the beginning of the file, at the offset given for it in
+** the header.  The token names and the rule names are NUL-terminated
+** strings, one after the other, and run up to the next table or to the
+** end of the file.
+*/
+#define LEMONRT_MAGIC     "LEMT"
+#define LEMONRT_VERSION   2
+#define LEMONRT_BYTEORDER 0x01020304
+struct lemonrt_file_header {
+  char zMagic[4];           /* LEMONRT_MAGIC, without the NUL */
+  int iVersion;             /* LEMONRT_VERSION */
+  int iByteOrder;           /* LEMONRT_BYTEORDER */
+  int nFileSize;            /* Size of the file in bytes */
+  int nState;               /* The lemonrt_grammar fields of the same name */
+  int nRule;
+  int nNoCode;
+  int iErrorSymbol;
+  int maxShift;
+  int minShiftReduce;
+  int maxShiftReduce;
+  int minReduce;
+  int maxReduce;
+  int errorAction;
+  int acceptAction;
+  int noAction;
+  int nActTab;
+  int shiftUseDflt;
+  int shiftCount;
+  int reduceUseDflt;
+  int reduceCount;
+  int nFallback;
+  int iWildcard;
+  int nSymbol;              /* Number of token names */
+  int ofstAction;           /* Offset of aAction[nActTab] */
+  int ofstLookahead;        /* Offset of aLookahead[nActTab] */
+  int ofstShiftOfst;        /* Offset of aShiftOfst[shiftCount+1] */
+  int ofstReduceOfst;       /* Offset of aReduceOfst[reduceCount+1] */
+  int ofstDefault;          /* Offset of aDefault[nState] */
+  int ofstFallback;         /* Offset of aFallback[nFallback] */
+  int ofstRuleInfo;         /* Offset of aRuleInfo[nRule] */
+  int ofstTokenName;        /* Offset of the nSymbol token names */
+  int ofstRuleName;         /* Offset of the nRule rule names */
+  unsigned int fingerprint; /* YYFINGERPRINT of the grammar */
+};
+
+void lemonrt_init(lemonrt_parser*, const lemonrt_grammar*);
+void lemonrt_finalize(lemonrt_parser*);
+void lemonrt_parse(lemonrt_parser*, int major, void *pMinor);
+int lemonrt_stack_peak(const lemonrt_parser*);
+void lemonrt_trace(FILE *TraceFILE, char *zTracePrompt);
+
+/* Grammars loaded from table files.  The code of the grammar, that is the
+** fields szMinor to nRhsMax and xReduce to xAccept, is taken from pCode.
+** Everything else comes from the file.  The file must have been written
+** for the same symbols and rules as pCode, as told by the fingerprint.
+** On failure NULL is returned and, if pzErr is not NULL, *pzErr is set to
+** a description of the problem. */
+const lemonrt_grammar *lemonrt_load(
+  const char *zFilename,
+  const lemonrt_grammar *pCode,
+  const char **pzErr
+);
+void lemonrt_unload(const lemonrt_grammar*);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* LEMONRT_H */
@@ -0,0 +1,332 @@
+/*
+** The author disclaims copyright to this source code.  In place of
+** a legal notice, here is a blessing:
+**
+**    May you do good and not evil.
+**    May you find forgiveness for yourself and forgive others.
+**    May you share freely, never taking more than you give.
+**
+*************************************************************************
+** Loading grammars for the shared LEMON parser engine from the table
+** files written by the "-B" option of lemon.
+**
+** The file is mapped into memory read-only and the tables are used where
+** they lie, so the processes that load the same file share one copy of
+** it.  Only the arrays of pointers to the token and rule names are built
+** at load time.  Where mmap() is not available (or LEMONRT_NO_MMAP is
+** defined) the file is read into memory instead.
+*/
+#include <stdlib.h>
+#include <string.h>
+#include "lemonrt.h"
+
+#if defined(_WIN32) && !defined(LEMONRT_NO_MMAP)
+# define LEMONRT_NO_MMAP 1
+#endif
+#ifndef LEMONRT_NO_MMAP
+# include <sys/types.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+/* A grammar loaded from a table file */
+typedef struct rtLoaded rtLoaded;
+struct rtLoaded {
+  lemonrt_grammar g;          /* The grammar.  Must be the first member */
+  const char *pFile;          /* The content of the table file */
+  size_t nFile;               /* Size of the table file in bytes */
+  int isMapped;               /* True if pFile is from mmap() */
+  const char **azName;        /* Token names, then rule names */
+};
+
+/*
+** Bring the content of file zFilename into memory.  Return a pointer to
+** it, or NULL on failure.
+*/
+static const char *rtReadFile(
+  const char *zFilename,
+  size_t *pnFile,
+  int *pIsMapped
+){
+#ifndef LEMONRT_NO_MMAP
+  int fd;
+  struct stat st;
+  void *p;
+
+  fd = open(zFilename, O_RDONLY);
+  if( fd<0 ) return 0;
+  if( fstat(fd, &st)!=0 || st.st_size<=0 ){
+    close(fd);
+    return 0;
+  }
+  p = mmap(0, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if( p==MAP_FAILED ) return 0;
+  *pnFile = (size_t)st.st_size;
+  *pIsMapped = 1;
+  return (const char*)p;
+#else
+  FILE *in;
+  long n;
+  char *p;
+
+  in = fopen(zFilename, "rb");
+  if( in==0 ) return 0;
+  if( fseek(in, 0, SEEK_END)!=0 || (n = ftell(in))<=0
+   || fseek(in, 0, SEEK_SET)!=0 ){
+    fclose(in);
+    return 0;
+  }
+  p = (char*)malloc((size_t)n);
+  if( p && fread(p, 1, (size_t)n, in)!=(size_t)n ){
+    free(p);
+    p = 0;
+  }
+  fclose(in);
+  *pnFile = (size_t)n;
+  *pIsMapped = 0;
+  return p;
+#endif
+}
+
+/*
+** Release the content of a table file.
+*/
+static void rtReleaseFile(const char *pFile, size_t nFile, int isMapped){
+#ifndef LEMONRT_NO_MMAP
+  if( isMapped ){
+    munmap((void*)pFile, nFile);
+    return;
+  }
+#endif
+  (void)nFile;
+  (void)isMapped;
+  free((void*)pFile);
+}
+
+/*
+** Return true if a table of nEntry entries of szEntry bytes each, at
+** offset iOfst, lies within a file of nFile bytes and is aligned.
+*/
+static int rtTableOk(size_t nFile, int iOfst, int nEntry, size_t szEntry){
+  if( iOfst<(int)sizeof(struct lemonrt_file_header) || iOfst%8 ) return 0;
+  if( nEntry<0 ) return 0;
+  return (size_t)iOfst + (size_t)nEntry*szEntry <= nFile;
+}
+
+/*
+** Return true if iAction is a valid action code for the grammar.
+*/
+static int rtActionOk(const struct lemonrt_file_header *h, int iAction){
+  return iAction<=h->maxShift
+      || (iAction>=h->minShiftReduce && iAction<=h->noAction);
+}
+
+/*
+** Check the header and the tables of a table file against the code of
+** the grammar in pCode.  Return NULL if they are usable, or else a
+** description of the problem.
+*/
+static const char *rtCheckFile(
+  const struct lemonrt_file_header *h,
+  const lemonrt_grammar *pCode,
+  const char *pFile,
+  size_t nFile
+){
+  const lemonrt_action *aAction;
+  const lemonrt_code *aCode;
+  const lemonrt_rule *aRule;
+  int i;
+
+  if( memcmp(h->zMagic, LEMONRT_MAGIC, 4)!=0 ){
+    return "not a lemon table file";
+  }
+  if( h->iVersion!=LEMONRT_VERSION ) return "unsupported table file version";
+  if( h->iByteOrder!=LEMONRT_BYTEORDER ) return "wrong byte order";
+  if( (size_t)h->nFileSize!=nFile ) return "truncated table file";
+  if( sizeof(lemonrt_rule)!=4 ) return "unsupported rule table layout";
+  if( h->fingerprint!=pCode->fingerprint || h->nRule!=pCode->nRule
+   || h->nNoCode!=pCode->nNoCode || h->nSymbol!=pCode->nNoCode-1 ){
+    return "table file is for another grammar";
+  }
+  if( h->nState<=0 || h->nRule<=0 || h->nNoCode<=1 || h->nNoCode>0xffff
+   || h->nSymbol!=h->nNoCode-1
+   || h->iErrorSymbol<0 || h->iErrorSymbol>=h->nNoCode
+   || h->iWildcard<0 || h->iWildcard>=h->nNoCode
+   || h->maxShift!=h->nState-1
+   || h->maxShiftReduce!=h->minShiftReduce+h->nRule-1
+   || h->minReduce!=h->maxShiftReduce+1
+   || h->maxReduce!=h->minReduce+h->nRule-1
+   || h->errorAction!=h->maxReduce+1
+   || h->acceptAction!=h->errorAction+1
+   || h->noAction!=h->acceptAction+1 || h->noAction>0xffff
+   || h->minShiftReduce<h->nState
+   || h->shiftCount>=h->nState || h->reduceCount>=h->nState
+   || h->nFallback<0 || h->nFallback>h->nNoCode ){
+    return "inconsistent table file header";
+  }
+  if( !rtTableOk(nFile, h->ofstAction, h->nActTab, sizeof(lemonrt_action))
+   || !rtTableOk(nFile, h->ofstLookahead, h->nActTab, sizeof(lemonrt_code))
+   || !rtTableOk(nFile, h->ofstShiftOfst, h->shiftCount+1,
+                 sizeof(lemonrt_offset))
+   || !rtTableOk(nFile, h->ofstReduceOfst, h->reduceCount+1,
+                 sizeof(lemonrt_offset))
+   || !rtTableOk(nFile, h->ofstDefault, h->nState, sizeof(lemonrt_action))
+   || !rtTableOk(nFile, h->ofstFallback, h->nFallback, sizeof(lemonrt_code))
+   || !rtTableOk(nFile, h->ofstRuleInfo, h->nRule, sizeof(lemonrt_rule))
+   || !rtTableOk(nFile, h->ofstTokenName, 0, 1)
+   || !rtTableOk(nFile, h->ofstRuleName, 0, 1) ){
+    return "table outside of the table file";
+  }
+
+  /* Every action, symbol and rule in the tables must be in range */
+  aAction = (const lemonrt_action*)(pFile + h->ofstAction);
+  for(i=0; i<h->nActTab; i++){
+    if( !rtActionOk(h, aAction[i]) ) return "bad action in yy_action[]";
+  }
+  aAction = (const lemonrt_action*)(pFile + h->ofstDefault);
+  for(i=0; i<h->nState; i++){
+    if( !rtActionOk(h, aAction[i]) ) return "bad action in yy_default[]";
+  }
+  aCode = (const lemonrt_code*)(pFile + h->ofstLookahead);
+  for(i=0; i<h->nActTab; i++){
+    if( aCode[i]>=h->nNoCode ) return "bad symbol in yy_lookahead[]";
+  }
+  aCode = (const lemonrt_code*)(pFile + h->ofstFallback);
+  for(i=0; i<h->nFallback; i++){
+    if( aCode[i]>=h->nFallback || aCode[aCode[i]]!=0 ){
+      return "bad symbol in yyFallback[]";
+    }
+  }
+  aRule = (const lemonrt_rule*)(pFile + h->ofstRuleInfo);
+  for(i=0; i<h->nRule; i++){
+    if( aRule[i].lhs>=h->nNoCode || aRule[i].nrhs>pCode->nRhsMax ){
+      return "bad rule in yyRuleInfo[]";
+    }
+  }
+  return 0;
+}
+
+/*
+** Set azName[0..n-1] to the n NUL-terminated strings that start at
+** offset iOfst of the file.  Return the offset past the last string, or
+** -1 if they do not end within the file.
+*/
+static int rtFindNames(
+  const char *pFile,
+  size_t nFile,
+  int iOfst,
+  int n,
+  const char **azName
+){
+  int i;
+  for(i=0; i<n; i++){
+    const char *z = pFile + iOfst;
+    const char *zEnd = memchr(z, 0, nFile - (size_t)iOfst);
+    if( zEnd==0 ) return -1;
+    azName[i] = z;
+    iOfst += (int)(zEnd - z) + 1;
+  }
+  return iOfst;
+}
+
+/*
+** Load a grammar from the table file zFilename.  The tables are taken
+** from the file and the code of the grammar from pCode.
+*/
+const lemonrt_grammar *lemonrt_load(
+  const char *zFilename,
+  const lemonrt_grammar *pCode,
+  const char **pzErr
+){
+  struct lemonrt_file_header h;
+  const char *pFile;
+  size_t nFile = 0;
+  int isMapped = 0;
+  const char *zErr;
+  rtLoaded *p;
+
+  pFile = rtReadFile(zFilename, &nFile, &isMapped);
+  if( pFile==0 ){
+    if( pzErr ) *pzErr = "cannot read the table file";
+    return 0;
+  }
+  if( nFile<sizeof(h) ){
+    zErr = "not a lemon table file";
+  }else{
+    memcpy(&h, pFile, sizeof(h));
+    zErr = rtCheckFile(&h, pCode, pFile, nFile);
+  }
+  p = 0;
+  if( zErr==0 ){
+    p = (rtLoaded*)malloc(sizeof(*p));
+    if( p ) p->azName = (const char**)malloc(
+                (size_t)(h.nSymbol+h.nRule)*sizeof(p->azName[0]));
+    if( p==0 || p->azName==0 ){
+      zErr = "out of memory";
+    }else if(
+        rtFindNames(pFile, nFile, h.ofstTokenName, h.nSymbol, p->azName)<0
+     || rtFindNames(pFile, nFile, h.ofstRuleName, h.nRule,
+                    p->azName+h.nSymbol)<0 ){
+      zErr = "unterminated name in the table file";
+    }
+  }
+  if( zErr ){
+    if( p ){
+      free((void*)p->azName);
+      free(p);
+    }
+    rtReleaseFile(pFile, nFile, isMapped);
+    if( pzErr ) *pzErr = zErr;
+    return 0;
+  }
+
+  p->pFile = pFile;
+  p->nFile = nFile;
+  p->isMapped = isMapped;
+  p->g = *pCode;
+  p->g.nState = h.nState;
+  p->g.nRule = h.nRule;
+  p->g.nNoCode = h.nNoCode;
+  p->g.iErrorSymbol = h.iErrorSymbol;
+  p->g.maxShift = h.maxShift;
+  p->g.minShiftReduce = h.minShiftReduce;
+  p->g.maxShiftReduce = h.maxShiftReduce;
+  p->g.minReduce = h.minReduce;
+  p->g.maxReduce = h.maxReduce;
+  p->g.errorAction = h.errorAction;
+  p->g.acceptAction = h.acceptAction;
+  p->g.noAction = h.noAction;
+  p->g.nActTab = h.nActTab;
+  p->g.aAction = (const lemonrt_action*)(pFile + h.ofstAction);
+  p->g.aLookahead = (const lemonrt_code*)(pFile + h.ofstLookahead);
+  p->g.shiftUseDflt = h.shiftUseDflt;
+  p->g.shiftCount = h.shiftCount;
+  p->g.aShiftOfst = (const lemonrt_offset*)(pFile + h.ofstShiftOfst);
+  p->g.reduceUseDflt = h.reduceUseDflt;
+  p->g.reduceCount = h.reduceCount;
+  p->g.aReduceOfst = (const lemonrt_offset*)(pFile + h.ofstReduceOfst);
+  p->g.aDefault = (const lemonrt_action*)(pFile + h.ofstDefault);
+  p->g.nFallback = h.nFallback;
+  p->g.aFallback = h.nFallback ?
+                   (const lemonrt_code*)(pFile + h.ofstFallback) : 0;
+  p->g.iWildcard = h.iWildcard;
+  p->g.aRuleInfo = (const lemonrt_rule*)(pFile + h.ofstRuleInfo);
+  p->g.azTokenName = p->azName;
+  p->g.azRuleName = p->azName + h.nSymbol;
+  return &p->g;
+}
+
+/*
+** Release a grammar obtained from lemonrt_load().  No parser may be using
+** it any more.
+*/
+void lemonrt_unload(const lemonrt_grammar *pGrammar){
+  rtLoaded *p = (rtLoaded*)pGrammar;
+  if( p==0 ) return;
+  rtReleaseFile(p->pFile, p->nFile, p->isMapped);
+  free((void*)p->azName);
+  free(p);
+}
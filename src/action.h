@@ -1,6 +1,8 @@
 #ifndef _ACTION_H_
 #define _ACTION_H_
 
+#include "struct.h"
+
 struct lookahead_action {
   int lookahead;             /* Value of the lookahead token */
   int action;                /* Action to take on the given lookahead */
@@ -20,6 +22,7 @@ struct acttab {
 };
 
 struct action *Action_sort(struct action *);
+void Action_add(struct action **, enum e_action, struct symbol *, char *);
 
 /* Return the number of entries in the yy_action table */
 #define acttab_size(X) ((X)->nAction)
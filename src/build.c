@@ -10,6 +10,350 @@
 #include "configlist.h"
 #include "action.h"
 
+int lemon_sprintf(char *str, const char *format, ...);  /* In main.c */
+
+/*
+** A growable string used while composing the action code of inlined
+** rules.
+*/
+struct inlinebuf {
+  char *z;                 /* The text.  Always zero-terminated */
+  int n;                   /* Number of bytes used, not counting the zero */
+  int nAlloc;              /* Bytes allocated for z[] */
+};
+
+PRIVATE void inlinebuf_append(struct inlinebuf *p, const char *zText, int n){
+  if( n<0 ) n = lemonStrlen(zText);
+  if( p->n+n+1>p->nAlloc ){
+    p->nAlloc = p->n + n + 200;
+    p->z = (char *) realloc(p->z, p->nAlloc);
+    MemoryCheck(p->z);
+  }
+  memcpy(&p->z[p->n], zText, n);
+  p->n += n;
+  p->z[p->n] = 0;
+}
+
+/*
+** Append zCode to p with every label azFrom[i] replaced by azTo[i].
+** Identifiers are recognized the same way translate_code() recognizes
+** them, so the result expands exactly as the original text would have.
+*/
+PRIVATE void inlinebuf_rename(
+  struct inlinebuf *p,
+  const char *zCode,
+  int nLabel,
+  const char **azFrom,
+  const char **azTo
+){
+  const char *cp, *xp;
+  int i;
+  for(cp=zCode; *cp; cp=xp){
+    if( ISALPHA(*cp) && (cp==zCode || (!ISALNUM(cp[-1]) && cp[-1]!='_')) ){
+      for(xp=&cp[1]; ISALNUM(*xp) || *xp=='_'; xp++){}
+      for(i=0; i<nLabel; i++){
+        if( azFrom[i] && lemonStrlen(azFrom[i])==(int)(xp-cp)
+         && strncmp(azFrom[i],cp,xp-cp)==0 ){
+          break;
+        }
+      }
+      if( i<nLabel ){
+        inlinebuf_append(p, azTo[i], -1);
+      }else{
+        inlinebuf_append(p, cp, (int)(xp-cp));
+      }
+    }else{
+      xp = &cp[1];
+      inlinebuf_append(p, cp, 1);
+    }
+  }
+}
+
+/*
+** Return a new rule that is the host rule "hp" with the inline nonterminal
+** at hp->rhs[iPos] replaced by the right-hand side of rule "xp".
+**
+** The labels of xp are renamed so that they cannot collide with those of
+** hp.  The value of the inline nonterminal becomes a local variable named
+** by the label hp gave it, or the LHS of hp itself if the two share a
+** label, and the code of xp is run ahead of the code of hp to compute it.
+*/
+PRIVATE struct rule *inline_one_rule(
+  struct lemon *lemp,
+  struct rule *hp,
+  int iPos,
+  struct rule *xp
+){
+  static int nFresh = 0;   /* Used to make unique label names */
+  struct rule *rp;
+  struct symbol *sp = hp->rhs[iPos];
+  const char *azFrom[MAXRHS+1];
+  const char *azTo[MAXRHS+1];
+  const char *zValue = 0;  /* Name of the value of the inline symbol */
+  const char *zFrom = 0;   /* RHS label the value is copied from */
+  struct inlinebuf buf;
+  char zName[100];
+  int nrhs, nLabel, i, j, k;
+
+  nrhs = hp->nrhs - 1 + xp->nrhs;
+  if( nrhs>MAXRHS ){
+    ErrorMsg(lemp->filename,hp->ruleline,
+      "Too many symbols on RHS after inlining \"%s\".",sp->name);
+    lemp->errorcnt++;
+    return 0;
+  }
+  rp = (struct rule *)calloc( sizeof(struct rule) +
+       sizeof(struct symbol*)*nrhs + sizeof(char*)*nrhs, 1);
+  MemoryCheck(rp);
+  *rp = *hp;
+  rp->rhs = (struct symbol**)&rp[1];
+  rp->rhsalias = (const char**)&(rp->rhs[nrhs]);
+  rp->nrhs = nrhs;
+  rp->next = 0;
+
+  /* Give every label of xp a fresh name */
+  nFresh++;
+  nLabel = 0;
+  if( xp->lhsalias ){
+    if( hp->rhsalias[iPos] ){
+      zValue = hp->rhsalias[iPos];
+    }else{
+      lemon_sprintf(zName, "yyi%d", nFresh);
+      zValue = Strsafe(zName);
+    }
+    azFrom[nLabel] = xp->lhsalias;
+    azTo[nLabel++] = zValue;
+  }
+  for(i=j=0; i<hp->nrhs; i++){
+    if( i!=iPos ){
+      rp->rhs[j] = hp->rhs[i];
+      rp->rhsalias[j++] = hp->rhsalias[i];
+      continue;
+    }
+    for(k=0; k<xp->nrhs; k++){
+      const char *zAlias = xp->rhsalias[k];
+      rp->rhs[j] = xp->rhs[k];
+      if( zAlias ){
+        lemon_sprintf(zName, "yyi%d_%s", nFresh, zAlias);
+        rp->rhsalias[j] = Strsafe(zName);
+        if( xp->lhsalias && strcmp(zAlias,xp->lhsalias)==0 ){
+          zFrom = rp->rhsalias[j];
+        }else{
+          azFrom[nLabel] = zAlias;
+          azTo[nLabel++] = rp->rhsalias[j];
+        }
+      }else{
+        rp->rhsalias[j] = 0;
+      }
+      j++;
+    }
+  }
+  assert( j==nrhs );
+
+  /* Keep the precedence the host rule had before it was expanded */
+  if( rp->precsym==0 ){
+    for(i=0; i<hp->nrhs && rp->precsym==0; i++){
+      struct symbol *psp = hp->rhs[i];
+      if( psp->type==MULTITERMINAL ){
+        for(j=0; j<psp->nsubsym; j++){
+          if( psp->subsym[j]->prec>=0 ){
+            rp->precsym = psp->subsym[j];
+            break;
+          }
+        }
+      }else if( psp->prec>=0 ){
+        rp->precsym = psp;
+      }
+    }
+  }
+
+  /* Compose the action code */
+  if( zValue==0 && hp->rhsalias[iPos] ) zValue = hp->rhsalias[iPos];
+  if( zValue==0 && xp->code==0 ) return rp;
+  memset(&buf, 0, sizeof(buf));
+  if( zValue && (hp->lhsalias==0 || strcmp(zValue,hp->lhsalias)!=0) ){
+    const char *zType = sp->datatype ? sp->datatype : lemp->vartype;
+    if( zType==0 ) zType = lemp->tokentype ? lemp->tokentype : "void*";
+    inlinebuf_append(&buf, zType, -1);
+    inlinebuf_append(&buf, " ", 1);
+    inlinebuf_append(&buf, zValue, -1);
+    inlinebuf_append(&buf, ";", 1);
+  }
+  if( zFrom ){
+    inlinebuf_append(&buf, zValue, -1);
+    inlinebuf_append(&buf, " = ", 3);
+    inlinebuf_append(&buf, zFrom, -1);
+    inlinebuf_append(&buf, ";", 1);
+  }
+  if( xp->code ){
+    inlinebuf_append(&buf, "{", 1);
+    inlinebuf_rename(&buf, xp->code, nLabel, azFrom, azTo);
+    inlinebuf_append(&buf, "}", 1);
+  }
+  if( hp->code ){
+    inlinebuf_append(&buf, "{", 1);
+    inlinebuf_append(&buf, hp->code, -1);
+    inlinebuf_append(&buf, "}", 1);
+  }else{
+    rp->line = xp->line;
+  }
+  inlinebuf_append(&buf, "\n", 1);
+  rp->code = Strsafe(buf.z);
+  free(buf.z);
+  return rp;
+}
+
+/* Expand every nonterminal declared with %inline.
+**
+** Each rule that uses an inline nonterminal X is replaced by one rule
+** for every alternative of X, with the alternative spliced into the
+** right-hand side in place of X.  The rules of X are then dropped, so X
+** never appears in the automaton and costs no reduce or goto at runtime.
+** This runs right after the grammar is read, before symbols and rules
+** are numbered.
+*/
+void ExpandInlineRules(struct lemon *lemp)
+{
+  struct symbol **azSym;
+  struct symbol *sp, *startsp;
+  struct rule **pp, *rp, *np, *pLast;
+  struct rule **aAlt;
+  int i, n, iPos, nAlt;
+
+  startsp = lemp->start ? Symbol_find(lemp->start) : 0;
+  if( startsp==0 && lemp->rule ) startsp = lemp->rule->lhs;
+  n = Symbol_count();
+  azSym = Symbol_arrayof();
+  for(i=0; i<n; i++){
+    sp = azSym[i];
+    if( !sp->inlined ) continue;
+    if( sp->rule==0 ){
+      ErrorMsg(lemp->filename,0,
+        "Inline nonterminal \"%s\" has no rules.",sp->name);
+      lemp->errorcnt++;
+    }else if( sp==startsp ){
+      ErrorMsg(lemp->filename,0,
+        "The start symbol \"%s\" can not be inlined.",sp->name);
+      lemp->errorcnt++;
+    }else if( sp->destructor || lemp->vardest ){
+      ErrorMsg(lemp->filename,0,
+        "Inline nonterminal \"%s\" can not have a destructor.",sp->name);
+      lemp->errorcnt++;
+    }
+  }
+  free(azSym);
+  if( lemp->errorcnt ) return;
+
+  for(;;){
+    /* Find the next inline nonterminal still used as a LHS */
+    for(rp=lemp->rule; rp && !rp->lhs->inlined; rp=rp->next){}
+    if( rp==0 ) break;
+    sp = rp->lhs;
+
+    /* Collect its rules in the order they were written */
+    for(nAlt=0, rp=lemp->rule; rp; rp=rp->next){
+      if( rp->lhs==sp ) nAlt++;
+    }
+    aAlt = (struct rule **)calloc(nAlt, sizeof(struct rule*));
+    MemoryCheck(aAlt);
+    for(nAlt=0, rp=lemp->rule; rp; rp=rp->next){
+      if( rp->lhs!=sp ) continue;
+      for(i=0; i<rp->nrhs && rp->rhs[i]!=sp; i++){}
+      if( i<rp->nrhs ){
+        ErrorMsg(lemp->filename,rp->ruleline,
+          "Inline nonterminal \"%s\" can not be recursive.",sp->name);
+        lemp->errorcnt++;
+        free(aAlt);
+        return;
+      }
+      aAlt[nAlt++] = rp;
+    }
+
+    /* Splice the alternatives into every use and drop the rules of sp */
+    for(pp=&lemp->rule; (rp = *pp)!=0; ){
+      if( rp->lhs==sp ){
+        *pp = rp->next;
+        continue;
+      }
+      for(iPos=0; iPos<rp->nrhs && rp->rhs[iPos]!=sp; iPos++){}
+      if( iPos>=rp->nrhs ){
+        pp = &rp->next;
+        continue;
+      }
+      pLast = 0;
+      for(i=0; i<nAlt; i++){
+        np = inline_one_rule(lemp, rp, iPos, aAlt[i]);
+        if( np==0 ) continue;
+        if( pLast ){
+          pLast->next = np;
+        }else{
+          *pp = np;
+        }
+        pLast = np;
+      }
+      if( pLast ){
+        pLast->next = rp->next;
+      }else{
+        *pp = rp->next;
+      }
+    }
+    free(aAlt);
+    sp->rule = 0;
+  }
+
+  /* Renumber the rules and rebuild the per-symbol rule lists */
+  for(rp=lemp->rule; rp; rp=rp->next) rp->lhs->rule = 0;
+  for(i=0, rp=lemp->rule; rp; rp=rp->next){
+    rp->index = i++;
+    rp->nextlhs = rp->lhs->rule;
+    rp->lhs->rule = rp;
+  }
+  lemp->nrule = i;
+}
+
+/* Drop the semantic values of the grammar, for a recognizer (lemon's -R
+** option).
+**
+** The action code of every rule is removed, except for the rules of the
+** nonterminals declared with %hook.  Their code is kept and runs when the
+** rule is reduced, but as there are no values for it to work with, it
+** may not use labels.  Destructors and datatypes go as well, so that
+** every unit rule without a hook is transparent to BypassUnitRules().
+*/
+void StripSemanticValues(struct lemon *lemp)
+{
+  struct symbol **azSym;
+  struct rule *rp;
+  int i, n, hasLabel;
+
+  for(rp=lemp->rule; rp; rp=rp->next){
+    hasLabel = rp->lhsalias!=0;
+    rp->lhsalias = 0;
+    for(i=0; i<rp->nrhs; i++){
+      if( rp->rhsalias[i] ) hasLabel = 1;
+      rp->rhsalias[i] = 0;
+    }
+    if( !rp->lhs->hooked ){
+      rp->code = 0;
+    }else if( rp->code && hasLabel ){
+      ErrorMsg(lemp->filename,rp->ruleline,
+        "The rules of %%hook nonterminal \"%s\" can not use labels.",
+        rp->lhs->name);
+      lemp->errorcnt++;
+    }
+  }
+  n = Symbol_count();
+  azSym = Symbol_arrayof();
+  for(i=0; i<n; i++){
+    azSym[i]->destructor = 0;
+    azSym[i]->datatype = 0;
+  }
+  free(azSym);
+  lemp->tokendest = 0;
+  lemp->vardest = 0;
+  lemp->vartype = 0;
+}
+
 /* Find a precedence symbol of every rule in the grammar.
 ** 
 ** Those rules which have a precedence symbol coded in the input
@@ -204,6 +548,7 @@ PRIVATE struct state *getstate(struct lemon *lemp)
     stp->bp = bp;                /* Remember the configuration basis */
     stp->cfp = cfp;              /* Remember the configuration closure */
     stp->statenum = lemp->nstate++; /* Every state gets a sequence number */
+    stp->origstatenum = stp->statenum;
     stp->ap = 0;                 /* No actions, yet. */
     State_insert(stp,stp->bp);   /* Add to the state table */
     buildshifts(lemp,stp);       /* Recursively compute successor states */
@@ -423,6 +768,151 @@ void FindActions(struct lemon *lemp)
   }
 }
 
+/*
+** Find the terminals that each state expects: those whose action is not
+** a syntax error.  This is done before CompressTables() turns the most
+** common reduce of a state into a default, which would make every
+** terminal look acceptable.  A terminal without an action of its own is
+** expected if its fallback token is, and every terminal but "$" is
+** expected in a state that shifts the wildcard.
+*/
+void FindExpectedSets(struct lemon *lemp)
+{
+  int i, j;
+  struct state *stp;
+  struct action *ap;
+  struct symbol *sp;
+
+  for(i=0; i<lemp->nstate; i++){
+    stp = lemp->sorted[i];
+    stp->expect = SetNew();
+    for(ap=stp->ap; ap; ap=ap->next){
+      if( ap->sp->index>=lemp->nterminal ) continue;
+      if( ap->type==SHIFT || ap->type==REDUCE || ap->type==ACCEPT ){
+        SetAdd(stp->expect, ap->sp->index);
+      }
+    }
+    for(j=1; j<lemp->nterminal; j++){
+      if( SetFind(stp->expect, j) ) continue;
+      sp = lemp->symbols[j];
+      if( (sp->fallback && SetFind(stp->expect, sp->fallback->index))
+       || (lemp->wildcard && SetFind(stp->expect, lemp->wildcard->index)) ){
+        SetAdd(stp->expect, j);
+      }
+    }
+  }
+}
+
+/* Return true if the two symbols hold the same datatype on the stack.
+*/
+PRIVATE int same_datatype(struct lemon *lemp, struct symbol *a, struct symbol *b)
+{
+  const char *za = a->datatype ? a->datatype : lemp->vartype;
+  const char *zb = b->datatype ? b->datatype : lemp->vartype;
+  int na, nb;
+  if( za==0 || zb==0 ) return za==zb;
+  while( ISSPACE(*za) ) za++;
+  while( ISSPACE(*zb) ) zb++;
+  for(na=lemonStrlen(za); na>0 && ISSPACE(za[na-1]); na--){}
+  for(nb=lemonStrlen(zb); nb>0 && ISSPACE(zb[nb-1]); nb--){}
+  return na==nb && strncmp(za,zb,na)==0;
+}
+
+/* Return true if reducing by the rule "rp" has no effect other than
+** relabeling the value on top of the stack.  That is the case for a unit
+** rule "A ::= B." with no action code where A and B hold the same
+** datatype and have the same destructor, and where the value of B is
+** either passed through by a shared label or not labeled at all.
+*/
+PRIVATE int is_transparent_unit_rule(struct lemon *lemp, struct rule *rp)
+{
+  struct symbol *lhs, *rhs;
+  if( rp->nrhs!=1 || rp->code!=0 || rp->lhsStart ) return 0;
+  lhs = rp->lhs;
+  rhs = rp->rhs[0];
+  if( rhs->type!=NONTERMINAL || rhs==lemp->errsym ) return 0;
+  if( rp->lhsalias || rp->rhsalias[0] ){
+    if( rp->lhsalias==0 || rp->rhsalias[0]==0 ) return 0;
+    if( strcmp(rp->lhsalias,rp->rhsalias[0])!=0 ) return 0;
+  }else if( rhs->destructor || lemp->vardest ){
+    return 0;
+  }
+  if( !same_datatype(lemp,lhs,rhs) ) return 0;
+  if( (lhs->destructor==0)!=(rhs->destructor==0) ) return 0;
+  if( lhs->destructor && strcmp(lhs->destructor,rhs->destructor)!=0 ){
+    return 0;
+  }
+  return 1;
+}
+
+/* If every action of state "stp" is a reduce by the same rule, return
+** that rule.  Otherwise return NULL.
+*/
+PRIVATE struct rule *single_reduce_rule(struct state *stp)
+{
+  struct action *ap;
+  struct rule *rp = 0;
+  for(ap=stp->ap; ap; ap=ap->next){
+    switch( ap->type ){
+      case REDUCE:
+        if( rp && rp!=ap->x.rp ) return 0;
+        rp = ap->x.rp;
+        break;
+      case SH_RESOLVED:
+      case RD_RESOLVED:
+      case NOT_USED:
+        break;
+      default:
+        return 0;
+    }
+  }
+  return rp;
+}
+
+/* Remove reductions by transparent unit rules from the automaton.
+**
+** Suppose state S has a goto on nonterminal B into a state T whose only
+** action is to reduce by the rule "A ::= B." and that this rule has no
+** effect other than to relabel B as A.  Reducing by the rule leaves the
+** stack with S on top again and then takes the goto of S on A.  So the
+** goto of S on B can lead directly to where the goto on A leads, and the
+** reduce, its goto lookup and its stack write are never performed at
+** runtime.  Chains of such rules, as found in grammars with one
+** nonterminal per precedence level, are followed to their end.
+**
+** The only visible difference is that the stack entry keeps the major
+** code of B rather than A.  Both symbols have the same destructor, so
+** error recovery and parser teardown are unchanged.
+*/
+void BypassUnitRules(struct lemon *lemp)
+{
+  int i, n;
+  struct state *stp;
+  struct action *ap, *ap2;
+  struct rule *rp;
+
+  for(rp=lemp->rule; rp; rp=rp->next) rp->bypassed = LEMON_FALSE;
+  for(i=0; i<lemp->nstate; i++){
+    stp = lemp->sorted[i];
+    for(ap=stp->ap; ap; ap=ap->next){
+      if( ap->type!=SHIFT || ap->sp->type!=NONTERMINAL ) continue;
+      for(n=0; n<lemp->nstate; n++){   /* n guards against cycles */
+        rp = single_reduce_rule(ap->x.stp);
+        if( rp==0 || !is_transparent_unit_rule(lemp,rp) ) break;
+        for(ap2=stp->ap; ap2; ap2=ap2->next){
+          if( ap2->sp==rp->lhs && ap2->type==SHIFT ) break;
+        }
+        if( ap2==0 ) break;
+        ap->x.stp = ap2->x.stp;
+        if( !rp->bypassed ){
+          rp->bypassed = LEMON_TRUE;
+          lemp->nbypass++;
+        }
+      }
+    }
+  }
+}
+
 /* Resolve a conflict between the two given actions.  If the
 ** conflict can't be resolved, return non-zero.
 **
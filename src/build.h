@@ -1,11 +1,15 @@
 #ifndef _BUILD_H_
 #define _BUILD_H_
 
+void ExpandInlineRules();
+void StripSemanticValues();
 void FindRulePrecedences();
 void FindFirstSets();
 void FindStates();
 void FindLinks();
 void FindFollowSets();
 void FindActions();
+void FindExpectedSets();
+void BypassUnitRules();
 
 #endif // _BUILD_H_
@@ -114,6 +114,7 @@ struct action;
 #include "option.h"
 #include "parse.h"
 #include "plink.h"
+#include "profile.h"
 #include "report.h"
 #include "set.h"
 #include "struct.h"
@@ -158,6 +159,20 @@ static void handle_D_option(char *z){
 }
 
 char *user_templatename = NULL;
+static enum e_dispatch reduceDispatch = DISPATCH_SWITCH;
+static void handle_A_option(char *z){
+  if( strcmp(z,"switch")==0 ){
+    reduceDispatch = DISPATCH_SWITCH;
+  }else if( strcmp(z,"func")==0 ){
+    reduceDispatch = DISPATCH_FUNC;
+  }else if( strcmp(z,"goto")==0 ){
+    reduceDispatch = DISPATCH_GOTO;
+  }else{
+    fprintf(stderr,"unknown reduce dispatch \"%s\": "
+                   "use switch, func or goto\n", z);
+    exit(1);
+  }
+}
 static void handle_T_option(char *z){
   user_templatename = (char *) malloc( lemonStrlen(z)+1 );
   if( user_templatename==0 ){
@@ -165,6 +180,22 @@ static void handle_T_option(char *z){
   }
   lemon_strcpy(user_templatename, z);
 }
+char *user_profilename = NULL;
+static void handle_M_option(char *z){
+  user_profilename = (char *) malloc( lemonStrlen(z)+1 );
+  if( user_profilename==0 ){
+    memory_error();
+  }
+  lemon_strcpy(user_profilename, z);
+}
+char *user_layoutname = NULL;
+static void handle_P_option(char *z){
+  user_layoutname = (char *) malloc( lemonStrlen(z)+1 );
+  if( user_layoutname==0 ){
+    memory_error();
+  }
+  lemon_strcpy(user_layoutname, z);
+}
 char *user_output_file = NULL;
 static void handle_o_option(char *z){
   user_output_file = (char *) malloc( lemonStrlen(z)+1 );
@@ -254,22 +285,57 @@ int main(int argc, char **argv)
   static int mhflag = 0;
   static int nolinenosflag = 0;
   static int noResort = 0;
+  static int splitstack = 0;
+  static int noBypass = 0;
+  static int noFold = 0;
+  static int directcode = 0;
+  static int nsplit = 0;
+  static int runtime = 0;
+  static int tablefile = 0;
+  static int recognizer = 0;
+  static int tokenhandle = 0;
+  static int cplusplus = 0;
   static struct s_options options[] = {
+    {OPT_FSTR, "A", (char*)handle_A_option,
+                    "Reduce action dispatch: switch, func or goto."},
     {OPT_FLAG, "b", (char*)&basisflag, "Print only the basis in report."},
+    {OPT_FLAG, "B", (char*)&tablefile,
+                    "Also write the parsing tables to a .ltab file."},
     {OPT_FLAG, "c", (char*)&compress, "Don't compress the action table."},
+    {OPT_FLAG, "C", (char*)&cplusplus,
+                    "Generate a C++17 parser with typed semantic values."},
+    {OPT_FLAG, "d", (char*)&directcode,
+                    "Emit the automaton as code instead of tables."},
+    {OPT_FLAG, "e", (char*)&runtime,
+                    "Generate tables for the shared lemonrt engine."},
     {OPT_FSTR, "D", (char*)handle_D_option, "Define an %ifdef macro."},
     {OPT_FSTR, "f", 0, "Ignored.  (Placeholder for -f compiler options.)"},
+    {OPT_FLAG, "F", (char*)&noFold,
+                    "Look up fallback and wildcard tokens at runtime."},
     {OPT_FLAG, "g", (char*)&rpflag, "Print grammar without actions."},
     {OPT_FSTR, "I", 0, "Ignored.  (Placeholder for '-I' compiler options.)"},
+    {OPT_FSTR, "M", (char*)handle_M_option,
+                    "Merge a YYPROFILE runtime profile into the report."},
     {OPT_FLAG, "m", (char*)&mhflag, "Output a makeheaders compatible file."},
     {OPT_FLAG, "l", (char*)&nolinenosflag, "Do not print #line statements."},
     {OPT_FSTR, "O", 0, "Ignored.  (Placeholder for '-O' compiler options.)"},
+    {OPT_FSTR, "P", (char*)handle_P_option,
+                    "Lay out the tables for a YYPROFILE runtime profile."},
     {OPT_FLAG, "p", (char*)&showPrecedenceConflict,
                     "Show conflicts resolved by precedence rules"},
     {OPT_FLAG, "q", (char*)&quiet, "(Quiet) Don't print the report file."},
     {OPT_FLAG, "r", (char*)&noResort, "Do not sort or renumber states"},
+    {OPT_FLAG, "R", (char*)&recognizer,
+                    "Generate a recognizer without semantic values."},
+    {OPT_FLAG, "S", (char*)&splitstack,
+                    "Keep semantic values apart from state numbers."},
+    {OPT_INT, "split", (char*)&nsplit,
+      "Write the parser as N action files, tables and a driver."},
     {OPT_FLAG, "s", (char*)&statistics,
                                    "Print parser stats to standard output."},
+    {OPT_FLAG, "t", (char*)&tokenhandle,
+                    "Keep token handles, not token values, on the stack."},
+    {OPT_FLAG, "u", (char*)&noBypass, "Do not bypass action-free unit rules."},
     {OPT_FLAG, "x", (char*)&version, "Print the version number."},
     {OPT_FSTR, "T", (char*)handle_T_option, "Specify a template file."},
     {OPT_FSTR, "W", 0, "Ignored.  (Placeholder for '-W' compiler options.)"},
@@ -302,6 +368,59 @@ int main(int argc, char **argv)
   lem.filename = OptArg(0);
   lem.basisflag = basisflag;
   lem.nolinenosflag = nolinenosflag;
+  lem.splitstack = splitstack;
+  lem.directcode = directcode;
+  lem.dispatch = reduceDispatch;
+  lem.tablefile = tablefile;
+  if( nsplit<0 ){
+    fprintf(stderr,"The -split option requires a positive count.\n");
+    exit(1);
+  }
+  if( runtime ){
+    /* The engine keeps the semantic values in a stack of their own and
+    ** runs the actions through a single callback */
+    if( directcode || nsplit>0 ){
+      fprintf(stderr,"The -e option cannot be combined with -d or -split.\n");
+      exit(1);
+    }
+    lem.runtime = 1;
+    lem.splitstack = 1;
+    lem.dispatch = DISPATCH_SWITCH;
+  }
+  if( recognizer ){
+    /* There are no semantic values to keep apart from the states */
+    if( runtime ){
+      fprintf(stderr,"The -R option cannot be combined with -e.\n");
+      exit(1);
+    }
+    lem.recognizer = 1;
+    lem.splitstack = 0;
+  }
+  if( tokenhandle && !recognizer ){
+    /* The engine of -e takes token values */
+    if( runtime ){
+      fprintf(stderr,"The -t option cannot be combined with -e.\n");
+      exit(1);
+    }
+    lem.tokenhandle = 1;
+  }
+  if( cplusplus ){
+    /* The C++ template keeps typed values on a single stack and runs the
+    ** actions inside yy_reduce() */
+    if( runtime || recognizer || tokenhandle || nsplit>0
+     || reduceDispatch==DISPATCH_FUNC ){
+      fprintf(stderr,"The -C option cannot be combined with -e, -R, -t, "
+                     "-split or -Afunc.\n");
+      exit(1);
+    }
+    lem.cplusplus = 1;
+    lem.splitstack = 0;
+  }
+  if( nsplit>0 ){
+    /* Only reduce functions can live apart from yy_reduce() */
+    lem.nsplit = nsplit;
+    lem.dispatch = DISPATCH_FUNC;
+  }
   Symbol_new("$");
   lem.errsym = Symbol_new("error");
   lem.errsym->useCnt = 0;
@@ -309,11 +428,29 @@ int main(int argc, char **argv)
   /* Parse the input file */
   Parse(&lem);
   if( lem.errorcnt ) exit(lem.errorcnt);
+  if( lem.arena && (lem.runtime || lem.cplusplus) ){
+    fprintf(stderr,"The %%arena directive cannot be used with -e or -C.\n");
+    exit(1);
+  }
+  if( lem.syncsym && (lem.runtime || lem.cplusplus) ){
+    fprintf(stderr,"The %%sync directive cannot be used with -e or -C.\n");
+    exit(1);
+  }
   if( lem.nrule==0 ){
     fprintf(stderr,"Empty grammar.\n");
     exit(1);
   }
 
+  /* Substitute the rules of %inline nonterminals into their uses */
+  ExpandInlineRules(&lem);
+  if( lem.errorcnt ) exit(lem.errorcnt);
+
+  /* A recognizer keeps only the code of %hook rules */
+  if( lem.recognizer ){
+    StripSemanticValues(&lem);
+    if( lem.errorcnt ) exit(lem.errorcnt);
+  }
+
   /* Count and index the symbols of the grammar */
   Symbol_new("{default}");
   lem.nsymbol = Symbol_count();
@@ -366,14 +503,39 @@ int main(int argc, char **argv)
     /* Compute the action tables */
     FindActions(&lem);
 
+    /* Find the terminals each state expects, before any compression */
+    FindExpectedSets(&lem);
+
+    /* Let gotos skip over unit rules that only relabel a value */
+    if( noBypass==0 ) BypassUnitRules(&lem);
+
     /* Compress the action tables */
     if( compress==0 ) CompressTables(&lem);
 
+    /* Resolve fallback and wildcard tokens in the tables, not at runtime.
+    ** A direct-coded parser has no runtime lookup to fall back on. */
+    if( noFold==0 || directcode ) FoldFallbackActions(&lem);
+
+    /* Read the runtime profile that guides the layout of the tables */
+    if( user_layoutname ){
+      lem.layout = Profile_read(&lem, user_layoutname);
+    }
+
     /* Reorder and renumber the states so that states with fewer choices
     ** occur at the end.  This is an optimization that helps make the
-    ** generated parser tables smaller. */
+    ** generated parser tables smaller.  With a layout profile, the states
+    ** visited most often come first instead. */
     if( noResort==0 ) ResortStates(&lem);
 
+    /* Prove that the %sync token always returns the parser to a single
+    ** top-level state, where a parse of the rest of the input can start */
+    if( lem.syncsym ) FindSyncState(&lem);
+
+    /* Read the runtime profile to be shown in the report */
+    if( user_profilename ){
+      lem.profile = Profile_read(&lem, user_profilename);
+    }
+
     /* Generate a report of the parser generated.  (the "y.output" file) */
     if( !quiet ) ReportOutput(&lem);
 
@@ -393,8 +555,18 @@ int main(int argc, char **argv)
     stats_line("rules", lem.nrule);
     stats_line("states", lem.nxstate);
     stats_line("conflicts", lem.nconflict);
-    stats_line("action table entries", lem.nactiontab);
+    stats_line("unit rules bypassed", lem.nbypass);
+    if( lem.directcode ){
+      stats_line("direct-coded cases", lem.nactiontab);
+    }else{
+      stats_line("action table entries", lem.nactiontab);
+    }
     stats_line("total table size (bytes)", lem.tablesize);
+    if( lem.tablelines>0 ){
+      stats_line("lookup table cache lines", lem.tablelines);
+      stats_line("lines for 90% of profiled lookups", lem.hotlines90);
+      stats_line("lines for 99% of profiled lookups", lem.hotlines99);
+    }
   }
   if( lem.nconflict > 0 ){
     fprintf(stderr,"%d parsing conflicts.\n",lem.nconflict);
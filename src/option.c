@@ -80,6 +80,24 @@ static int handleflags(int i, FILE *err)
     (*(void(*)(int))(op[j].arg))(v);
   }else if( op[j].type==OPT_FSTR ){
     (*(void(*)(char *))(op[j].arg))(&argv[i][2]);
+  }else if( op[j].type==OPT_INT || op[j].type==OPT_FINT ){
+    /* Integer flags are written "-labelN" or "-label=N" */
+    char *cp, *end;
+    long lv;
+    cp = &argv[i][1+lemonStrlen(op[j].label)];
+    if( *cp=='=' ) cp++;
+    lv = strtol(cp,&end,0);
+    if( *cp==0 || *end ){
+      if( err ){
+        fprintf(err,"%sillegal character in integer argument.\n",emsg);
+        errline(i,(int)((char*)end-(char*)argv[i]),err);
+      }
+      errcnt++;
+    }else if( op[j].type==OPT_INT ){
+      *(int*)(op[j].arg) = (int)lv;
+    }else{
+      (*(void(*)(int))(op[j].arg))((int)lv);
+    }
   }else{
     if( err ){
       fprintf(err,"%smissing argument on switch.\n",emsg);
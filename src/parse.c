@@ -29,7 +29,11 @@ enum e_state {
   WAITING_FOR_FALLBACK_ID,
   WAITING_FOR_WILDCARD_ID,
   WAITING_FOR_CLASS_ID,
-  WAITING_FOR_CLASS_TOKEN
+  WAITING_FOR_CLASS_TOKEN,
+  WAITING_FOR_INLINE_ID,
+  WAITING_FOR_HOOK_ID,
+  WAITING_FOR_ARENA_ID,
+  WAITING_FOR_SYNC_ID
 };
 struct pstate {
   char *filename;       /* Name of the input file */
@@ -351,6 +355,15 @@ to follow the previous rule.");
           psp->state = WAITING_FOR_WILDCARD_ID;
         }else if( strcmp(x,"token_class")==0 ){
           psp->state = WAITING_FOR_CLASS_ID;
+        }else if( strcmp(x,"inline")==0 ){
+          psp->state = WAITING_FOR_INLINE_ID;
+        }else if( strcmp(x,"hook")==0 ){
+          psp->state = WAITING_FOR_HOOK_ID;
+        }else if( strcmp(x,"arena")==0 ){
+          psp->gp->arena = 1;
+          psp->state = WAITING_FOR_ARENA_ID;
+        }else if( strcmp(x,"sync")==0 ){
+          psp->state = WAITING_FOR_SYNC_ID;
         }else{
           ErrorMsg(psp->filename,psp->tokenlineno,
             "Unknown declaration keyword: \"%%%s\".",x);
@@ -519,6 +532,54 @@ to follow the previous rule.");
         }
       }
       break;
+    case WAITING_FOR_INLINE_ID:
+      if( x[0]=='.' ){
+        psp->state = WAITING_FOR_DECL_OR_RULE;
+      }else if( !ISLOWER(x[0]) ){
+        ErrorMsg(psp->filename, psp->tokenlineno,
+          "%%inline argument \"%s\" should be a nonterminal", x);
+        psp->errorcnt++;
+      }else{
+        Symbol_new(x)->inlined = LEMON_TRUE;
+      }
+      break;
+    case WAITING_FOR_HOOK_ID:
+      if( x[0]=='.' ){
+        psp->state = WAITING_FOR_DECL_OR_RULE;
+      }else if( !ISLOWER(x[0]) ){
+        ErrorMsg(psp->filename, psp->tokenlineno,
+          "%%hook argument \"%s\" should be a nonterminal", x);
+        psp->errorcnt++;
+      }else{
+        Symbol_new(x)->hooked = LEMON_TRUE;
+      }
+      break;
+    case WAITING_FOR_ARENA_ID:
+      if( x[0]=='.' ){
+        psp->state = WAITING_FOR_DECL_OR_RULE;
+      }else if( !ISLOWER(x[0]) ){
+        ErrorMsg(psp->filename, psp->tokenlineno,
+          "%%arena argument \"%s\" should be a nonterminal", x);
+        psp->errorcnt++;
+      }else{
+        Symbol_new(x)->arena = LEMON_TRUE;
+      }
+      break;
+    case WAITING_FOR_SYNC_ID:
+      if( x[0]=='.' ){
+        psp->state = WAITING_FOR_DECL_OR_RULE;
+      }else if( !ISUPPER(x[0]) ){
+        ErrorMsg(psp->filename, psp->tokenlineno,
+          "%%sync argument \"%s\" should be a token", x);
+        psp->errorcnt++;
+      }else if( psp->gp->syncsym!=0 ){
+        ErrorMsg(psp->filename, psp->tokenlineno,
+          "Extra sync token: %s", x);
+        psp->errorcnt++;
+      }else{
+        psp->gp->syncsym = Symbol_new(x);
+      }
+      break;
     case WAITING_FOR_CLASS_ID:
       if( !ISLOWER(x[0]) ){
         ErrorMsg(psp->filename, psp->tokenlineno,
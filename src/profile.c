@@ -0,0 +1,119 @@
+/*
+** Reading runtime profiles in the LEMON parser generator.
+**
+** A parser compiled with YYPROFILE appends its counters to a file with
+** ParseProfile().  The file holds any number of such dumps, from one or
+** more processes, and they are summed up here.  Each dump is a line
+** "lemon-profile NOCODE NRULE", then lines of counters, then "end".
+*/
+
+#include "config.h"
+#include "struct.h"
+#include "error.h"
+#include "profile.h"
+
+/* Read the profile in file zFile, for the grammar of lemp.  Return NULL,
+** after an error message, if the file cannot be read or was written by
+** a parser of some other grammar.
+*/
+struct profile *Profile_read(struct lemon *lemp, const char *zFile)
+{
+  struct profile *pProf;
+  FILE *in;
+  char zLine[200];
+  char zKind[20];
+  unsigned long a, b, c;
+  int i, n, lineno = 0, inDump = 0;
+
+  in = fopen(zFile, "rb");
+  if( in==0 ){
+    fprintf(stderr,"Can't open the profile \"%s\".\n", zFile);
+    lemp->errorcnt++;
+    return 0;
+  }
+  pProf = (struct profile*)calloc(1, sizeof(*pProf));
+  MemoryCheck(pProf);
+  pProf->aShift = (unsigned long*)calloc(lemp->nstate, sizeof(unsigned long));
+  pProf->aGoto = (unsigned long*)calloc(lemp->nstate, sizeof(unsigned long));
+  pProf->aReduce = (unsigned long*)calloc(lemp->nrule, sizeof(unsigned long));
+  pProf->aFallback = (unsigned long*)calloc(lemp->nsymbol,
+                                            sizeof(unsigned long));
+  pProf->aWildcard = (unsigned long*)calloc(lemp->nsymbol,
+                                            sizeof(unsigned long));
+  MemoryCheck(pProf->aShift);
+  MemoryCheck(pProf->aGoto);
+  MemoryCheck(pProf->aReduce);
+  MemoryCheck(pProf->aFallback);
+  MemoryCheck(pProf->aWildcard);
+
+  while( fgets(zLine, sizeof(zLine), in) ){
+    lineno++;
+    a = b = c = 0;
+    n = sscanf(zLine, "%19s %d %lu %lu", zKind, &i, &a, &b);
+    if( n<=0 ) continue;
+    if( strcmp(zKind,"lemon-profile")==0 ){
+      if( sscanf(zLine, "%*s %d %lu", &i, &a)!=2
+       || i!=lemp->nsymbol+1 || a!=(unsigned long)lemp->nrule ){
+        ErrorMsg(zFile, lineno,
+          "This profile is not from a parser of %s.", lemp->filename);
+        break;
+      }
+      inDump = 1;
+      pProf->nDump++;
+    }else if( !inDump ){
+      ErrorMsg(zFile, lineno, "Not a lemon profile.");
+      break;
+    }else if( strcmp(zKind,"end")==0 ){
+      inDump = 0;
+    }else if( strcmp(zKind,"state")==0 && n==4
+           && i>=0 && i<lemp->nstate ){
+      pProf->aShift[i] += a;
+      pProf->aGoto[i] += b;
+    }else if( strcmp(zKind,"rule")==0 && n==3 && i>=0 && i<lemp->nrule ){
+      pProf->aReduce[i] += a;
+    }else if( strcmp(zKind,"fallback")==0 && n==3
+           && i>=0 && i<lemp->nsymbol ){
+      pProf->aFallback[i] += a;
+    }else if( strcmp(zKind,"wildcard")==0 && n==3
+           && i>=0 && i<lemp->nsymbol ){
+      pProf->aWildcard[i] += a;
+    }else if( strcmp(zKind,"depth")==0 && n==3
+           && i>=0 && i<PROFILE_DEPTHS ){
+      pProf->aDepth[i] += a;
+    }else if( strcmp(zKind,"parses")==0
+           && sscanf(zLine, "%*s %lu %lu %lu", &a, &b, &c)==3 ){
+      pProf->nAccept += a;
+      pProf->nFail += b;
+      pProf->nOverflow += c;
+    }else if( strcmp(zKind,"errors")==0
+           && sscanf(zLine, "%*s %lu %lu %lu", &a, &b, &c)==3 ){
+      pProf->nError += a;
+      pProf->nErrorShift += b;
+      pProf->nDiscard += c;
+    }else{
+      ErrorMsg(zFile, lineno, "Malformed profile line.");
+      break;
+    }
+  }
+  if( !feof(in) || inDump || pProf->nDump==0 ){
+    if( feof(in) ) ErrorMsg(zFile, lineno, "The profile is incomplete.");
+    lemp->errorcnt++;
+    fclose(in);
+    free(pProf->aShift);
+    free(pProf->aGoto);
+    free(pProf->aReduce);
+    free(pProf->aFallback);
+    free(pProf->aWildcard);
+    free(pProf);
+    return 0;
+  }
+  fclose(in);
+  return pProf;
+}
+
+/* Return the number of times the parser was in state stp, that is the
+** number of tokens it shifted there plus the gotos out of it. */
+unsigned long Profile_state(struct profile *pProf, struct state *stp)
+{
+  return pProf->aShift[stp->origstatenum] + pProf->aGoto[stp->origstatenum];
+}
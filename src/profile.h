@@ -0,0 +1,31 @@
+#ifndef _PROFILE_H_
+#define _PROFILE_H_
+
+#include "struct.h"
+
+#define PROFILE_DEPTHS 32        /* Buckets of the stack depth histogram */
+
+/* The counts of a runtime profile written by ParseProfile() in a parser
+** built with YYPROFILE.  States are indexed by origstatenum, rules by
+** index and tokens by symbol index, so the profile fits the grammar
+** however its tables are laid out. */
+struct profile {
+  unsigned long *aShift;     /* Tokens shifted in each state */
+  unsigned long *aGoto;      /* Gotos out of each state */
+  unsigned long *aReduce;    /* Reductions by each rule */
+  unsigned long *aFallback;  /* Tokens retried as their fallback */
+  unsigned long *aWildcard;  /* Tokens matched by the wildcard */
+  unsigned long nAccept;     /* Parses accepted */
+  unsigned long nFail;       /* Parses failed */
+  unsigned long nOverflow;   /* Stack overflows */
+  unsigned long nError;      /* Syntax errors reported */
+  unsigned long nErrorShift; /* Shifts of the error symbol */
+  unsigned long nDiscard;    /* Tokens discarded by error recovery */
+  unsigned long aDepth[PROFILE_DEPTHS];  /* Parses by log2 of deepest stack */
+  int nDump;                 /* Number of dumps summed up */
+};
+
+struct profile *Profile_read(struct lemon *, const char *);
+unsigned long Profile_state(struct profile *, struct state *);
+
+#endif // _PROFILE_H_
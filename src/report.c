@@ -7,6 +7,7 @@
 #include "table.h"
 #include "set.h"
 #include "action.h"
+#include "profile.h"
 
 /* Generate a filename with the given suffix.  Space to hold the
 ** name comes from malloc() and must be freed by the calling
@@ -227,6 +228,88 @@ int PrintAction(
   return result;
 }
 
+/* Compare two rules by their count in a profile, most frequent first */
+static struct profile *pProfileSort;
+static int profile_rule_compare(const void *a, const void *b){
+  const struct rule *pA = *(const struct rule**)a;
+  const struct rule *pB = *(const struct rule**)b;
+  unsigned long nA = pProfileSort->aReduce[pA->index];
+  unsigned long nB = pProfileSort->aReduce[pB->index];
+  if( nA!=nB ) return nA<nB ? 1 : -1;
+  return pA->iRule - pB->iRule;
+}
+
+/* Print the summary of a runtime profile at the end of the report:
+** the rules by how often they were reduced, the tokens that were
+** retried as their fallback or matched by the wildcard, error recovery
+** and the histogram of stack depths.
+*/
+PRIVATE void ProfilePrint(FILE *fp, struct lemon *lemp){
+  struct profile *pProf = lemp->profile;
+  struct rule **aRule;
+  struct rule *rp;
+  unsigned long nTotal = 0, nVisit = 0;
+  int i;
+
+  fprintf(fp, "----------------------------------------------------\n");
+  fprintf(fp, "Profile (%d dump%s):\n", pProf->nDump,
+          pProf->nDump==1 ? "" : "s");
+  fprintf(fp, "  parses: %lu accepted, %lu failed, %lu overflowed\n",
+          pProf->nAccept, pProf->nFail, pProf->nOverflow);
+  fprintf(fp, "  syntax errors: %lu, error shifts: %lu, "
+              "tokens discarded: %lu\n",
+          pProf->nError, pProf->nErrorShift, pProf->nDiscard);
+  for(i=0; i<lemp->nstate; i++){
+    nVisit += Profile_state(pProf, lemp->sorted[i]);
+  }
+  fprintf(fp, "  state visits: %lu\n", nVisit);
+
+  aRule = (struct rule**)calloc(lemp->nrule, sizeof(aRule[0]));
+  MemoryCheck(aRule);
+  for(i=0, rp=lemp->rule; rp; rp=rp->next){
+    aRule[i++] = rp;
+    nTotal += pProf->aReduce[rp->index];
+  }
+  pProfileSort = pProf;
+  qsort(aRule, lemp->nrule, sizeof(aRule[0]), profile_rule_compare);
+  fprintf(fp, "\nReductions: %lu\n", nTotal);
+  for(i=0; i<lemp->nrule; i++){
+    unsigned long n = pProf->aReduce[aRule[i]->index];
+    char buf[20];
+    lemon_sprintf(buf, "(%d)", aRule[i]->iRule);
+    fprintf(fp, "  %12lu %5.1f%% %6s ", n,
+            nTotal ? 100.0*n/nTotal : 0.0, buf);
+    RulePrint(fp, aRule[i], -1);
+    fprintf(fp, "\n");
+  }
+  free(aRule);
+
+  for(i=0; i<lemp->nterminal; i++){
+    if( pProf->aFallback[i] || pProf->aWildcard[i] ) break;
+  }
+  if( i<lemp->nterminal ){
+    fprintf(fp, "\nFallback and wildcard matches:\n");
+    for(i=0; i<lemp->nterminal; i++){
+      struct symbol *sp = lemp->symbols[i];
+      if( pProf->aFallback[i] ){
+        fprintf(fp, "  %12lu  %s => %s\n", pProf->aFallback[i], sp->name,
+                sp->fallback ? sp->fallback->name : "?");
+      }
+      if( pProf->aWildcard[i] ){
+        fprintf(fp, "  %12lu  %s => %s\n", pProf->aWildcard[i], sp->name,
+                lemp->wildcard ? lemp->wildcard->name : "?");
+      }
+    }
+  }
+
+  fprintf(fp, "\nDeepest stack of each parse:\n");
+  for(i=0; i<PROFILE_DEPTHS; i++){
+    if( pProf->aDepth[i]==0 ) continue;
+    fprintf(fp, "  %10lu to %-10lu %12lu\n", i ? 1UL<<i : 0UL,
+            (2UL<<i)-1, pProf->aDepth[i]);
+  }
+}
+
 /* Generate the "*.out" log file */
 void ReportOutput(struct lemon *lemp)
 {
@@ -241,6 +324,11 @@ void ReportOutput(struct lemon *lemp)
   for(i=0; i<lemp->nxstate; i++){
     stp = lemp->sorted[i];
     fprintf(fp,"State %d:\n",stp->statenum);
+    if( lemp->profile ){
+      fprintf(fp,"          [%lu shifts, %lu gotos]\n",
+              lemp->profile->aShift[stp->origstatenum],
+              lemp->profile->aGoto[stp->origstatenum]);
+    }
     if( lemp->basisflag ) cfp=stp->bp;
     else                  cfp=stp->cfp;
     while( cfp ){
@@ -288,6 +376,7 @@ void ReportOutput(struct lemon *lemp)
     }
     fprintf(fp, "\n");
   }
+  if( lemp->profile ) ProfilePrint(fp, lemp);
   fclose(fp);
   return;
 }
@@ -393,7 +482,11 @@ extern char *user_templatename;
 ** a pointer to the opened file. */
 PRIVATE FILE *tplt_open(struct lemon *lemp)
 {
-  static char templatename[] = "lempar.c";
+  static char defaultname[] = "lempar.c";
+  static char runtimename[] = "lempar_rt.c";
+  static char cppname[] = "lempar.cpp";
+  char *templatename = lemp->runtime ? runtimename
+                     : lemp->cplusplus ? cppname : defaultname;
   char buf[1000];
   FILE *in;
   char *tpltname;
@@ -508,7 +601,11 @@ void emit_destructor_code(
  }
  for(; *cp; cp++){
    if( *cp=='$' && cp[1]=='$' ){
-     fprintf(out,"(yypminor->yy%d)",sp->dtnum);
+     if( lemp->tokenhandle && sp->type==TERMINAL ){
+       fprintf(out,"yyTokenValue(yypParser,yypminor->yy0)");
+     }else{
+       fprintf(out,"(yypminor->yy%d)",sp->dtnum);
+     }
      cp++;
      continue;
    }
@@ -531,6 +628,8 @@ int has_destructor(struct symbol *sp, struct lemon *lemp)
   int ret;
   if( sp->type==TERMINAL ){
     ret = lemp->tokendest!=0;
+  }else if( sp->arena ){
+    ret = 0;     /* The value lives in the arena */
   }else{
     ret = lemp->vardest!=0 || sp->destructor!=0;
   }
@@ -590,6 +689,15 @@ PRIVATE char *append_str(const char *zText, int n, int p1, int p2){
   return z;
 }
 
+/*
+** Return the ".dtnum" of the value of a RHS symbol.  A multi-terminal
+** holds the value of its first terminal.
+*/
+PRIVATE int rhs_dtnum(struct symbol *sp){
+  if( sp->type==MULTITERMINAL ) return sp->subsym[0]->dtnum;
+  return sp->dtnum;
+}
+
 /*
 ** zCode is a string that is the action associated with a rule.  Expand
 ** the symbols in this string so that they refer to elements of the parser
@@ -606,9 +714,25 @@ PRIVATE int translate_code(struct lemon *lemp, struct rule *rp){
   const char *zSkip = 0; /* The zOvwrt comment within rp->code, or NULL */
   char lhsused = 0;      /* True if the LHS element has been used */
   char lhsdirect;        /* True if LHS writes directly into stack */
+  char keepRhs0 = 0;     /* True if the LHS takes over the RHS[0] value (C++) */
   char used[MAXRHS];     /* True for each RHS element which is used */
   char zLhs[50];         /* Convert the LHS symbol into this string */
   char zOvwrt[900];      /* Comment that to allow LHS to overwrite RHS */
+  const char *zMinor;    /* Format of a minor value on the stack */
+  const char *zDestruct; /* Format of a call to destroy a stack value */
+  const char *zLhsSet;   /* Format of the assignment of a saved LHS value */
+
+  /* With the split stack layout the minor values are addressed
+  ** through yymvp[] instead of yymsp[] */
+  if( lemp->splitstack ){
+    zMinor = "yymvp[%d].yy%d";
+    zDestruct = "  yy_destructor(yypParser,%d,&yymvp[%d]);\n";
+    zLhsSet = "  yymvp[%d].yy%d = ";
+  }else{
+    zMinor = "yymsp[%d].minor.yy%d";
+    zDestruct = "  yy_destructor(yypParser,%d,&yymsp[%d].minor);\n";
+    zLhsSet = "  yymsp[%d].minor.yy%d = ";
+  }
 
   for(i=0; i<rp->nrhs; i++) used[i] = 0;
   lhsused = 0;
@@ -620,7 +744,43 @@ PRIVATE int translate_code(struct lemon *lemp, struct rule *rp){
   }
 
 
-  if( rp->nrhs==0 ){
+  if( lemp->cplusplus ){
+    /* A C++ value must be constructed before it is assigned and destroyed
+    ** when it leaves the stack.  The LHS value is built in its stack slot
+    ** if the rule has no RHS, takes over the left-most RHS value in place
+    ** if the two share a label (or are both unlabeled, of the same type and
+    ** without a destructor), or else is built in yylhsminor and moved into
+    ** the slot once the RHS values are destroyed. */
+    lhsdirect = 1;
+    if( rp->nrhs==0 ){
+      append_str(0,0,0,0);
+      append_str("  yyConstructAt(yymsp[1].minor.yy%d);\n",0,
+                 rp->lhs->dtnum,0);
+      rp->codePrefix = Strsafe(append_str(0,0,0,0));
+    }else if( rp->lhsalias && rp->rhsalias[0]
+           && strcmp(rp->lhsalias,rp->rhsalias[0])==0 ){
+      keepRhs0 = 1;
+      lhsused = 1;
+      used[0] = 1;
+      if( rp->lhs->dtnum!=rp->rhs[0]->dtnum ){
+        ErrorMsg(lemp->filename,rp->ruleline,
+          "%s(%s) and %s(%s) share the same label but have "
+          "different datatypes.",
+          rp->lhs->name, rp->lhsalias, rp->rhs[0]->name, rp->rhsalias[0]);
+        lemp->errorcnt++;
+      }
+    }else if( rp->lhsalias==0 && rp->rhsalias[0]==0
+           && rp->lhs->dtnum==rhs_dtnum(rp->rhs[0])
+           && !has_destructor(rp->rhs[0],lemp) ){
+      keepRhs0 = 1;
+    }else if( rp->lhsalias ){
+      lhsdirect = 0;
+      append_str(0,0,0,0);
+      append_str("  YYMINORTYPE yylhsminor;\n"
+                 "  yyConstructAt(yylhsminor.yy%d);\n",0,rp->lhs->dtnum,0);
+      rp->codePrefix = Strsafe(append_str(0,0,0,0));
+    }
+  }else if( rp->nrhs==0 ){
     /* If there are no RHS symbols, then writing directly to the LHS is ok */
     lhsdirect = 1;
   }else if( rp->rhsalias[0]==0 ){
@@ -629,8 +789,7 @@ PRIVATE int translate_code(struct lemon *lemp, struct rule *rp){
     lhsdirect = 1;
     if( has_destructor(rp->rhs[0],lemp) ){
       append_str(0,0,0,0);
-      append_str("  yy_destructor(yypParser,%d,&yymsp[%d].minor);\n", 0,
-                 rp->rhs[0]->index,1-rp->nrhs);
+      append_str(zDestruct, 0, rp->rhs[0]->index,1-rp->nrhs);
       rp->codePrefix = Strsafe(append_str(0,0,0,0));
     }
   }else if( rp->lhsalias==0 ){
@@ -662,9 +821,10 @@ PRIVATE int translate_code(struct lemon *lemp, struct rule *rp){
     }
   }
   if( lhsdirect ){
-    sprintf(zLhs, "yymsp[%d].minor.yy%d",1-rp->nrhs,rp->lhs->dtnum);
+    sprintf(zLhs, zMinor,1-rp->nrhs,rp->lhs->dtnum);
   }else{
-    rc = 1;
+    /* The C++ prefix declares its own yylhsminor */
+    rc = !lemp->cplusplus;
     sprintf(zLhs, "yylhsminor.yy%d",rp->lhs->dtnum);
   }
 
@@ -701,13 +861,15 @@ PRIVATE int translate_code(struct lemon *lemp, struct rule *rp){
               append_str("yymsp[%d].major",-1,i-rp->nrhs+1,0);
             }else{
               struct symbol *sp = rp->rhs[i];
-              int dtnum;
-              if( sp->type==MULTITERMINAL ){
-                dtnum = sp->subsym[0]->dtnum;
+              int dtnum = rhs_dtnum(sp);
+              if( lemp->tokenhandle && sp->type!=NONTERMINAL ){
+                /* The stack only holds the handle of a token */
+                append_str("yyTokenValue(yypParser,",0,0,0);
+                append_str(zMinor,0,i-rp->nrhs+1, dtnum);
+                append_str(")",0,0,0);
               }else{
-                dtnum = sp->dtnum;
+                append_str(zMinor,0,i-rp->nrhs+1, dtnum);
               }
-              append_str("yymsp[%d].minor.yy%d",0,i-rp->nrhs+1, dtnum);
             }
             cp = xp;
             used[i] = 1;
@@ -763,16 +925,37 @@ PRIVATE int translate_code(struct lemon *lemp, struct rule *rp){
           rp->rhsalias[i],rp->rhs[i]->name,rp->rhsalias[i]);
         lemp->errorcnt++;
       }
-    }else if( i>0 && has_destructor(rp->rhs[i],lemp) ){
-      append_str("  yy_destructor(yypParser,%d,&yymsp[%d].minor);\n", 0,
-         rp->rhs[i]->index,i-rp->nrhs+1);
+    }
+    if( lemp->cplusplus ){
+      /* Every RHS value is destroyed, by its %destructor if the code
+      ** does not use it */
+      if( i==0 && keepRhs0 ) continue;
+      if( !used[i] && has_destructor(rp->rhs[i],lemp) ){
+        append_str(zDestruct, 0, rp->rhs[i]->index,i-rp->nrhs+1);
+      }else{
+        append_str("  yyDestroyAt(yymsp[%d].minor.yy%d);\n", 0,
+                   i-rp->nrhs+1, rhs_dtnum(rp->rhs[i]));
+      }
+    }else if( rp->rhsalias[i]==0 && i>0 && has_destructor(rp->rhs[i],lemp) ){
+      append_str(zDestruct, 0, rp->rhs[i]->index,i-rp->nrhs+1);
     }
   }
 
-  /* If unable to write LHS values directly into the stack, write the
-  ** saved LHS value now. */
-  if( lhsdirect==0 ){
-    append_str("  yymsp[%d].minor.yy%d = ", 0, 1-rp->nrhs, rp->lhs->dtnum);
+  if( lemp->cplusplus ){
+    /* Put the LHS value into the slot of the left-most RHS value */
+    if( lhsdirect==0 ){
+      append_str("  yyMoveInto(yymsp[%d].minor.yy%d, ", 0,
+                 1-rp->nrhs, rp->lhs->dtnum);
+      append_str(zLhs, 0, 0, 0);
+      append_str(");\n", 0, 0, 0);
+    }else if( rp->nrhs>0 && !keepRhs0 ){
+      append_str("  yyConstructAt(yymsp[%d].minor.yy%d);\n", 0,
+                 1-rp->nrhs, rp->lhs->dtnum);
+    }
+  }else if( lhsdirect==0 ){
+    /* If unable to write LHS values directly into the stack, write the
+    ** saved LHS value now. */
+    append_str(zLhsSet, 0, 1-rp->nrhs, rp->lhs->dtnum);
     append_str(zLhs, 0, 0, 0);
     append_str(";\n", 0, 0, 0);
   }
@@ -830,6 +1013,50 @@ PRIVATE void emit_code(
  return;
 }
 
+/*
+** Print yyVisitValue(), the function of a C++ parser that calls the
+** function object f with the member of YYMINORTYPE that holds the value
+** of symbol yymajor.  Symbols with the same ".dtnum" share a case.
+*/
+PRIVATE void print_value_visitor(
+  FILE *out,                  /* The output stream */
+  struct lemon *lemp,         /* The main info structure for this parser */
+  int *plineno                /* Pointer to the line number */
+){
+  char *done;               /* True for the symbols already written */
+  int i, j, n;
+
+  done = (char*)calloc( lemp->nsymbol, 1 );
+  if( done==0 ){
+    fprintf(stderr,"Out of memory.\n");
+    exit(1);
+  }
+  /* An unused error symbol has no member */
+  if( !lemp->errsym->useCnt ) done[lemp->errsym->index] = 1;
+  fprintf(out,"template<class F>\n"); (*plineno)++;
+  fprintf(out,"static void yyVisitValue(int yymajor, YYMINORTYPE *yypminor,"
+              " F f){\n"); (*plineno)++;
+  fprintf(out,"  switch( yymajor ){\n"); (*plineno)++;
+  for(i=0; i<lemp->nsymbol; i++){
+    if( done[i] ) continue;
+    for(j=i, n=0; j<lemp->nsymbol; j++){
+      if( done[j] || lemp->symbols[j]->dtnum!=lemp->symbols[i]->dtnum ){
+        continue;
+      }
+      fprintf(out,"%scase %d:", (n%8)==0 ? "    " : " ", j);
+      if( (n%8)==7 ){ fprintf(out,"\n"); (*plineno)++; }
+      done[j] = 1;
+      n++;
+    }
+    if( (n%8)!=0 ){ fprintf(out,"\n"); (*plineno)++; }
+    fprintf(out,"      f(yypminor->yy%d); break;\n",
+            lemp->symbols[i]->dtnum); (*plineno)++;
+  }
+  fprintf(out,"  }\n"); (*plineno)++;
+  fprintf(out,"}\n"); (*plineno)++;
+  free(done);
+}
+
 /*
 ** Print the definition of the union used for the parser's data stack.
 ** This union contains fields for every possible data type for tokens
@@ -901,7 +1128,8 @@ void print_stack_union(
     while( *cp ) stddt[j++] = *cp++;
     while( j>0 && ISSPACE(stddt[j-1]) ) j--;
     stddt[j] = 0;
-    if( lemp->tokentype && strcmp(stddt, lemp->tokentype)==0 ){
+    if( lemp->tokentype && strcmp(stddt, lemp->tokentype)==0
+     && !lemp->tokenhandle ){
       sp->dtnum = 0;
       continue;
     }
@@ -936,9 +1164,22 @@ void print_stack_union(
   fprintf(out,"#define %sTOKENTYPE %s\n",name,
     lemp->tokentype?lemp->tokentype:"void*");  lineno++;
   if( mhflag ){ fprintf(out,"#endif\n"); lineno++; }
-  fprintf(out,"typedef union {\n"); lineno++;
+  if( lemp->cplusplus ){
+    /* Members with constructors or destructors of their own delete those
+    ** of the union.  Its own do nothing: each value is constructed and
+    ** destroyed explicitly, through the member of its symbol. */
+    fprintf(out,"union YYMINORTYPE {\n"); lineno++;
+    fprintf(out,"  YYMINORTYPE() {}\n"); lineno++;
+    fprintf(out,"  ~YYMINORTYPE() {}\n"); lineno++;
+  }else{
+    fprintf(out,"typedef union {\n"); lineno++;
+  }
   fprintf(out,"  int yyinit;\n"); lineno++;
-  fprintf(out,"  %sTOKENTYPE yy0;\n",name); lineno++;
+  if( lemp->tokenhandle ){
+    fprintf(out,"  unsigned int yy0;\n"); lineno++;
+  }else{
+    fprintf(out,"  %sTOKENTYPE yy0;\n",name); lineno++;
+  }
   for(i=0; i<arraysize; i++){
     if( types[i]==0 ) continue;
     fprintf(out,"  %s yy%d;\n",types[i],i+1); lineno++;
@@ -949,7 +1190,12 @@ void print_stack_union(
   }
   free(stddt);
   free(types);
-  fprintf(out,"} YYMINORTYPE;\n"); lineno++;
+  if( lemp->cplusplus ){
+    fprintf(out,"};\n"); lineno++;
+    print_value_visitor(out, lemp, &lineno);
+  }else{
+    fprintf(out,"} YYMINORTYPE;\n"); lineno++;
+  }
   *plineno = lineno;
 }
 
@@ -994,16 +1240,23 @@ struct axset {
   int isTkn;           /* True to use tokens.  False for non-terminals */
   int nAction;         /* Number of actions */
   int iOrder;          /* Original order of action sets */
+  unsigned long nHit;  /* Lookups in the layout profile, or 0 */
 };
 
 /*
-** Compare to axset structures for sorting purposes
+** Compare to axset structures for sorting purposes.  Empty sets go
+** last.  Sets looked up more often in the layout profile go first, so
+** that the hot part of the yy_action[] table is small and contiguous.
 */
 static int axset_compare(const void *a, const void *b){
   struct axset *p1 = (struct axset*)a;
   struct axset *p2 = (struct axset*)b;
   int c;
-  c = p2->nAction - p1->nAction;
+  c = (p2->nAction>0) - (p1->nAction>0);
+  if( c==0 && p1->nHit!=p2->nHit ){
+    c = p1->nHit<p2->nHit ? 1 : -1;
+  }
+  if( c==0 ) c = p2->nAction - p1->nAction;
   if( c==0 ){
     c = p1->iOrder - p2->iOrder;
   }
@@ -1045,173 +1298,1354 @@ static FILE *source_open(struct lemon *lemp)
     }
     return fp;
   } else {
-    return file_open(lemp,".c","wb");
+    return file_open(lemp,lemp->cplusplus ? ".cpp" : ".c","wb");
   }
 }
 
-/* Generate C source code for the parser */
-void ReportTable(
-  struct lemon *lemp,
-  int mhflag     /* Output in makeheaders format if true */
-){
-  FILE *out, *in;
-  char line[LINESIZE];
-  int  lineno;
-  struct state *stp;
-  struct action *ap;
-  struct rule *rp;
-  struct acttab *pActtab;
-  int i, j, n, sz;
-  int szActionType;     /* sizeof(YYACTIONTYPE) */
-  int szCodeType;       /* sizeof(YYCODETYPE)   */
-  const char *name;
-  int mnTknOfst, mxTknOfst;
-  int mnNtOfst, mxNtOfst;
-  struct axset *ax;
+/*
+** One of the output files of a parser split by the -split option.
+** The file is written under a temporary name and replaces the previous
+** output only if its content changed, so that files whose content is
+** the same keep their timestamps and do not have to be recompiled.
+*/
+struct splitfile {
+  FILE *out;            /* The open stream */
+  char *zName;          /* Name of the output file */
+  char *zTemp;          /* Name the file is written under */
+  int lineno;           /* Line number of the next line written */
+};
 
-  in = tplt_open(lemp);
-  if( in==0 ) return;
-  out = source_open(lemp);
-  if( out==0 ){
-    fclose(in);
-    return;
-  }
-  lineno = 1;
-  tplt_xfer(lemp->name,in,out,&lineno);
+/*
+** Return the name of an output file of a split parser.  The name is the
+** name of the main .c file with its suffix replaced by zSuffix.
+*/
+PRIVATE char *split_makename(const char *zMain, const char *zSuffix)
+{
+  char *name;
+  char *cp;
 
-  /* Generate the include code, if any */
-  tplt_print(out,lemp,lemp->include,&lineno);
-  if( mhflag ){
-    char *incName = file_makename(lemp, ".h");
-    fprintf(out,"#include \"%s\"\n", incName); lineno++;
-    free(incName);
-  }
-  tplt_xfer(lemp->name,in,out,&lineno);
+  name = (char*)malloc( lemonStrlen(zMain) + lemonStrlen(zSuffix) + 5 );
+  MemoryCheck(name);
+  lemon_strcpy(name,zMain);
+  cp = strrchr(name,'.');
+  if( cp && strchr(cp,'/')==0 && strchr(cp,'\\')==0 ) *cp = 0;
+  lemon_strcat(name,zSuffix);
+  return name;
+}
 
-  /* Generate #defines for all tokens */
-  if( mhflag ){
-    const char *prefix;
-    fprintf(out,"#if INTERFACE\n"); lineno++;
-    if( lemp->tokenprefix ) prefix = lemp->tokenprefix;
-    else                    prefix = "";
-    for(i=1; i<lemp->nterminal; i++){
-      fprintf(out,"#define %s%-30s %2d\n",prefix,lemp->symbols[i]->name,i);
-      lineno++;
-    }
-    fprintf(out,"#endif\n"); lineno++;
+/*
+** Open an output file of a split parser.  zName is taken over by the
+** splitfile.  The current output file of lemp becomes the new file so
+** that the #line directives refer to it.  Return 0 on failure.
+*/
+PRIVATE int split_open(struct lemon *lemp, struct splitfile *sf, char *zName)
+{
+  sf->zName = zName;
+  sf->zTemp = (char*)malloc( lemonStrlen(zName) + 5 );
+  MemoryCheck(sf->zTemp);
+  lemon_sprintf(sf->zTemp, "%s.tmp", zName);
+  sf->lineno = 1;
+  sf->out = fopen(sf->zTemp, "wb");
+  if( sf->out==0 ){
+    fprintf(stderr,"Can't open file \"%s\".\n",sf->zTemp);
+    lemp->errorcnt++;
+    free(sf->zTemp);
+    free(sf->zName);
+    return 0;
   }
-  tplt_xfer(lemp->name,in,out,&lineno);
+  if( lemp->outname ) free(lemp->outname);
+  lemp->outname = strdup(zName);
+  return 1;
+}
 
-  /* Generate the defines */
-  fprintf(out,"#define YYCODETYPE %s\n",
-    minimum_size_type(0, lemp->nsymbol+1, &szCodeType)); lineno++;
-  fprintf(out,"#define YYNOCODE %d\n",lemp->nsymbol+1);  lineno++;
-  fprintf(out,"#define YYACTIONTYPE %s\n",
-    minimum_size_type(0,lemp->nstate+lemp->nrule*2+5,&szActionType)); lineno++;
-  if( lemp->wildcard ){
-    fprintf(out,"#define YYWILDCARD %d\n",
-       lemp->wildcard->index); lineno++;
-  }
-  print_stack_union(out,lemp,&lineno,mhflag);
-  fprintf(out, "#ifndef YYSTACKDEPTH\n"); lineno++;
-  if( lemp->stacksize ){
-    fprintf(out,"#define YYSTACKDEPTH %s\n",lemp->stacksize);  lineno++;
-  }else{
-    fprintf(out,"#define YYSTACKDEPTH 100\n");  lineno++;
-  }
-  fprintf(out, "#endif\n"); lineno++;
-  if( mhflag ){
-    fprintf(out,"#if INTERFACE\n"); lineno++;
-  }
-  name = lemp->name ? lemp->name : "Parse";
-  if( lemp->arg && lemp->arg[0] ){
-    i = lemonStrlen(lemp->arg);
-    while( i>=1 && ISSPACE(lemp->arg[i-1]) ) i--;
-    while( i>=1 && (ISALNUM(lemp->arg[i-1]) || lemp->arg[i-1]=='_') ) i--;
-    fprintf(out,"#define %sARG_SDECL %s;\n",name,lemp->arg);  lineno++;
-    fprintf(out,"#define %sARG_PDECL ,%s\n",name,lemp->arg);  lineno++;
-    fprintf(out,"#define %sARG_FETCH %s = yypParser->%s\n",
-                 name,lemp->arg,&lemp->arg[i]);  lineno++;
-    fprintf(out,"#define %sARG_STORE yypParser->%s = %s\n",
-                 name,&lemp->arg[i],&lemp->arg[i]);  lineno++;
+/*
+** Close an output file of a split parser and move it into place, unless
+** the previous output is the same.
+*/
+PRIVATE void split_close(struct splitfile *sf)
+{
+  FILE *a, *b;
+  int same = 0;
+
+  fclose(sf->out);
+  a = fopen(sf->zTemp, "rb");
+  b = fopen(sf->zName, "rb");
+  if( a && b ){
+    int c1, c2;
+    do{
+      c1 = getc(a);
+      c2 = getc(b);
+    }while( c1==c2 && c1!=EOF );
+    same = c1==c2;
+  }
+  if( a ) fclose(a);
+  if( b ) fclose(b);
+  if( same ){
+    remove(sf->zTemp);
   }else{
-    fprintf(out,"#define %sARG_SDECL\n",name);  lineno++;
-    fprintf(out,"#define %sARG_PDECL\n",name);  lineno++;
-    fprintf(out,"#define %sARG_FETCH\n",name); lineno++;
-    fprintf(out,"#define %sARG_STORE\n",name); lineno++;
-  }
-  if( mhflag ){
-    fprintf(out,"#endif\n"); lineno++;
-  }
-  if( lemp->errsym->useCnt ){
-    fprintf(out,"#define YYERRORSYMBOL %d\n",lemp->errsym->index); lineno++;
-    fprintf(out,"#define YYERRSYMDT yy%d\n",lemp->errsym->dtnum); lineno++;
-  }
-  if( lemp->has_fallback ){
-    fprintf(out,"#define YYFALLBACK 1\n");  lineno++;
+    remove(sf->zName);
+    rename(sf->zTemp, sf->zName);
   }
+  free(sf->zTemp);
+  free(sf->zName);
+}
 
-  /* Compute the action table, but do not output it yet.  The action
-  ** table must be computed before generating the YYNSTATE macro because
-  ** we need to know how many states can be eliminated.
-  */
-  ax = (struct axset *) calloc(lemp->nxstate*2, sizeof(ax[0]));
-  if( ax==0 ){
-    fprintf(stderr,"malloc failed\n");
-    exit(1);
+/*
+** Write the directive that includes the internal header of a split
+** parser.  The header is in the same directory as the file.
+*/
+PRIVATE void split_include(FILE *out, const char *zHdr, int *lineno)
+{
+  const char *z = zHdr;
+  const char *cp;
+  for(cp=zHdr; *cp; cp++){
+    if( *cp=='/' || *cp=='\\' ) z = cp+1;
   }
-  for(i=0; i<lemp->nxstate; i++){
-    stp = lemp->sorted[i];
-    ax[i*2].stp = stp;
-    ax[i*2].isTkn = 1;
-    ax[i*2].nAction = stp->nTknAct;
-    ax[i*2+1].stp = stp;
-    ax[i*2+1].isTkn = 0;
-    ax[i*2+1].nAction = stp->nNtAct;
+  fprintf(out, "#include \"%s\"\n", z); (*lineno)++;
+}
+
+/*
+** Write the case labels and the action for one group of lookaheads
+** that share the same action.  Used by print_direct_code().
+*/
+PRIVATE void print_direct_cases(
+  FILE *out,
+  struct lookahead_action *aLa,
+  int n,
+  int *lineno
+){
+  int i, j;
+  for(i=0; i<n; i=j){
+    fprintf(out, "     ");
+    for(j=i; j<n && aLa[j].action==aLa[i].action; j++){
+      if( j>i && (j-i)%8==0 ){ fprintf(out, "\n     "); (*lineno)++; }
+      fprintf(out, " case %d:", aLa[j].lookahead);
+    }
+    fprintf(out, " return %d;\n", aLa[i].action); (*lineno)++;
   }
-  mxTknOfst = mnTknOfst = 0;
-  mxNtOfst = mnNtOfst = 0;
-  /* In an effort to minimize the action table size, use the heuristic
-  ** of placing the largest action sets first */
-  for(i=0; i<lemp->nxstate*2; i++) ax[i].iOrder = i;
-  qsort(ax, lemp->nxstate*2, sizeof(ax[0]), axset_compare);
-  pActtab = acttab_alloc();
-  for(i=0; i<lemp->nxstate*2 && ax[i].nAction>0; i++){
-    stp = ax[i].stp;
-    if( ax[i].isTkn ){
-      for(ap=stp->ap; ap; ap=ap->next){
-        int action;
-        if( ap->sp->index>=lemp->nterminal ) continue;
-        action = compute_action(lemp, ap);
-        if( action<0 ) continue;
-        acttab_action(pActtab, ap->sp->index, action);
-      }
-      stp->iTknOfst = acttab_insert(pActtab);
-      if( stp->iTknOfst<mnTknOfst ) mnTknOfst = stp->iTknOfst;
-      if( stp->iTknOfst>mxTknOfst ) mxTknOfst = stp->iTknOfst;
+}
+
+/*
+** Compare two lookahead/action pairs so that pairs with the same action
+** are adjacent.
+*/
+static int direct_case_compare(const void *a, const void *b){
+  const struct lookahead_action *p1 = (const struct lookahead_action*)a;
+  const struct lookahead_action *p2 = (const struct lookahead_action*)b;
+  int c = p1->action - p2->action;
+  if( c==0 ) c = p1->lookahead - p2->lookahead;
+  return c;
+}
+
+/*
+** Generate the automaton as code instead of as the yy_action[] tables.
+**
+** Two functions are written.  yy_dc_shift() holds one case per state,
+** each a switch on the terminal look-ahead, and yy_dc_goto() does the
+** same for the nonterminal gotos taken after a reduce.  Every switch
+** falls through to the default action of its state.  The driver in the
+** template is unchanged and calls these in place of the table lookups.
+** zStorage is the storage class of the two functions.  The number of
+** case labels written is left in lemp->nactiontab for the -s report.
+*/
+PRIVATE void print_direct_code(
+  FILE *out,
+  struct lemon *lemp,
+  const char *zStorage,
+  int *lineno
+){
+  struct state *stp;
+  struct action *ap;
+  struct lookahead_action *aLa;
+  int i, n, isTkn, dflt;
+
+  aLa = (struct lookahead_action *) calloc(lemp->nsymbol+1, sizeof(aLa[0]));
+  MemoryCheck(aLa);
+  lemp->nactiontab = 0;
+  for(isTkn=1; isTkn>=0; isTkn--){
+    if( isTkn ){
+      fprintf(out, "%sunsigned int yy_dc_shift(int stateno, "
+                   "int iLookAhead){\n", zStorage);
     }else{
+      fprintf(out, "%sint yy_dc_goto(int stateno, int iLookAhead){\n",
+                   zStorage);
+    }
+    (*lineno)++;
+    fprintf(out, "  switch( stateno ){\n"); (*lineno)++;
+    for(i=0; i<lemp->nxstate; i++){
+      stp = lemp->sorted[i];
+      dflt = stp->iDfltReduce + lemp->nstate + lemp->nrule;
+      n = 0;
       for(ap=stp->ap; ap; ap=ap->next){
         int action;
-        if( ap->sp->index<lemp->nterminal ) continue;
-        if( ap->sp->index==lemp->nsymbol ) continue;
+        if( isTkn ){
+          if( ap->sp->index>=lemp->nterminal ) continue;
+        }else{
+          if( ap->sp->index<lemp->nterminal ) continue;
+          if( ap->sp->index==lemp->nsymbol ) continue;
+        }
         action = compute_action(lemp, ap);
         if( action<0 ) continue;
-        acttab_action(pActtab, ap->sp->index, action);
+        aLa[n].lookahead = ap->sp->index;
+        aLa[n].action = action;
+        n++;
       }
-      stp->iNtOfst = acttab_insert(pActtab);
-      if( stp->iNtOfst<mnNtOfst ) mnNtOfst = stp->iNtOfst;
-      if( stp->iNtOfst>mxNtOfst ) mxNtOfst = stp->iNtOfst;
-    }
-#if 0  /* Uncomment for a trace of how the yy_action[] table fills out */
-    { int jj, nn;
-      for(jj=nn=0; jj<pActtab->nAction; jj++){
-        if( pActtab->aAction[jj].action<0 ) nn++;
+      lemp->nactiontab += n+1;
+      if( n==0 ){
+        fprintf(out, "    case %d: return %d;\n", i, dflt); (*lineno)++;
+        continue;
       }
-      printf("%4d: State %3d %s n: %2d size: %5d freespace: %d\n",
-             i, stp->statenum, ax[i].isTkn ? "Token" : "Var  ",
-             ax[i].nAction, pActtab->nAction, nn);
+      qsort(aLa, n, sizeof(aLa[0]), direct_case_compare);
+      fprintf(out, "    case %d: switch( iLookAhead ){\n", i); (*lineno)++;
+      print_direct_cases(out, aLa, n, lineno);
+      fprintf(out, "      default: return %d;\n", dflt); (*lineno)++;
+      fprintf(out, "    }\n"); (*lineno)++;
     }
-#endif
+    fprintf(out, "  }\n"); (*lineno)++;
+    fprintf(out, "  return YY_ERROR_ACTION;\n"); (*lineno)++;
+    fprintf(out, "}\n"); (*lineno)++;
+  }
+  free(aLa);
+}
+
+/*
+** Return true if the rule has no code of its own once translated.
+** Such rules share the "default:" case of the reduce switch.
+*/
+PRIVATE int rule_has_no_code(struct rule *rp)
+{
+  return rp->code[0]=='\n'
+      && rp->code[1]==0
+      && rp->codePrefix==0
+      && rp->codeSuffix==0;
+}
+
+/*
+** Generate the body of the reduce switch in yy_reduce().  With
+** DISPATCH_GOTO the cases are written with the yyrulecase() and
+** yyruledone macros of the template, preceded by a table of label
+** addresses for the computed goto, and every rule gets its own label
+** in place of the "default:" case.
+*/
+PRIVATE void print_reduce_cases(
+  FILE *out,
+  struct lemon *lemp,
+  int nLhsMinor,        /* Number of actions that use yylhsminor */
+  int *lineno
+){
+  struct rule *rp, *rp2;
+  int isGoto = lemp->dispatch==DISPATCH_GOTO;
+  const char *zCase = isGoto ? "      yyrulecase(%d): /* " : "      case %d: /* ";
+  const char *zDone = isGoto ? "        yyruledone;\n" : "        break;\n";
+  int i;
+
+  if( nLhsMinor ){
+    fprintf(out,"        YYMINORTYPE yylhsminor;\n"); (*lineno)++;
+  }
+  if( isGoto ){
+    fprintf(out,"#ifndef YYREDUCEGOTO\n"); (*lineno)++;
+    fprintf(out,"# error \"reduce cases written for YYREDUCEGOTO\"\n");
+    (*lineno)++;
+    fprintf(out,"#endif\n"); (*lineno)++;
+    fprintf(out,"#ifdef YYCOMPUTEDGOTO\n"); (*lineno)++;
+    fprintf(out,"      static const void *const yyRuleLabel[] = {\n");
+    (*lineno)++;
+    for(i=0; i<lemp->nrule; i++){
+      fprintf(out,"%s&&yyrule_%d,", (i%6)==0 ? "        " : " ", i);
+      if( (i%6)==5 || i==lemp->nrule-1 ){ fprintf(out,"\n"); (*lineno)++; }
+    }
+    fprintf(out,"      };\n"); (*lineno)++;
+    fprintf(out,"      goto *yyRuleLabel[yyruleno];\n"); (*lineno)++;
+    fprintf(out,"#endif\n"); (*lineno)++;
+  }
+  /* First output rules other than the default: rule */
+  for(rp=lemp->rule; rp; rp=rp->next){
+    if( rp->code==0 ) continue;
+    if( rule_has_no_code(rp) ){
+      /* No actions, so this will be part of the "default:" rule */
+      continue;
+    }
+    fprintf(out,zCase, rp->iRule);
+    writeRuleText(out, rp);
+    fprintf(out, " */\n"); (*lineno)++;
+    for(rp2=rp->next; rp2; rp2=rp2->next){
+      if( rp2->code==rp->code && rp2->codePrefix==rp->codePrefix
+             && rp2->codeSuffix==rp->codeSuffix ){
+        fprintf(out,zCase, rp2->iRule);
+        writeRuleText(out, rp2);
+        fprintf(out," */ yytestcase(yyruleno==%d);\n", rp2->iRule); (*lineno)++;
+        rp2->code = 0;
+      }
+    }
+    emit_code(out,rp,lemp,lineno);
+    fprintf(out,"%s",zDone); (*lineno)++;
+    rp->code = 0;
+  }
+  /* Finally, output the default: rule.  We choose as the default: all
+  ** empty actions. */
+  if( !isGoto ){
+    fprintf(out,"      default:\n"); (*lineno)++;
+  }
+  for(rp=lemp->rule; rp; rp=rp->next){
+    if( rp->code==0 ) continue;
+    assert( rp->code[0]=='\n' && rp->code[1]==0 );
+    assert( rp->codePrefix==0 );
+    assert( rp->codeSuffix==0 );
+    if( isGoto ){
+      fprintf(out,zCase, rp->iRule);
+    }else{
+      fprintf(out,"      /* (%d) ", rp->iRule);
+    }
+    writeRuleText(out, rp);
+    fprintf(out, " */ yytestcase(yyruleno==%d);\n", rp->iRule); (*lineno)++;
+  }
+  fprintf(out,"%s",zDone); (*lineno)++;
+}
+
+/*
+** Write the function for the reduce action of rule rp.  The rules in
+** aFunc[] that share the action are listed in a comment in front of it.
+*/
+PRIVATE void print_reduce_function(
+  FILE *out,
+  struct lemon *lemp,
+  struct rule *rp,
+  int *aFunc,           /* Rule whose function each rule uses, or -1 */
+  const char *zArgs,    /* Parameter list of the function */
+  int nLhsMinor,        /* Number of actions that use yylhsminor */
+  int *lineno
+){
+  struct rule *rp2;
+  const char *name = lemp->name ? lemp->name : "Parse";
+
+  for(rp2=rp; rp2; rp2=rp2->next){
+    if( aFunc[rp2->iRule]!=rp->iRule ) continue;
+    fprintf(out,"/* ");
+    writeRuleText(out, rp2);
+    fprintf(out," */\n"); (*lineno)++;
+  }
+  if( lemp->nsplit ){
+    fprintf(out,"void %s_yy_action_%d(%s){\n", name, rp->iRule, zArgs);
+  }else{
+    fprintf(out,"static void yy_action_%d(%s){\n", rp->iRule, zArgs);
+  }
+  (*lineno)++;
+  if( nLhsMinor && strstr(rp->codeSuffix ? rp->codeSuffix : "",
+                          "yylhsminor") ){
+    fprintf(out,"  YYMINORTYPE yylhsminor;\n"); (*lineno)++;
+  }
+  fprintf(out,"  %sARG_FETCH;\n", name); (*lineno)++;
+  emit_code(out,rp,lemp,lineno);
+  fprintf(out,"  %sARG_STORE;\n", name); (*lineno)++;
+  fprintf(out,"}\n"); (*lineno)++;
+  rp->code = 0;
+}
+
+/*
+** Generate one static function for every distinct reduce action,
+** followed by the yyReduceFunc[] table that maps rule numbers to them.
+** Rules without code map to NULL.  The functions receive the same
+** yypParser, yymsp and (with the split stack) yymvp that the code would
+** see inside yy_reduce().
+**
+** A split parser writes the functions to lemp->nsplit files of their
+** own, in contiguous runs of rules, and only the table to "out".  The
+** names of those files are derived from zMain, the name of the driver.
+*/
+PRIVATE void print_reduce_functions(
+  FILE *out,
+  struct lemon *lemp,
+  int nLhsMinor,        /* Number of actions that use yylhsminor */
+  const char *zMain,    /* Driver of a split parser */
+  int *lineno
+){
+  struct rule *rp, *rp2;
+  const char *name = lemp->name ? lemp->name : "Parse";
+  const char *zArgs;
+  char *zHdr = 0;
+  int *aFunc;
+  int i, nFunc, iFunc, iShard, nShard;
+
+  zArgs = lemp->splitstack ? "yyParser *yypParser, yyStackEntry *yymsp, "
+                             "YYMINORTYPE *yymvp"
+                           : "yyParser *yypParser, yyStackEntry *yymsp";
+  aFunc = (int *) calloc(lemp->nrule, sizeof(aFunc[0]));
+  MemoryCheck(aFunc);
+  for(i=0; i<lemp->nrule; i++) aFunc[i] = -1;
+
+  /* Rules with the same code share the function of the first of them */
+  nFunc = 0;
+  for(rp=lemp->rule; rp; rp=rp->next){
+    if( rp->code==0 || rule_has_no_code(rp) ) continue;
+    aFunc[rp->iRule] = rp->iRule;
+    nFunc++;
+    for(rp2=rp->next; rp2; rp2=rp2->next){
+      if( rp2->code==rp->code && rp2->codePrefix==rp->codePrefix
+             && rp2->codeSuffix==rp->codeSuffix ){
+        aFunc[rp2->iRule] = rp->iRule;
+        rp2->code = 0;
+      }
+    }
+  }
+
+  if( lemp->nsplit ){
+    zHdr = split_makename(zMain, "_int.h");
+  }else{
+    fprintf(out,"#define YYREDUCEFUNC 1\n"); (*lineno)++;
+  }
+  nShard = lemp->nsplit ? lemp->nsplit : 1;
+  rp = lemp->rule;
+  iFunc = 0;
+  for(iShard=0; iShard<nShard; iShard++){
+    int iEnd = (int)(((long)(iShard+1)*nFunc)/nShard);
+    struct splitfile shard;
+    FILE *fp = out;
+    int *pLine = lineno;
+    if( lemp->nsplit ){
+      char zSuffix[30];
+      lemon_sprintf(zSuffix, "_act%d.c", iShard);
+      if( !split_open(lemp, &shard, split_makename(zMain, zSuffix)) ) break;
+      split_include(shard.out, zHdr, &shard.lineno);
+      fp = shard.out;
+      pLine = &shard.lineno;
+    }
+    for(; rp && iFunc<iEnd; rp=rp->next){
+      if( aFunc[rp->iRule]!=rp->iRule ) continue;
+      print_reduce_function(fp, lemp, rp, aFunc, zArgs, nLhsMinor, pLine);
+      iFunc++;
+    }
+    if( lemp->nsplit ) split_close(&shard);
+  }
+
+  if( lemp->nsplit ){
+    for(i=0; i<lemp->nrule; i++){
+      if( aFunc[i]!=i ) continue;
+      fprintf(out,"void %s_yy_action_%d(%s);\n", name, i, zArgs);
+      (*lineno)++;
+    }
+    fprintf(out,"void (*const yyReduceFunc[])(%s) = {\n", zArgs);
+  }else{
+    fprintf(out,"static void (*const yyReduceFunc[])(%s) = {\n", zArgs);
+  }
+  (*lineno)++;
+  for(i=0, rp=lemp->rule; rp; rp=rp->next, i++){
+    assert( rp->iRule==i );
+    if( aFunc[i]<0 ){
+      fprintf(out,"  0,");
+    }else if( lemp->nsplit ){
+      fprintf(out,"  %s_yy_action_%d,", name, aFunc[i]);
+    }else{
+      fprintf(out,"  yy_action_%d,", aFunc[i]);
+    }
+    fprintf(out," /* (%d) ", i);
+    writeRuleText(out, rp);
+    fprintf(out," */\n"); (*lineno)++;
+  }
+  fprintf(out,"};\n"); (*lineno)++;
+  free(zHdr);
+  free(aFunc);
+}
+
+/*
+** Return the type of the yy_shift_ofst[] and yy_reduce_ofst[] tables,
+** whose values range from lwr to upr.  Set *pnByte to its size.
+*/
+PRIVATE const char *offset_type(
+  struct lemon *lemp,
+  int lwr,
+  int upr,
+  int *pnByte
+){
+  if( lemp->runtime ){
+    *pnByte = sizeof(int);
+    return "lemonrt_offset";
+  }
+  return minimum_size_type(lwr, upr, pnByte);
+}
+
+/*
+** Helpers for write_table_file().  Numbers are written in the byte order
+** of this machine.
+*/
+PRIVATE void tblfile_u16(FILE *out, int v){
+  unsigned short x = (unsigned short)v;
+  fwrite(&x, sizeof(x), 1, out);
+}
+PRIVATE void tblfile_i32(FILE *out, int v){
+  fwrite(&v, sizeof(v), 1, out);
+}
+PRIVATE int tblfile_align(FILE *out){
+  while( ftell(out)%8 ) putc(0, out);
+  return (int)ftell(out);
+}
+
+/*
+** Return a hash of the names of the symbols and of the symbols of every
+** rule.  A table file and the code of a grammar for the shared engine
+** both carry it, so that lemonrt_load() can tell whether they go together.
+** The FNV-1a hash is used.
+*/
+PRIVATE unsigned int grammar_fingerprint(struct lemon *lemp){
+  unsigned int h = 2166136261u;
+  struct rule *rp;
+  const char *z;
+  int i;
+#define FNV(X) h = (h ^ (unsigned int)(X)) * 16777619u
+  for(i=0; i<lemp->nsymbol; i++){
+    for(z=lemp->symbols[i]->name; *z; z++) FNV((unsigned char)*z);
+    FNV(0);
+  }
+  for(rp=lemp->rule; rp; rp=rp->next){
+    FNV(rp->lhs->index);
+    FNV(rp->nrhs);
+    for(i=0; i<rp->nrhs; i++) FNV(rp->rhs[i]->index);
+  }
+#undef FNV
+  return h;
+}
+
+/*
+** Return a hash of the grammar_fingerprint() and of the action of every
+** state on every symbol, with the states numbered as in the generated
+** parser.  ParseSerialize() writes it into the state it saves, so that
+** ParseDeserialize() refuses a state saved by a build whose states are
+** numbered otherwise, as with -P, -c or -u, or act otherwise.
+*/
+PRIVATE unsigned int table_fingerprint(struct lemon *lemp){
+  unsigned int h = grammar_fingerprint(lemp);
+  struct state *stp;
+  struct action *ap;
+  int i, action;
+#define FNV(X) h = (h ^ (unsigned int)(X)) * 16777619u
+  for(i=0; i<lemp->nxstate; i++){
+    stp = lemp->sorted[i];
+    for(ap=stp->ap; ap; ap=ap->next){
+      if( ap->sp->index==lemp->nsymbol ) continue;
+      action = compute_action(lemp, ap);
+      if( action<0 ) continue;
+      FNV(ap->sp->index);
+      FNV(action);
+    }
+    FNV(lemp->nsymbol);
+    FNV(stp->iDfltReduce);
+  }
+#undef FNV
+  return h;
+}
+
+/*
+** Write the parsing tables to the table file "X.ltab" that lemonrt_load()
+** of the shared parser engine maps into memory.  The layout is that of
+** struct lemonrt_file_header in runtime/lemonrt.h: a header of 4 magic
+** bytes and 33 numbers, then the tables.  The tables hold the same values
+** as the arrays that ReportTable() writes to the parser.  With -o, the
+** file is named after the output file instead, like the -split files.
+*/
+PRIVATE void write_table_file(
+  struct lemon *lemp,
+  struct acttab *pActtab,
+  int mnTknOfst,            /* Lowest offset in yy_shift_ofst[] */
+  int mnNtOfst              /* Lowest offset in yy_reduce_ofst[] */
+){
+  enum {
+    H_VERSION, H_BYTEORDER, H_FILESIZE, H_NSTATE, H_NRULE, H_NOCODE,
+    H_ERRORSYMBOL, H_MAXSHIFT, H_MINSHIFTREDUCE, H_MAXSHIFTREDUCE,
+    H_MINREDUCE, H_MAXREDUCE, H_ERRORACTION, H_ACCEPTACTION, H_NOACTION,
+    H_NACTTAB, H_SHIFTUSEDFLT, H_SHIFTCOUNT, H_REDUCEUSEDFLT, H_REDUCECOUNT,
+    H_NFALLBACK, H_WILDCARD, H_NSYMBOL, H_ACTION, H_LOOKAHEAD, H_SHIFTOFST,
+    H_REDUCEOFST, H_DEFAULT, H_FALLBACK, H_RULEINFO, H_TOKENNAME,
+    H_RULENAME, H_FINGERPRINT, H_COUNT
+  };
+  int aHdr[H_COUNT];
+  FILE *out;
+  struct rule *rp;
+  int i, n, nShift, nReduce, nFallback;
+
+  if( lemp->nsymbol+1>0xffff || lemp->nstate+lemp->nrule*2+5>0xffff ){
+    ErrorMsg(lemp->filename,0,
+      "The grammar is too large for a table file.");
+    lemp->errorcnt++;
+    return;
+  }
+  if( user_output_file ){
+    /* Name the table file after the -o output, as the split files are */
+    if( lemp->outname ) free(lemp->outname);
+    lemp->outname = split_makename(user_output_file, ".ltab");
+    out = fopen(lemp->outname, "wb");
+    if( out==0 ){
+      fprintf(stderr,"Can't open file \"%s\".\n",lemp->outname);
+      lemp->errorcnt++;
+      return;
+    }
+  }else{
+    out = file_open(lemp, ".ltab", "wb");
+    if( out==0 ) return;
+  }
+
+  nShift = lemp->nxstate;
+  while( nShift>0 && lemp->sorted[nShift-1]->iTknOfst==NO_OFFSET ) nShift--;
+  nReduce = lemp->nxstate;
+  while( nReduce>0 && lemp->sorted[nReduce-1]->iNtOfst==NO_OFFSET ) nReduce--;
+  nFallback = 0;
+  if( lemp->has_fallback && !lemp->foldfallback ){
+    nFallback = lemp->nterminal;
+    while( nFallback>1 && lemp->symbols[nFallback-1]->fallback==0 ){
+      nFallback--;
+    }
+  }
+  n = acttab_size(pActtab);
+  memset(aHdr, 0, sizeof(aHdr));
+  aHdr[H_VERSION] = 2;
+  aHdr[H_BYTEORDER] = 0x01020304;
+  aHdr[H_NSTATE] = lemp->nxstate;
+  aHdr[H_NRULE] = lemp->nrule;
+  aHdr[H_NOCODE] = lemp->nsymbol+1;
+  aHdr[H_ERRORSYMBOL] = lemp->errsym->useCnt ? lemp->errsym->index : 0;
+  aHdr[H_MAXSHIFT] = lemp->nxstate-1;
+  aHdr[H_MINSHIFTREDUCE] = lemp->nstate;
+  aHdr[H_MAXSHIFTREDUCE] = lemp->nstate + lemp->nrule - 1;
+  aHdr[H_MINREDUCE] = lemp->nstate + lemp->nrule;
+  aHdr[H_MAXREDUCE] = lemp->nstate + lemp->nrule*2 - 1;
+  aHdr[H_ERRORACTION] = lemp->nstate + lemp->nrule*2;
+  aHdr[H_ACCEPTACTION] = lemp->nstate + lemp->nrule*2 + 1;
+  aHdr[H_NOACTION] = lemp->nstate + lemp->nrule*2 + 2;
+  aHdr[H_NACTTAB] = n;
+  aHdr[H_SHIFTUSEDFLT] = mnTknOfst-1;
+  aHdr[H_SHIFTCOUNT] = nShift-1;
+  aHdr[H_REDUCEUSEDFLT] = mnNtOfst-1;
+  aHdr[H_REDUCECOUNT] = nReduce-1;
+  aHdr[H_NFALLBACK] = nFallback;
+  if( lemp->wildcard && !lemp->foldfallback ){
+    aHdr[H_WILDCARD] = lemp->wildcard->index;
+  }
+  aHdr[H_NSYMBOL] = lemp->nsymbol;
+  aHdr[H_FINGERPRINT] = (int)grammar_fingerprint(lemp);
+  fwrite("LEMT", 4, 1, out);
+  fwrite(aHdr, sizeof(aHdr), 1, out);
+
+  /* yy_action[] and yy_lookahead[] */
+  aHdr[H_ACTION] = tblfile_align(out);
+  for(i=0; i<n; i++){
+    int action = acttab_yyaction(pActtab, i);
+    if( action<0 ) action = lemp->nstate + lemp->nrule + 2;
+    tblfile_u16(out, action);
+  }
+  aHdr[H_LOOKAHEAD] = tblfile_align(out);
+  for(i=0; i<n; i++){
+    int la = acttab_yylookahead(pActtab, i);
+    if( la<0 ) la = lemp->nsymbol;
+    tblfile_u16(out, la);
+  }
+
+  /* yy_shift_ofst[], yy_reduce_ofst[] and yy_default[] */
+  aHdr[H_SHIFTOFST] = tblfile_align(out);
+  for(i=0; i<nShift; i++){
+    int ofst = lemp->sorted[i]->iTknOfst;
+    tblfile_i32(out, ofst==NO_OFFSET ? mnTknOfst-1 : ofst);
+  }
+  aHdr[H_REDUCEOFST] = tblfile_align(out);
+  for(i=0; i<nReduce; i++){
+    int ofst = lemp->sorted[i]->iNtOfst;
+    tblfile_i32(out, ofst==NO_OFFSET ? mnNtOfst-1 : ofst);
+  }
+  aHdr[H_DEFAULT] = tblfile_align(out);
+  for(i=0; i<lemp->nxstate; i++){
+    tblfile_u16(out, lemp->sorted[i]->iDfltReduce+lemp->nstate+lemp->nrule);
+  }
+
+  /* yyFallback[] and yyRuleInfo[] */
+  aHdr[H_FALLBACK] = tblfile_align(out);
+  for(i=0; i<nFallback; i++){
+    struct symbol *p = lemp->symbols[i];
+    tblfile_u16(out, p->fallback ? p->fallback->index : 0);
+  }
+  aHdr[H_RULEINFO] = tblfile_align(out);
+  for(rp=lemp->rule; rp; rp=rp->next){
+    tblfile_u16(out, rp->lhs->index);
+    putc(rp->nrhs, out);
+    putc(0, out);
+  }
+
+  /* The names of the symbols and of the rules */
+  aHdr[H_TOKENNAME] = tblfile_align(out);
+  for(i=0; i<lemp->nsymbol; i++){
+    fputs(lemp->symbols[i]->name, out);
+    putc(0, out);
+  }
+  aHdr[H_RULENAME] = tblfile_align(out);
+  for(rp=lemp->rule; rp; rp=rp->next){
+    writeRuleText(out, rp);
+    putc(0, out);
+  }
+  aHdr[H_FILESIZE] = (int)ftell(out);
+
+  fseek(out, 4, SEEK_SET);
+  fwrite(aHdr, sizeof(aHdr), 1, out);
+  fclose(out);
+}
+
+/*
+** Begin the definition of one of the constant parsing tables, of nEntry
+** entries.  A split parser defines the table in its tables file "tbl"
+** under a name of its own, and declares it in the internal header "out".
+** A C++ parser defines it as a constexpr std::array member of the
+** yyTables struct.
+*/
+PRIVATE void print_table_start(
+  FILE *out,
+  FILE *tbl,
+  struct lemon *lemp,
+  const char *zType,
+  const char *zTable,
+  int nEntry,
+  int *lineno,
+  int *tbllineno
+){
+  if( lemp->nsplit ){
+    const char *name = lemp->name ? lemp->name : "Parse";
+    fprintf(out,"#define %s %s_%s\n", zTable, name, zTable); (*lineno)++;
+    fprintf(out,"extern const %s %s[];\n", zType, zTable); (*lineno)++;
+    fprintf(tbl,"const %s %s[] = {\n", zType, zTable);
+  }else if( lemp->cplusplus ){
+    fprintf(tbl,"static constexpr std::array<%s,%d> %s = {{\n",
+            zType, nEntry, zTable);
+  }else{
+    fprintf(tbl,"static const %s %s[] = {\n", zType, zTable);
+  }
+  (*tbllineno)++;
+}
+
+/*
+** End the definition of a table begun by print_table_start().
+*/
+PRIVATE void print_table_end(FILE *tbl, struct lemon *lemp, int *tbllineno){
+  fprintf(tbl, lemp->cplusplus ? "}};\n" : "};\n"); (*tbllineno)++;
+}
+
+/*
+** Declare, in the internal header of a split parser, the functions and
+** tables that are defined in one of its files and used in another.
+*/
+PRIVATE void print_split_declarations(
+  FILE *out,
+  struct lemon *lemp,
+  int *lineno
+){
+  const char *name = lemp->name ? lemp->name : "Parse";
+  fprintf(out,"#define YYREDUCEFUNC 1\n"); (*lineno)++;
+  fprintf(out,"#define yyReduceFunc %s_yyReduceFunc\n", name); (*lineno)++;
+  fprintf(out,"extern void (*const yyReduceFunc[])(%s);\n",
+          lemp->splitstack ? "yyParser*, yyStackEntry*, YYMINORTYPE*"
+                           : "yyParser*, yyStackEntry*"); (*lineno)++;
+  if( !lemp->recognizer ){
+    fprintf(out,"#define yy_destructor %s_yy_destructor\n", name);
+    (*lineno)++;
+    fprintf(out,"void yy_destructor(yyParser*, YYCODETYPE, YYMINORTYPE*);\n");
+    (*lineno)++;
+  }
+  fprintf(out,"#ifndef NDEBUG\n"); (*lineno)++;
+  fprintf(out,"#define yyTokenName %s_yyTokenName\n", name); (*lineno)++;
+  fprintf(out,"extern const char *const yyTokenName[];\n"); (*lineno)++;
+  fprintf(out,"#define yyRuleName %s_yyRuleName\n", name); (*lineno)++;
+  fprintf(out,"extern const char *const yyRuleName[YYNRULE];\n"); (*lineno)++;
+  fprintf(out,"#endif\n"); (*lineno)++;
+}
+
+/*
+** Write the tables that map the state and rule numbers of the generated
+** parser back to the numbers lemon first gave them, for YYPROFILE.  Those
+** do not depend on the options that change the layout of the tables.
+*/
+PRIVATE void print_profile_ids(FILE *out, struct lemon *lemp, int *lineno){
+  struct rule *rp;
+  int i, mx;
+
+  fprintf(out,"#ifdef YYPROFILE\n"); (*lineno)++;
+  for(i=mx=0; i<lemp->nxstate; i++){
+    if( lemp->sorted[i]->origstatenum>mx ) mx = lemp->sorted[i]->origstatenum;
+  }
+  fprintf(out,"static const %s yyProfileState[] = {\n",
+          minimum_size_type(0, mx, 0)); (*lineno)++;
+  for(i=0; i<lemp->nxstate; i++){
+    fprintf(out," %4d,", lemp->sorted[i]->origstatenum);
+    if( (i%10)==9 || i==lemp->nxstate-1 ){ fprintf(out,"\n"); (*lineno)++; }
+  }
+  fprintf(out,"};\n"); (*lineno)++;
+  fprintf(out,"static const %s yyProfileRule[] = {\n",
+          minimum_size_type(0, lemp->nrule, 0)); (*lineno)++;
+  for(i=0, rp=lemp->rule; rp; rp=rp->next, i++){
+    fprintf(out," %4d,", rp->index);
+    if( (i%10)==9 || rp->next==0 ){ fprintf(out,"\n"); (*lineno)++; }
+  }
+  fprintf(out,"};\n"); (*lineno)++;
+  fprintf(out,"#endif /* YYPROFILE */\n"); (*lineno)++;
+}
+
+/*
+** Write the terminals that each state expects as bit sets, for
+** ParseExpectedTokens() and error recovery in a parser compiled with
+** YYEXPECTED.  States that expect the same terminals share one row of
+** yyExpectSet[], and yyExpectIndex[] holds the row of each state.
+*/
+PRIVATE void print_expected_sets(FILE *out, struct lemon *lemp, int *lineno){
+  int nByte = (lemp->nterminal+7)/8;
+  int *aRow, *aFirst;
+  unsigned *aHash;
+  int nRow = 0;
+  int i, j, k;
+  char *pSet;
+
+  aRow = (int*)calloc(lemp->nxstate*2, sizeof(int));
+  aHash = (unsigned*)calloc(lemp->nxstate, sizeof(unsigned));
+  if( aRow==0 || aHash==0 ){
+    fprintf(stderr,"malloc failed\n");
+    exit(1);
+  }
+  aFirst = &aRow[lemp->nxstate];
+  for(i=0; i<lemp->nxstate; i++){
+    pSet = lemp->sorted[i]->expect;
+    for(j=0; j<lemp->nterminal; j++){
+      aHash[i] = aHash[i]*31 + (SetFind(pSet,j)!=0);
+    }
+    for(k=0; k<nRow; k++){
+      struct state *stp = lemp->sorted[aFirst[k]];
+      if( aHash[aFirst[k]]!=aHash[i] ) continue;
+      for(j=0; j<lemp->nterminal; j++){
+        if( (SetFind(stp->expect,j)!=0)!=(SetFind(pSet,j)!=0) ) break;
+      }
+      if( j==lemp->nterminal ) break;
+    }
+    if( k==nRow ) aFirst[nRow++] = i;
+    aRow[i] = k;
+  }
+
+  fprintf(out,"#ifdef YYEXPECTED\n"); (*lineno)++;
+  fprintf(out,"#define YYEXPECTBYTES %d\n", nByte); (*lineno)++;
+  fprintf(out,"static const unsigned char yyExpectSet[] = {\n"); (*lineno)++;
+  for(k=0; k<nRow; k++){
+    pSet = lemp->sorted[aFirst[k]]->expect;
+    for(i=0; i<nByte; i++){
+      int x = 0;
+      for(j=0; j<8 && i*8+j<lemp->nterminal; j++){
+        if( SetFind(pSet,i*8+j) ) x |= 1<<j;
+      }
+      if( i==0 ) fprintf(out," /* %4d */ ", k);
+      else if( (i%12)==0 ) fprintf(out,"            ");
+      fprintf(out," 0x%02x,", x);
+      if( (i%12)==11 || i==nByte-1 ){ fprintf(out,"\n"); (*lineno)++; }
+    }
+  }
+  fprintf(out,"};\n"); (*lineno)++;
+  fprintf(out,"static const %s yyExpectIndex[] = {\n",
+          minimum_size_type(0, nRow-1, 0)); (*lineno)++;
+  for(i=0; i<lemp->nxstate; i++){
+    fprintf(out," %4d,", aRow[i]);
+    if( (i%10)==9 || i==lemp->nxstate-1 ){ fprintf(out,"\n"); (*lineno)++; }
+  }
+  fprintf(out,"};\n"); (*lineno)++;
+  fprintf(out,"#endif /* YYEXPECTED */\n"); (*lineno)++;
+  free(aHash);
+  free(aRow);
+}
+
+/*
+** Write the action table and its associates:
+**
+**  yy_action[]        A single table containing all actions.
+**  yy_lookahead[]     A table containing the lookahead for each entry in
+**                     yy_action.  Used to detect hash collisions.
+**  yy_shift_ofst[]    For each state, the offset into yy_action for
+**                     shifting terminals.
+**  yy_reduce_ofst[]   For each state, the offset into yy_action for
+**                     shifting non-terminals after a reduce.
+**  yy_default[]       Default action for each state.
+**
+** The macros go to "out" and the tables to "tbl", as for
+** print_table_start().
+*/
+#define CACHELINE 64            /* Bytes in a cache line */
+
+/*
+** Compare two cache line weights so that the heaviest line goes first.
+*/
+static int line_weight_compare(const void *a, const void *b){
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+  return x<y ? 1 : x>y ? -1 : 0;
+}
+
+/*
+** Estimate from the runtime profile how many cache lines of the lookup
+** tables a parser reads.  The tokens shifted in a state are spread
+** evenly over the entries of its row in yy_lookahead[] and yy_action[],
+** and each reads the state's entry of yy_shift_ofst[].  The gotos out of
+** a state do the same with its nonterminal row and yy_reduce_ofst[].
+** Reduce and default actions are not in the profile, so they are left
+** out.  Record how many lines there are, and how few of them, taking
+** the most-read first, serve 90% and 99% of the reads.
+*/
+PRIVATE void count_hot_lines(
+  struct lemon *lemp,
+  struct profile *pProf,
+  int nAction,                    /* Entries in yy_action[] */
+  int nShift, int nReduce,        /* Entries in yy_shift/reduce_ofst[] */
+  int szActionType,               /* sizeof(YYACTIONTYPE) */
+  int szCodeType,                 /* sizeof(YYCODETYPE) */
+  int szShift, int szReduce       /* Sizes of yy_shift/reduce_ofst[] types */
+){
+  int aBase[5], aSize[4], aCount[4];
+  double *aLine, total = 0.0, sum;
+  int i, j, nLine;
+
+  aSize[0] = szActionType;  aCount[0] = nAction;
+  aSize[1] = szCodeType;    aCount[1] = nAction;
+  aSize[2] = szShift;       aCount[2] = nShift;
+  aSize[3] = szReduce;      aCount[3] = nReduce;
+  for(i=0, aBase[0]=0; i<4; i++){
+    aBase[i+1] = aBase[i] + (aCount[i]*aSize[i] + CACHELINE - 1)/CACHELINE;
+  }
+  nLine = aBase[4];
+  lemp->tablelines = nLine;
+  if( nLine==0 ) return;
+  aLine = (double*)calloc(nLine, sizeof(aLine[0]));
+  if( aLine==0 ){
+    fprintf(stderr,"malloc failed\n");
+    exit(1);
+  }
+#define TABLE_LINE(T,I) aLine[aBase[T] + (I)*aSize[T]/CACHELINE]
+  for(i=0; i<lemp->nxstate; i++){
+    struct state *stp = lemp->sorted[i];
+    for(j=0; j<2; j++){
+      struct action *ap;
+      int ofst = j==0 ? stp->iTknOfst : stp->iNtOfst;
+      double w;
+      int m = 0;
+      if( ofst==NO_OFFSET ) continue;
+      w = (double)(j==0 ? pProf->aShift[stp->origstatenum]
+                        : pProf->aGoto[stp->origstatenum]);
+      if( w==0.0 ) continue;
+      for(ap=stp->ap; ap; ap=ap->next){
+        if( (ap->sp->index<lemp->nterminal)!=(j==0) ) continue;
+        if( ap->sp->index==lemp->nsymbol ) continue;
+        if( compute_action(lemp, ap)<0 ) continue;
+        m++;
+      }
+      if( m==0 ) continue;
+      TABLE_LINE(2+j, stp->statenum) += w;
+      for(ap=stp->ap; ap; ap=ap->next){
+        if( (ap->sp->index<lemp->nterminal)!=(j==0) ) continue;
+        if( ap->sp->index==lemp->nsymbol ) continue;
+        if( compute_action(lemp, ap)<0 ) continue;
+        TABLE_LINE(0, ofst+ap->sp->index) += w/m;
+        TABLE_LINE(1, ofst+ap->sp->index) += w/m;
+      }
+      total += 3.0*w;
+    }
+  }
+#undef TABLE_LINE
+  qsort(aLine, nLine, sizeof(aLine[0]), line_weight_compare);
+  for(i=0, sum=0.0; i<nLine && total>0.0; i++){
+    sum += aLine[i];
+    if( lemp->hotlines90==0 && sum>=0.90*total ) lemp->hotlines90 = i+1;
+    if( lemp->hotlines99==0 && sum>=0.99*total ) lemp->hotlines99 = i+1;
+  }
+  free(aLine);
+}
+
+PRIVATE void print_action_tables(
+  FILE *out,
+  FILE *tbl,
+  struct lemon *lemp,
+  struct acttab *pActtab,
+  int mnTknOfst, int mxTknOfst,   /* Range of yy_shift_ofst[] */
+  int mnNtOfst, int mxNtOfst,     /* Range of yy_reduce_ofst[] */
+  int szActionType,               /* sizeof(YYACTIONTYPE) */
+  int szCodeType,                 /* sizeof(YYCODETYPE) */
+  int *lineno,
+  int *tl
+){
+  struct state *stp;
+  int i, j, n, sz;
+  int nShift, szShift, nReduce, szReduce;
+
+  /* Output the yy_action table */
+  lemp->nactiontab = n = acttab_size(pActtab);
+  lemp->tablesize += n*szActionType;
+  fprintf(out,"#define YY_ACTTAB_COUNT (%d)\n", n); (*lineno)++;
+  if( lemp->cplusplus ){
+    fprintf(out,"struct yyTables {\n"); (*lineno)++;
+  }
+  print_table_start(out, tbl, lemp, "YYACTIONTYPE", "yy_action", n,
+                    lineno, tl);
+  for(i=j=0; i<n; i++){
+    int action = acttab_yyaction(pActtab, i);
+    if( action<0 ) action = lemp->nstate + lemp->nrule + 2;
+    if( j==0 ) fprintf(tbl," /* %5d */ ", i);
+    fprintf(tbl, " %4d,", action);
+    if( j==9 || i==n-1 ){
+      fprintf(tbl, "\n"); (*tl)++;
+      j = 0;
+    }else{
+      j++;
+    }
+  }
+  print_table_end(tbl, lemp, tl);
+
+  /* Output the yy_lookahead table */
+  lemp->tablesize += n*szCodeType;
+  print_table_start(out, tbl, lemp, "YYCODETYPE", "yy_lookahead", n,
+                    lineno, tl);
+  for(i=j=0; i<n; i++){
+    int la = acttab_yylookahead(pActtab, i);
+    if( la<0 ) la = lemp->nsymbol;
+    if( j==0 ) fprintf(tbl," /* %5d */ ", i);
+    fprintf(tbl, " %4d,", la);
+    if( j==9 || i==n-1 ){
+      fprintf(tbl, "\n"); (*tl)++;
+      j = 0;
+    }else{
+      j++;
+    }
+  }
+  print_table_end(tbl, lemp, tl);
+
+  /* Output the yy_shift_ofst[] table */
+  fprintf(out, "#define YY_SHIFT_USE_DFLT (%d)\n", mnTknOfst-1); (*lineno)++;
+  n = lemp->nxstate;
+  while( n>0 && lemp->sorted[n-1]->iTknOfst==NO_OFFSET ) n--;
+  fprintf(out, "#define YY_SHIFT_COUNT (%d)\n", n-1); (*lineno)++;
+  fprintf(out, "#define YY_SHIFT_MIN   (%d)\n", mnTknOfst); (*lineno)++;
+  fprintf(out, "#define YY_SHIFT_MAX   (%d)\n", mxTknOfst); (*lineno)++;
+  print_table_start(out, tbl, lemp,
+                    offset_type(lemp, mnTknOfst-1, mxTknOfst, &sz),
+                    "yy_shift_ofst", n, lineno, tl);
+  lemp->tablesize += n*sz;
+  nShift = n;
+  szShift = sz;
+  for(i=j=0; i<n; i++){
+    int ofst;
+    stp = lemp->sorted[i];
+    ofst = stp->iTknOfst;
+    if( ofst==NO_OFFSET ) ofst = mnTknOfst - 1;
+    if( j==0 ) fprintf(tbl," /* %5d */ ", i);
+    fprintf(tbl, " %4d,", ofst);
+    if( j==9 || i==n-1 ){
+      fprintf(tbl, "\n"); (*tl)++;
+      j = 0;
+    }else{
+      j++;
+    }
+  }
+  print_table_end(tbl, lemp, tl);
+
+  /* Output the yy_reduce_ofst[] table */
+  fprintf(out, "#define YY_REDUCE_USE_DFLT (%d)\n", mnNtOfst-1); (*lineno)++;
+  n = lemp->nxstate;
+  while( n>0 && lemp->sorted[n-1]->iNtOfst==NO_OFFSET ) n--;
+  fprintf(out, "#define YY_REDUCE_COUNT (%d)\n", n-1); (*lineno)++;
+  fprintf(out, "#define YY_REDUCE_MIN   (%d)\n", mnNtOfst); (*lineno)++;
+  fprintf(out, "#define YY_REDUCE_MAX   (%d)\n", mxNtOfst); (*lineno)++;
+  print_table_start(out, tbl, lemp,
+                    offset_type(lemp, mnNtOfst-1, mxNtOfst, &sz),
+                    "yy_reduce_ofst", n, lineno, tl);
+  lemp->tablesize += n*sz;
+  nReduce = n;
+  szReduce = sz;
+  for(i=j=0; i<n; i++){
+    int ofst;
+    stp = lemp->sorted[i];
+    ofst = stp->iNtOfst;
+    if( ofst==NO_OFFSET ) ofst = mnNtOfst - 1;
+    if( j==0 ) fprintf(tbl," /* %5d */ ", i);
+    fprintf(tbl, " %4d,", ofst);
+    if( j==9 || i==n-1 ){
+      fprintf(tbl, "\n"); (*tl)++;
+      j = 0;
+    }else{
+      j++;
+    }
+  }
+  print_table_end(tbl, lemp, tl);
+
+  /* Output the default action table */
+  n = lemp->nxstate;
+  print_table_start(out, tbl, lemp, "YYACTIONTYPE", "yy_default", n,
+                    lineno, tl);
+  lemp->tablesize += n*szActionType;
+  for(i=j=0; i<n; i++){
+    stp = lemp->sorted[i];
+    if( j==0 ) fprintf(tbl," /* %5d */ ", i);
+    fprintf(tbl, " %4d,", stp->iDfltReduce+lemp->nstate+lemp->nrule);
+    if( j==9 || i==n-1 ){
+      fprintf(tbl, "\n"); (*tl)++;
+      j = 0;
+    }else{
+      j++;
+    }
+  }
+  print_table_end(tbl, lemp, tl);
+  if( lemp->cplusplus ){
+    fprintf(out,"};\n"); (*lineno)++;
+  }
+
+  /* Estimate the cache lines read, given a runtime profile */
+  if( lemp->layout || lemp->profile ){
+    count_hot_lines(lemp, lemp->layout ? lemp->layout : lemp->profile,
+                    lemp->nactiontab, nShift, nReduce, szActionType,
+                    szCodeType, szShift, szReduce);
+  }
+}
+
+/* Generate C source code for the parser */
+void ReportTable(
+  struct lemon *lemp,
+  int mhflag     /* Output in makeheaders format if true */
+){
+  FILE *out, *in;
+  char line[LINESIZE];
+  int  lineno;
+  struct state *stp;
+  struct action *ap;
+  struct rule *rp;
+  struct acttab *pActtab;
+  int i, j, n;
+  int szActionType;     /* sizeof(YYACTIONTYPE) */
+  int szCodeType;       /* sizeof(YYCODETYPE)   */
+  const char *name;
+  int mnTknOfst, mxTknOfst;
+  int mnNtOfst, mxNtOfst;
+  int nLhsMinor;        /* Number of actions that use yylhsminor */
+  struct axset *ax;
+  char *zMain = 0;      /* Name of the driver of a split parser */
+  struct splitfile hdr, tables, driver;
+  FILE *tbl;            /* Where the tables are defined */
+  int *tl;              /* Line number in tbl */
+
+  in = tplt_open(lemp);
+  if( in==0 ) return;
+  if( lemp->nsplit ){
+    /* A split parser starts out in its internal header.  The driver
+    ** begins after the stack definitions of the template. */
+    if( user_output_file ){
+      zMain = strdup(user_output_file);
+    }else{
+      zMain = file_makename(lemp, ".c");
+    }
+    if( !split_open(lemp, &hdr, split_makename(zMain, "_int.h")) ){
+      fclose(in);
+      free(zMain);
+      return;
+    }
+    if( !split_open(lemp, &tables, split_makename(zMain, "_tables.c")) ){
+      fclose(in);
+      fclose(hdr.out);
+      free(zMain);
+      return;
+    }
+    split_include(tables.out, hdr.zName, &tables.lineno);
+    free(lemp->outname);
+    lemp->outname = strdup(hdr.zName);
+    out = hdr.out;
+    tbl = tables.out;
+    tl = &tables.lineno;
+  }else{
+    out = source_open(lemp);
+    if( out==0 ){
+      fclose(in);
+      return;
+    }
+    tbl = out;
+    tl = &lineno;
+  }
+  lineno = 1;
+  tplt_xfer(lemp->name,in,out,&lineno);
+
+  /* Generate the include code, if any */
+  tplt_print(out,lemp,lemp->include,&lineno);
+  if( mhflag ){
+    char *incName = file_makename(lemp, ".h");
+    fprintf(out,"#include \"%s\"\n", incName); lineno++;
+    free(incName);
+  }
+  tplt_xfer(lemp->name,in,out,&lineno);
+
+  /* Generate #defines for all tokens */
+  if( mhflag ){
+    const char *prefix;
+    fprintf(out,"#if INTERFACE\n"); lineno++;
+    if( lemp->tokenprefix ) prefix = lemp->tokenprefix;
+    else                    prefix = "";
+    for(i=1; i<lemp->nterminal; i++){
+      fprintf(out,"#define %s%-30s %2d\n",prefix,lemp->symbols[i]->name,i);
+      lineno++;
+    }
+    fprintf(out,"#endif\n"); lineno++;
+  }
+  tplt_xfer(lemp->name,in,out,&lineno);
+
+  /* Generate the defines */
+  if( lemp->runtime ){
+    /* The shared engine has tables of fixed types */
+    if( lemp->nsymbol+1>0xffff || lemp->nstate+lemp->nrule*2+5>0xffff ){
+      ErrorMsg(lemp->filename,0,
+        "The grammar is too large for the shared parser engine.");
+      lemp->errorcnt++;
+    }
+    fprintf(out,"#define YYCODETYPE lemonrt_code\n"); lineno++;
+    fprintf(out,"#define YYNOCODE %d\n",lemp->nsymbol+1);  lineno++;
+    fprintf(out,"#define YYACTIONTYPE lemonrt_action\n"); lineno++;
+    szCodeType = szActionType = 2;
+  }else{
+    fprintf(out,"#define YYCODETYPE %s\n",
+      minimum_size_type(0, lemp->nsymbol+1, &szCodeType)); lineno++;
+    fprintf(out,"#define YYNOCODE %d\n",lemp->nsymbol+1);  lineno++;
+    fprintf(out,"#define YYACTIONTYPE %s\n",
+      minimum_size_type(0,lemp->nstate+lemp->nrule*2+5,&szActionType));
+    lineno++;
+  }
+  if( lemp->wildcard ){
+    fprintf(out,"#define YYWILDCARD %d\n",
+       lemp->wildcard->index); lineno++;
+  }
+  print_stack_union(out,lemp,&lineno,mhflag);
+  fprintf(out, "#ifndef YYSTACKDEPTH\n"); lineno++;
+  if( lemp->stacksize ){
+    fprintf(out,"#define YYSTACKDEPTH %s\n",lemp->stacksize);  lineno++;
+  }else{
+    fprintf(out,"#define YYSTACKDEPTH 100\n");  lineno++;
+  }
+  fprintf(out, "#endif\n"); lineno++;
+  if( mhflag ){
+    fprintf(out,"#if INTERFACE\n"); lineno++;
+  }
+  name = lemp->name ? lemp->name : "Parse";
+  if( lemp->arg && lemp->arg[0] ){
+    i = lemonStrlen(lemp->arg);
+    while( i>=1 && ISSPACE(lemp->arg[i-1]) ) i--;
+    while( i>=1 && (ISALNUM(lemp->arg[i-1]) || lemp->arg[i-1]=='_') ) i--;
+    fprintf(out,"#define %sARG_SDECL %s;\n",name,lemp->arg);  lineno++;
+    fprintf(out,"#define %sARG_PDECL ,%s\n",name,lemp->arg);  lineno++;
+    fprintf(out,"#define %sARG_PARAM ,%s\n",name,&lemp->arg[i]);  lineno++;
+    fprintf(out,"#define %sARG_FETCH %s = yypParser->%s\n",
+                 name,lemp->arg,&lemp->arg[i]);  lineno++;
+    fprintf(out,"#define %sARG_STORE yypParser->%s = %s\n",
+                 name,&lemp->arg[i],&lemp->arg[i]);  lineno++;
+  }else{
+    fprintf(out,"#define %sARG_SDECL\n",name);  lineno++;
+    fprintf(out,"#define %sARG_PDECL\n",name);  lineno++;
+    fprintf(out,"#define %sARG_PARAM\n",name);  lineno++;
+    fprintf(out,"#define %sARG_FETCH\n",name); lineno++;
+    fprintf(out,"#define %sARG_STORE\n",name); lineno++;
+  }
+  if( mhflag ){
+    fprintf(out,"#endif\n"); lineno++;
+  }
+  if( lemp->errsym->useCnt ){
+    fprintf(out,"#define YYERRORSYMBOL %d\n",lemp->errsym->index); lineno++;
+    fprintf(out,"#define YYERRSYMDT yy%d\n",lemp->errsym->dtnum); lineno++;
+  }
+  if( lemp->has_fallback ){
+    fprintf(out,"#define YYFALLBACK 1\n");  lineno++;
+  }
+  if( lemp->foldfallback ){
+    fprintf(out,"#define YYNOFALLBACKRETRY 1\n");  lineno++;
+  }
+  if( lemp->splitstack ){
+    fprintf(out,"#define YYSPLITSTACK 1\n");  lineno++;
+  }
+  if( lemp->nsplit ){
+    fprintf(out,"#define YYSPLIT 1\n");  lineno++;
+  }
+  if( lemp->recognizer ){
+    fprintf(out,"#define YYRECOGNIZER 1\n");  lineno++;
+  }else{
+    for(i=0; i<lemp->nsymbol && !has_destructor(lemp->symbols[i],lemp); i++){}
+    if( i<lemp->nsymbol ){
+      fprintf(out,"#define YYHASDESTRUCTOR 1\n");  lineno++;
+    }
+  }
+  if( lemp->tokenhandle ){
+    fprintf(out,"#define YYTOKENHANDLE 1\n");  lineno++;
+  }
+  if( lemp->arena ){
+    fprintf(out,"#define YYARENA 1\n");  lineno++;
+  }
+  if( lemp->dispatch==DISPATCH_GOTO ){
+    fprintf(out,"#define YYREDUCEGOTO 1\n");  lineno++;
+  }
+  if( lemp->syncstate ){
+    fprintf(out,"#define YYSYNCTOKEN %d\n",lemp->syncsym->index); lineno++;
+    fprintf(out,"#define YYSYNCSTATE %d\n",lemp->syncstate->statenum);
+    lineno++;
+    fprintf(out,"#define YYSYNCMAJOR %d\n",lemp->syncmajor->index); lineno++;
+  }
+
+  /* Compute the action table, but do not output it yet.  The action
+  ** table must be computed before generating the YYNSTATE macro because
+  ** we need to know how many states can be eliminated.
+  */
+  ax = (struct axset *) calloc(lemp->nxstate*2, sizeof(ax[0]));
+  if( ax==0 ){
+    fprintf(stderr,"malloc failed\n");
+    exit(1);
+  }
+  for(i=0; i<lemp->nxstate; i++){
+    stp = lemp->sorted[i];
+    ax[i*2].stp = stp;
+    ax[i*2].isTkn = 1;
+    ax[i*2].nAction = stp->nTknAct;
+    ax[i*2+1].stp = stp;
+    ax[i*2+1].isTkn = 0;
+    ax[i*2+1].nAction = stp->nNtAct;
+    if( lemp->layout ){
+      ax[i*2].nHit = Profile_state(lemp->layout, stp);
+      ax[i*2+1].nHit = lemp->layout->aGoto[stp->origstatenum];
+    }
+  }
+  mxTknOfst = mnTknOfst = 0;
+  mxNtOfst = mnNtOfst = 0;
+  /* In an effort to minimize the action table size, use the heuristic
+  ** of placing the largest action sets first.  With a layout profile,
+  ** the action sets looked up most often are placed first instead. */
+  for(i=0; i<lemp->nxstate*2; i++) ax[i].iOrder = i;
+  qsort(ax, lemp->nxstate*2, sizeof(ax[0]), axset_compare);
+  pActtab = acttab_alloc();
+  for(i=0; i<lemp->nxstate*2 && ax[i].nAction>0; i++){
+    stp = ax[i].stp;
+    if( ax[i].isTkn ){
+      for(ap=stp->ap; ap; ap=ap->next){
+        int action;
+        if( ap->sp->index>=lemp->nterminal ) continue;
+        action = compute_action(lemp, ap);
+        if( action<0 ) continue;
+        acttab_action(pActtab, ap->sp->index, action);
+      }
+      stp->iTknOfst = acttab_insert(pActtab);
+      if( stp->iTknOfst<mnTknOfst ) mnTknOfst = stp->iTknOfst;
+      if( stp->iTknOfst>mxTknOfst ) mxTknOfst = stp->iTknOfst;
+    }else{
+      for(ap=stp->ap; ap; ap=ap->next){
+        int action;
+        if( ap->sp->index<lemp->nterminal ) continue;
+        if( ap->sp->index==lemp->nsymbol ) continue;
+        action = compute_action(lemp, ap);
+        if( action<0 ) continue;
+        acttab_action(pActtab, ap->sp->index, action);
+      }
+      stp->iNtOfst = acttab_insert(pActtab);
+      if( stp->iNtOfst<mnNtOfst ) mnNtOfst = stp->iNtOfst;
+      if( stp->iNtOfst>mxNtOfst ) mxNtOfst = stp->iNtOfst;
+    }
+#if 0  /* Uncomment for a trace of how the yy_action[] table fills out */
+    { int jj, nn;
+      for(jj=nn=0; jj<pActtab->nAction; jj++){
+        if( pActtab->aAction[jj].action<0 ) nn++;
+      }
+      printf("%4d: State %3d %s n: %2d size: %5d freespace: %d\n",
+             i, stp->statenum, ax[i].isTkn ? "Token" : "Var  ",
+             ax[i].nAction, pActtab->nAction, nn);
+    }
+#endif
   }
   free(ax);
 
@@ -1219,6 +2653,16 @@ void ReportTable(
   ** been computed */
   fprintf(out,"#define YYNSTATE             %d\n",lemp->nxstate);  lineno++;
   fprintf(out,"#define YYNRULE              %d\n",lemp->nrule);  lineno++;
+  for(n=0, rp=lemp->rule; rp; rp=rp->next){
+    if( rp->nrhs>n ) n = rp->nrhs;
+  }
+  fprintf(out,"#define YYNRHSMAX            %d\n",n);  lineno++;
+  fprintf(out,"#define YYNTOKEN             %d\n",lemp->nterminal);
+  lineno++;
+  fprintf(out,"#define YYFINGERPRINT        0x%08xu\n",
+          grammar_fingerprint(lemp)); lineno++;
+  fprintf(out,"#define YYTABLEPRINT         0x%08xu\n",
+          table_fingerprint(lemp)); lineno++;
   fprintf(out,"#define YY_MAX_SHIFT         %d\n",lemp->nxstate-1); lineno++;
   fprintf(out,"#define YY_MIN_SHIFTREDUCE   %d\n",lemp->nstate); lineno++;
   i = lemp->nstate + lemp->nrule;
@@ -1231,122 +2675,52 @@ void ReportTable(
   fprintf(out,"#define YY_NO_ACTION         %d\n", i+2); lineno++;
   tplt_xfer(lemp->name,in,out,&lineno);
 
-  /* Now output the action table and its associates:
-  **
-  **  yy_action[]        A single table containing all actions.
-  **  yy_lookahead[]     A table containing the lookahead for each entry in
-  **                     yy_action.  Used to detect hash collisions.
-  **  yy_shift_ofst[]    For each state, the offset into yy_action for
-  **                     shifting terminals.
-  **  yy_reduce_ofst[]   For each state, the offset into yy_action for
-  **                     shifting non-terminals after a reduce.
-  **  yy_default[]       Default action for each state.
-  */
-
-  /* Output the yy_action table */
-  lemp->nactiontab = n = acttab_size(pActtab);
-  lemp->tablesize += n*szActionType;
-  fprintf(out,"#define YY_ACTTAB_COUNT (%d)\n", n); lineno++;
-  fprintf(out,"static const YYACTIONTYPE yy_action[] = {\n"); lineno++;
-  for(i=j=0; i<n; i++){
-    int action = acttab_yyaction(pActtab, i);
-    if( action<0 ) action = lemp->nstate + lemp->nrule + 2;
-    if( j==0 ) fprintf(out," /* %5d */ ", i);
-    fprintf(out, " %4d,", action);
-    if( j==9 || i==n-1 ){
-      fprintf(out, "\n"); lineno++;
-      j = 0;
-    }else{
-      j++;
-    }
-  }
-  fprintf(out, "};\n"); lineno++;
-
-  /* Output the yy_lookahead table */
-  lemp->tablesize += n*szCodeType;
-  fprintf(out,"static const YYCODETYPE yy_lookahead[] = {\n"); lineno++;
-  for(i=j=0; i<n; i++){
-    int la = acttab_yylookahead(pActtab, i);
-    if( la<0 ) la = lemp->nsymbol;
-    if( j==0 ) fprintf(out," /* %5d */ ", i);
-    fprintf(out, " %4d,", la);
-    if( j==9 || i==n-1 ){
-      fprintf(out, "\n"); lineno++;
-      j = 0;
-    }else{
-      j++;
-    }
-  }
-  fprintf(out, "};\n"); lineno++;
-
-  /* Output the yy_shift_ofst[] table */
-  fprintf(out, "#define YY_SHIFT_USE_DFLT (%d)\n", mnTknOfst-1); lineno++;
-  n = lemp->nxstate;
-  while( n>0 && lemp->sorted[n-1]->iTknOfst==NO_OFFSET ) n--;
-  fprintf(out, "#define YY_SHIFT_COUNT (%d)\n", n-1); lineno++;
-  fprintf(out, "#define YY_SHIFT_MIN   (%d)\n", mnTknOfst); lineno++;
-  fprintf(out, "#define YY_SHIFT_MAX   (%d)\n", mxTknOfst); lineno++;
-  fprintf(out, "static const %s yy_shift_ofst[] = {\n", 
-          minimum_size_type(mnTknOfst-1, mxTknOfst, &sz)); lineno++;
-  lemp->tablesize += n*sz;
-  for(i=j=0; i<n; i++){
-    int ofst;
-    stp = lemp->sorted[i];
-    ofst = stp->iTknOfst;
-    if( ofst==NO_OFFSET ) ofst = mnTknOfst - 1;
-    if( j==0 ) fprintf(out," /* %5d */ ", i);
-    fprintf(out, " %4d,", ofst);
-    if( j==9 || i==n-1 ){
-      fprintf(out, "\n"); lineno++;
-      j = 0;
-    }else{
-      j++;
-    }
-  }
-  fprintf(out, "};\n"); lineno++;
-
-  /* Output the yy_reduce_ofst[] table */
-  fprintf(out, "#define YY_REDUCE_USE_DFLT (%d)\n", mnNtOfst-1); lineno++;
-  n = lemp->nxstate;
-  while( n>0 && lemp->sorted[n-1]->iNtOfst==NO_OFFSET ) n--;
-  fprintf(out, "#define YY_REDUCE_COUNT (%d)\n", n-1); lineno++;
-  fprintf(out, "#define YY_REDUCE_MIN   (%d)\n", mnNtOfst); lineno++;
-  fprintf(out, "#define YY_REDUCE_MAX   (%d)\n", mxNtOfst); lineno++;
-  fprintf(out, "static const %s yy_reduce_ofst[] = {\n", 
-          minimum_size_type(mnNtOfst-1, mxNtOfst, &sz)); lineno++;
-  lemp->tablesize += n*sz;
-  for(i=j=0; i<n; i++){
-    int ofst;
-    stp = lemp->sorted[i];
-    ofst = stp->iNtOfst;
-    if( ofst==NO_OFFSET ) ofst = mnNtOfst - 1;
-    if( j==0 ) fprintf(out," /* %5d */ ", i);
-    fprintf(out, " %4d,", ofst);
-    if( j==9 || i==n-1 ){
-      fprintf(out, "\n"); lineno++;
-      j = 0;
+  /* Write the tables for the shared engine to load at run-time */
+  if( lemp->tablefile ){
+    char *zOut = lemp->outname;
+    lemp->outname = 0;
+    write_table_file(lemp, pActtab, mnTknOfst, mnNtOfst);
+    free(lemp->outname);
+    lemp->outname = zOut;
+  }
+
+  /* Now output the action table and its associates, or the code that
+  ** takes their place */
+  if( lemp->directcode ){
+    fprintf(out, "#define YYDIRECTCODED 1\n"); lineno++;
+    if( lemp->nsplit ){
+      fprintf(out, "#define yy_dc_shift %s_yy_dc_shift\n", name); lineno++;
+      fprintf(out, "#define yy_dc_goto %s_yy_dc_goto\n", name); lineno++;
+      fprintf(out, "unsigned int yy_dc_shift(int, int);\n"); lineno++;
+      fprintf(out, "int yy_dc_goto(int, int);\n"); lineno++;
+      print_direct_code(tbl, lemp, "", tl);
     }else{
-      j++;
+      print_direct_code(out, lemp, "static ", &lineno);
     }
+  }else{
+    print_action_tables(out, tbl, lemp, pActtab, mnTknOfst, mxTknOfst,
+                        mnNtOfst, mxNtOfst, szActionType, szCodeType,
+                        &lineno, tl);
   }
-  fprintf(out, "};\n"); lineno++;
+  tplt_xfer(lemp->name,in,out,&lineno);
 
-  /* Output the default action table */
-  fprintf(out, "static const YYACTIONTYPE yy_default[] = {\n"); lineno++;
-  n = lemp->nxstate;
-  lemp->tablesize += n*szActionType;
-  for(i=j=0; i<n; i++){
-    stp = lemp->sorted[i];
-    if( j==0 ) fprintf(out," /* %5d */ ", i);
-    fprintf(out, " %4d,", stp->iDfltReduce+lemp->nstate+lemp->nrule);
-    if( j==9 || i==n-1 ){
-      fprintf(out, "\n"); lineno++;
-      j = 0;
-    }else{
-      j++;
+  /* Finish the internal header of a split parser and start its driver */
+  if( lemp->nsplit ){
+    char *zHdr = split_makename(zMain, "_int.h");
+    print_split_declarations(out, lemp, &lineno);
+    split_close(&hdr);
+    if( !split_open(lemp, &driver, strdup(zMain)) ){
+      fclose(in);
+      fclose(tables.out);
+      free(zHdr);
+      free(zMain);
+      return;
     }
+    out = driver.out;
+    lineno = 1;
+    split_include(out, zHdr, &lineno);
+    free(zHdr);
   }
-  fprintf(out, "};\n"); lineno++;
   tplt_xfer(lemp->name,in,out,&lineno);
 
   /* Generate the table of fallback tokens.
@@ -1370,23 +2744,37 @@ void ReportTable(
 
   /* Generate a table containing the symbolic name of every symbol
   */
+  if( lemp->nsplit ){
+    fprintf(tbl,"#ifndef NDEBUG\n"); (*tl)++;
+    fprintf(tbl,"const char *const yyTokenName[] = {\n"); (*tl)++;
+  }
   for(i=0; i<lemp->nsymbol; i++){
     lemon_sprintf(line,"\"%s\",",lemp->symbols[i]->name);
-    fprintf(out,"  %-15s",line);
-    if( (i&3)==3 ){ fprintf(out,"\n"); lineno++; }
+    fprintf(tbl,"  %-15s",line);
+    if( (i&3)==3 ){ fprintf(tbl,"\n"); (*tl)++; }
+  }
+  if( (i&3)!=0 ){ fprintf(tbl,"\n"); (*tl)++; }
+  if( lemp->nsplit ){
+    fprintf(tbl,"};\n"); (*tl)++;
   }
-  if( (i&3)!=0 ){ fprintf(out,"\n"); lineno++; }
   tplt_xfer(lemp->name,in,out,&lineno);
 
   /* Generate a table containing a text string that describes every
   ** rule in the rule set of the grammar.  This information is used
   ** when tracing REDUCE actions.
   */
+  if( lemp->nsplit ){
+    fprintf(tbl,"const char *const yyRuleName[] = {\n"); (*tl)++;
+  }
   for(i=0, rp=lemp->rule; rp; rp=rp->next, i++){
     assert( rp->iRule==i );
-    fprintf(out," /* %3d */ \"", i);
-    writeRuleText(out, rp);
-    fprintf(out,"\",\n"); lineno++;
+    fprintf(tbl," /* %3d */ \"", i);
+    writeRuleText(tbl, rp);
+    fprintf(tbl,"\",\n"); (*tl)++;
+  }
+  if( lemp->nsplit ){
+    fprintf(tbl,"};\n"); (*tl)++;
+    fprintf(tbl,"#endif /* NDEBUG */\n"); (*tl)++;
   }
   tplt_xfer(lemp->name,in,out,&lineno);
 
@@ -1417,7 +2805,7 @@ void ReportTable(
     for(i=0; i<lemp->nsymbol; i++){
       struct symbol *sp = lemp->symbols[i];
       if( sp==0 || sp->type==TERMINAL ||
-          sp->index<=0 || sp->destructor!=0 ) continue;
+          sp->index<=0 || sp->destructor!=0 || sp->arena ) continue;
       if( once ){
         fprintf(out, "      /* Default NON-TERMINAL Destructor */\n"); lineno++;
         once = 0;
@@ -1433,13 +2821,14 @@ void ReportTable(
   for(i=0; i<lemp->nsymbol; i++){
     struct symbol *sp = lemp->symbols[i];
     if( sp==0 || sp->type==TERMINAL || sp->destructor==0 || sp->destructor_emitted) continue;
+    if( sp->arena ) continue;
     fprintf(out,"    case %d: /* %s */\n", sp->index, sp->name); lineno++;
     sp->destructor_emitted = 1;
 
     /* Combine duplicate destructors into a single case */
     for(j=i+1; j<lemp->nsymbol; j++){
       struct symbol *sp2 = lemp->symbols[j];
-      if( sp2 && sp2->type!=TERMINAL && sp2->destructor
+      if( sp2 && sp2->type!=TERMINAL && sp2->destructor && !sp2->arena
           && sp2->dtnum==sp->dtnum
           && strcmp(sp->destructor,sp2->destructor)==0 ){
          fprintf(out,"    case %d: /* %s */\n",
@@ -1468,55 +2857,29 @@ void ReportTable(
   }
   tplt_xfer(lemp->name,in,out,&lineno);
 
-  /* Generate code which execution during each REDUCE action */
-  i = 0;
+  /* Expand the symbols in the code of every rule */
+  nLhsMinor = 0;
   for(rp=lemp->rule; rp; rp=rp->next){
-    i += translate_code(lemp, rp);
+    nLhsMinor += translate_code(lemp, rp);
   }
-  if( i ){
-    fprintf(out,"        YYMINORTYPE yylhsminor;\n"); lineno++;
+
+
+  /* Generate code which execution during each REDUCE action */
+  if( lemp->nsplit ){
+    print_reduce_functions(tbl, lemp, nLhsMinor, zMain, tl);
+    free(lemp->outname);
+    lemp->outname = strdup(zMain);
+  }else if( lemp->dispatch==DISPATCH_FUNC ){
+    print_reduce_functions(out, lemp, nLhsMinor, 0, &lineno);
   }
-  /* First output rules other than the default: rule */
-  for(rp=lemp->rule; rp; rp=rp->next){
-    struct rule *rp2;               /* Other rules with the same action */
-    if( rp->code==0 ) continue;
-    if( rp->code[0]=='\n'
-     && rp->code[1]==0
-     && rp->codePrefix==0
-     && rp->codeSuffix==0
-    ){
-      /* No actions, so this will be part of the "default:" rule */
-      continue;
-    }
-    fprintf(out,"      case %d: /* ", rp->iRule);
-    writeRuleText(out, rp);
-    fprintf(out, " */\n"); lineno++;
-    for(rp2=rp->next; rp2; rp2=rp2->next){
-      if( rp2->code==rp->code && rp2->codePrefix==rp->codePrefix
-             && rp2->codeSuffix==rp->codeSuffix ){
-        fprintf(out,"      case %d: /* ", rp2->iRule);
-        writeRuleText(out, rp2);
-        fprintf(out," */ yytestcase(yyruleno==%d);\n", rp2->iRule); lineno++;
-        rp2->code = 0;
-      }
-    }
-    emit_code(out,rp,lemp,&lineno);
-    fprintf(out,"        break;\n"); lineno++;
-    rp->code = 0;
+  if( !lemp->runtime && !lemp->cplusplus ){
+    print_profile_ids(out, lemp, &lineno);
+    print_expected_sets(out, lemp, &lineno);
   }
-  /* Finally, output the default: rule.  We choose as the default: all
-  ** empty actions. */
-  fprintf(out,"      default:\n"); lineno++;
-  for(rp=lemp->rule; rp; rp=rp->next){
-    if( rp->code==0 ) continue;
-    assert( rp->code[0]=='\n' && rp->code[1]==0 );
-    assert( rp->codePrefix==0 );
-    assert( rp->codeSuffix==0 );
-    fprintf(out,"      /* (%d) ", rp->iRule);
-    writeRuleText(out, rp);
-    fprintf(out, " */ yytestcase(yyruleno==%d);\n", rp->iRule); lineno++;
+  tplt_xfer(lemp->name,in,out,&lineno);
+  if( lemp->dispatch!=DISPATCH_FUNC ){
+    print_reduce_cases(out, lemp, nLhsMinor, &lineno);
   }
-  fprintf(out,"        break;\n"); lineno++;
   tplt_xfer(lemp->name,in,out,&lineno);
 
   /* Generate code which executes if a parse fails */
@@ -1535,7 +2898,13 @@ void ReportTable(
   tplt_print(out,lemp,lemp->extracode,&lineno);
 
   fclose(in);
-  fclose(out);
+  if( lemp->nsplit ){
+    split_close(&tables);
+    split_close(&driver);
+    free(zMain);
+  }else{
+    fclose(out);
+  }
   return;
 }
 
@@ -1683,6 +3052,52 @@ void CompressTables(struct lemon *lemp)
 }
 
 
+/*
+** Copy fallback and wildcard actions into the action rows of each state.
+**
+** At runtime, a token that has no entry in a state is retried as its
+** fallback token and then matched against the wildcard before the
+** default action is taken.  Here that search is done once for every
+** state and token, and the action it finds is added to the state as an
+** ordinary action on the original token.  The generated parser then
+** never needs to retry a lookup.
+*/
+void FoldFallbackActions(struct lemon *lemp)
+{
+  struct state *stp;
+  struct action *ap, *apSrc, *apWild;
+  struct action **aTkn;
+  struct symbol *sp;
+  int i, j;
+
+  if( !lemp->has_fallback && lemp->wildcard==0 ) return;
+  aTkn = (struct action **) calloc(lemp->nterminal, sizeof(aTkn[0]));
+  MemoryCheck(aTkn);
+  for(i=0; i<lemp->nstate; i++){
+    stp = lemp->sorted[i];
+    if( stp->autoReduce ) continue;
+    memset(aTkn, 0, lemp->nterminal*sizeof(aTkn[0]));
+    for(ap=stp->ap; ap; ap=ap->next){
+      if( ap->sp->index>=lemp->nterminal ) continue;
+      if( compute_action(lemp, ap)<0 ) continue;
+      aTkn[ap->sp->index] = ap;
+    }
+    apWild = lemp->wildcard ? aTkn[lemp->wildcard->index] : 0;
+    for(j=1; j<lemp->nterminal; j++){
+      if( aTkn[j] ) continue;
+      sp = lemp->symbols[j];
+      apSrc = sp->fallback ? aTkn[sp->fallback->index] : 0;
+      if( apSrc==0 ) apSrc = apWild;
+      if( apSrc==0 ) continue;
+      Action_add(&stp->ap, apSrc->type, sp, 0);
+      stp->ap->x = apSrc->x;
+    }
+    stp->ap = Action_sort(stp->ap);
+  }
+  free(aTkn);
+  lemp->foldfallback = 1;
+}
+
 /*
 ** Compare two states for sorting purposes.  The smaller state is the
 ** one with the most non-terminal actions.  If they have the same number
@@ -1705,10 +3120,36 @@ static int stateResortCompare(const void *a, const void *b){
   return n;
 }
 
+/*
+** Compare two states for sorting by a layout profile.  States visited
+** more often come first.  States never pushed on the stack, states
+** without gotos and states without token actions still go at the end,
+** as the runtime expects, and ties are broken by stateResortCompare().
+*/
+static struct profile *pLayoutSort;
+static int stateLayoutCompare(const void *a, const void *b){
+  const struct state *pA = *(const struct state**)a;
+  const struct state *pB = *(const struct state**)b;
+  unsigned long nA, nB;
+  int n;
+
+  n = pA->autoReduce - pB->autoReduce;
+  if( n ) return n;
+  n = (pA->nNtAct==0) - (pB->nNtAct==0);
+  if( n ) return n;
+  n = (pA->nTknAct==0) - (pB->nTknAct==0);
+  if( n ) return n;
+  nA = Profile_state(pLayoutSort, (struct state*)pA);
+  nB = Profile_state(pLayoutSort, (struct state*)pB);
+  if( nA!=nB ) return nA<nB ? 1 : -1;
+  return stateResortCompare(a, b);
+}
+
 
 /*
 ** Renumber and resort states so that states with fewer choices
-** occur at the end.  Except, keep state 0 as the first state.
+** occur at the end.  Except, keep state 0 as the first state.  With
+** a layout profile the states visited most often come first.
 */
 void ResortStates(struct lemon *lemp)
 {
@@ -1736,8 +3177,14 @@ void ResortStates(struct lemon *lemp)
       }
     }
   }
-  qsort(&lemp->sorted[1], lemp->nstate-1, sizeof(lemp->sorted[0]),
-        stateResortCompare);
+  if( lemp->layout ){
+    pLayoutSort = lemp->layout;
+    qsort(&lemp->sorted[1], lemp->nstate-1, sizeof(lemp->sorted[0]),
+          stateLayoutCompare);
+  }else{
+    qsort(&lemp->sorted[1], lemp->nstate-1, sizeof(lemp->sorted[0]),
+          stateResortCompare);
+  }
   for(i=0; i<lemp->nstate; i++){
     lemp->sorted[i]->statenum = i;
   }
@@ -1747,3 +3194,243 @@ void ResortStates(struct lemon *lemp)
   }
 }
 
+
+/*
+** The search in FindSyncState() follows one path through the automaton
+** at a time.  The path holds the part of the parser stack that is known
+** on that path, deepest state first.
+*/
+#define SYNC_MAXDEPTH 64        /* Deepest stack a path may know about */
+#define SYNC_BUDGET   1000000   /* Steps allowed for the whole search */
+
+struct syncsearch {
+  struct lemon *lemp;
+  struct state ***aPred;     /* Predecessors of each state, 0-terminated */
+  struct symbol *la;         /* Look-ahead token of the current paths */
+  struct state *pFound;      /* Restart state found so far, or NULL */
+  int nBudget;               /* Steps left before the search gives up */
+};
+struct syncpath {
+  int n;                             /* Number of known states */
+  struct state *a[SYNC_MAXDEPTH];    /* The known states, deepest first */
+};
+
+/* Return the action that the generated parser takes in state stp on
+** symbol sp, or NULL for a syntax error.  For tokens that are not in
+** the tables, the runtime fallback, wildcard and default reduce are
+** tried in the same order as yy_find_shift_action().
+*/
+PRIVATE struct action *sync_action(
+  struct lemon *lemp,
+  struct state *stp,
+  struct symbol *sp
+){
+  struct action *ap;
+  struct action *apDflt = 0;
+  struct action *apFallback = 0;
+  struct action *apWild = 0;
+  for(ap=stp->ap; ap; ap=ap->next){
+    if( compute_action(lemp, ap)<0 ) continue;
+    if( ap->sp==sp ) return ap;
+    if( ap->sp->index>=lemp->nsymbol ) apDflt = ap;
+    if( ap->sp==sp->fallback ) apFallback = ap;
+    if( ap->sp==lemp->wildcard ) apWild = ap;
+  }
+  if( sp->index>=lemp->nterminal ) return 0;
+  if( apFallback ) return apFallback;
+  if( apWild ) return apWild;
+  return apDflt;
+}
+
+PRIVATE int sync_step(struct syncsearch*, struct syncpath*);
+
+/* The path has shifted the look-ahead token.  Check that the stack is
+** exactly state 0 with the restart state on top of it.  Return non-zero
+** if it is not.
+*/
+PRIVATE int sync_end(struct syncsearch *pS, struct syncpath *pPath){
+  struct state *stp0 = pS->lemp->sorted[0];
+  struct state *pTop;
+  struct state **pp;
+  if( pPath->n>2 ) return 1;
+  if( pPath->n==2 && pPath->a[0]!=stp0 ) return 1;
+  pTop = pPath->a[pPath->n-1];
+  if( pTop==stp0 ) return 1;
+  if( pPath->n==1 ){
+    for(pp=pS->aPred[pTop->statenum]; *pp; pp++){
+      if( *pp!=stp0 ) return 1;
+    }
+  }
+  if( pS->pFound==0 ) pS->pFound = pTop;
+  return pS->pFound!=pTop;
+}
+
+/* Reduce by rule rp, of which nPushed right-hand side symbols were
+** pushed without a state of their own (a SHIFTREDUCE).  Where the pop
+** goes below the known part of the stack, every predecessor of the
+** deepest known state is tried in turn.  Return non-zero if some path
+** fails to reach the restart state.
+*/
+PRIVATE int sync_reduce(
+  struct syncsearch *pS,
+  struct syncpath *pPath,
+  struct rule *rp,
+  int nPushed
+){
+  struct lemon *lemp = pS->lemp;
+  struct action *ap;
+  int nPop;
+
+  if( --pS->nBudget<0 ) return 1;
+  nPop = rp->nrhs - nPushed;
+  if( pPath->n<=nPop ){
+    struct syncpath sub;
+    struct state **pp;
+    if( pPath->n>=SYNC_MAXDEPTH ) return 1;
+    for(pp=pS->aPred[pPath->a[0]->statenum]; *pp; pp++){
+      sub.n = pPath->n + 1;
+      sub.a[0] = *pp;
+      memcpy(&sub.a[1], pPath->a, pPath->n*sizeof(pPath->a[0]));
+      if( sync_reduce(pS, &sub, rp, nPushed) ) return 1;
+    }
+    /* No predecessor means the pop is impossible here */
+    return 0;
+  }
+  pPath->n -= nPop;
+  ap = sync_action(lemp, pPath->a[pPath->n-1], rp->lhs);
+  if( ap==0 ) return 1;
+  if( ap->type==SHIFTREDUCE ){
+    return sync_reduce(pS, pPath, ap->x.rp, 1);
+  }
+  if( ap->type!=SHIFT || pPath->n>=SYNC_MAXDEPTH ) return 1;
+  pPath->a[pPath->n++] = ap->x.stp;
+  return sync_step(pS, pPath);
+}
+
+/* Take the action of the top of the path on the current look-ahead.
+** A syntax error is not a failure: the chunked parse reports it too,
+** though its error recovery may then differ from the sequential one.
+*/
+PRIVATE int sync_step(struct syncsearch *pS, struct syncpath *pPath){
+  struct action *ap;
+  if( --pS->nBudget<0 ) return 1;
+  ap = sync_action(pS->lemp, pPath->a[pPath->n-1], pS->la);
+  if( ap==0 ) return 0;
+  switch( ap->type ){
+    case SHIFT:
+    case SHIFTREDUCE:
+      return sync_end(pS, pPath);
+    case REDUCE:
+      return sync_reduce(pS, pPath, ap->x.rp, 0);
+    default:
+      return 0;
+  }
+}
+
+/*
+** Find the restart state of the %sync token.
+**
+** After the sync token is shifted, whatever token follows it must
+** reduce the stack to state 0 and one state S above it before that
+** token is shifted.  A parse can then be started in the middle of the
+** input, just after any sync token, from a stack that holds only state
+** 0 and S.  Here every state that shifts the sync token is followed for
+** every look-ahead token, through the same reductions the generated
+** parser makes, to prove that this holds and to find S.
+*/
+void FindSyncState(struct lemon *lemp)
+{
+  struct syncsearch s;
+  struct syncpath path;
+  struct state *stp;
+  struct action *ap, *apSync;
+  struct state **aPredSpace;
+  int *nPred;
+  int i, j, nEdge, nShift, rc;
+
+  /* Collect the predecessors of every state from the goto and shift
+  ** actions that are actually in the tables */
+  nPred = (int*)calloc(lemp->nstate, sizeof(nPred[0]));
+  MemoryCheck(nPred);
+  nEdge = 0;
+  for(i=0; i<lemp->nstate; i++){
+    for(ap=lemp->sorted[i]->ap; ap; ap=ap->next){
+      if( ap->type!=SHIFT ) continue;
+      nPred[ap->x.stp->statenum]++;
+      nEdge++;
+    }
+  }
+  s.aPred = (struct state***)calloc(lemp->nstate, sizeof(s.aPred[0]));
+  aPredSpace = (struct state**)calloc(nEdge+lemp->nstate,
+                                      sizeof(aPredSpace[0]));
+  MemoryCheck(s.aPred);
+  MemoryCheck(aPredSpace);
+  for(i=j=0; i<lemp->nstate; i++){
+    s.aPred[i] = &aPredSpace[j];
+    j += nPred[i] + 1;
+    nPred[i] = 0;
+  }
+  for(i=0; i<lemp->nstate; i++){
+    stp = lemp->sorted[i];
+    for(ap=stp->ap; ap; ap=ap->next){
+      struct state **pp;
+      if( ap->type!=SHIFT ) continue;
+      pp = s.aPred[ap->x.stp->statenum];
+      for(j=0; j<nPred[ap->x.stp->statenum] && pp[j]!=stp; j++){}
+      if( j==nPred[ap->x.stp->statenum] ){
+        pp[j] = stp;
+        nPred[ap->x.stp->statenum]++;
+      }
+    }
+  }
+
+  s.lemp = lemp;
+  s.pFound = 0;
+  s.nBudget = SYNC_BUDGET;
+  rc = 0;
+  nShift = 0;
+  for(i=0; i<lemp->nstate && rc==0; i++){
+    stp = lemp->sorted[i];
+    if( stp->autoReduce && stp->pDfltReduce ) continue;
+    apSync = sync_action(lemp, stp, lemp->syncsym);
+    if( apSync==0 ) continue;
+    if( apSync->type!=SHIFT && apSync->type!=SHIFTREDUCE ) continue;
+    nShift++;
+    for(j=1; j<lemp->nterminal && rc==0; j++){
+      s.la = lemp->symbols[j];
+      path.a[0] = stp;
+      if( apSync->type==SHIFT ){
+        path.a[1] = apSync->x.stp;
+        path.n = 2;
+        rc = sync_step(&s, &path);
+      }else{
+        path.n = 1;
+        rc = sync_reduce(&s, &path, apSync->x.rp, 1);
+      }
+    }
+  }
+  free(nPred);
+  free(s.aPred);
+  free(aPredSpace);
+
+  if( nShift==0 ){
+    ErrorMsg(lemp->filename, 0,
+      "The %%sync token %s is never shifted.", lemp->syncsym->name);
+    lemp->errorcnt++;
+    return;
+  }
+  if( rc || s.pFound==0 ){
+    ErrorMsg(lemp->filename, 0,
+      "The %%sync token %s does not always return the parser to a "
+      "single top-level state%s.", lemp->syncsym->name,
+      s.nBudget<0 ? " (the search was too long)" : "");
+    lemp->errorcnt++;
+    return;
+  }
+  for(ap=lemp->sorted[0]->ap; ap; ap=ap->next){
+    if( ap->type==SHIFT && ap->x.stp==s.pFound ) break;
+  }
+  assert( ap!=0 );
+  lemp->syncstate = s.pFound;
+  lemp->syncmajor = ap->sp;
+}
@@ -6,6 +6,8 @@ void ReportOutput(struct lemon *);
 void ReportTable(struct lemon *, int);
 void ReportHeader(struct lemon *);
 void CompressTables(struct lemon *);
+void FoldFallbackActions(struct lemon *);
 void ResortStates(struct lemon *);
+void FindSyncState(struct lemon *);
 
 #endif // _REPORT_H_
@@ -30,6 +30,9 @@ struct symbol {
   enum e_assoc assoc;      /* Associativity if precedence is defined */
   char *firstset;          /* First-set for all rules of this symbol */
   Boolean lambda;          /* True if NT and can generate an empty string */
+  Boolean inlined;         /* True if declared with %inline */
+  Boolean hooked;          /* True if declared with %hook */
+  Boolean arena;           /* True if declared with %arena */
   int useCnt;              /* Number of times used */
   char *destructor;        /* Code which executes whenever this symbol is
                            ** popped from the stack during error processing */
@@ -63,6 +66,7 @@ struct rule {
   int index;               /* An index number for this rule */
   int iRule;               /* Rule number as used in the generated tables */
   Boolean canReduce;       /* True if this rule is ever reduced */
+  Boolean bypassed;        /* True if some goto skips this unit rule */
   struct rule *nextlhs;    /* Next rule with the same LHS */
   struct rule *next;       /* Next rule in the global list */
 };
@@ -88,6 +92,12 @@ struct config {
   struct config *bp;       /* The next basis configuration */
 };
 
+enum e_dispatch {
+  DISPATCH_SWITCH,         /* A switch on the rule number */
+  DISPATCH_FUNC,           /* A table of one function per action */
+  DISPATCH_GOTO            /* Labels reached by a computed goto */
+};
+
 enum e_action {
   SHIFT,
   ACCEPT,
@@ -120,12 +130,14 @@ struct state {
   struct config *bp;       /* The basis configurations for this state */
   struct config *cfp;      /* All configurations in this set */
   int statenum;            /* Sequential number for this state */
+  int origstatenum;        /* statenum before ResortStates() */
   struct action *ap;       /* Array of actions for this state */
   int nTknAct, nNtAct;     /* Number of actions on terminals and nonterminals */
   int iTknOfst, iNtOfst;   /* yy_action[] offset for terminals and nonterms */
   int iDfltReduce;         /* Default action is to REDUCE by this rule */
   struct rule *pDfltReduce;/* The default REDUCE rule. */
   int autoReduce;          /* True if this is an auto-reduce state */
+  char *expect;            /* Terminals that are not a syntax error here */
 };
 #define NO_OFFSET (-2147483647)
 
@@ -172,11 +184,31 @@ struct lemon {
   char *outname;           /* Name of the current output file, may be .c .h or .out */
   char *tokenprefix;       /* A prefix added to token names in the .h file */
   int nconflict;           /* Number of parsing conflicts */
+  int nbypass;             /* Number of unit rules bypassed */
+  int foldfallback;        /* True if fallback actions are in the tables */
+  int directcode;          /* True to emit the automaton as code */
+  enum e_dispatch dispatch; /* How yy_reduce() reaches the rule actions */
+  int nsplit;              /* Action shards of a split parser, or 0 */
+  int runtime;             /* True to generate for the shared engine */
+  int tablefile;           /* True to write the tables to a .ltab file */
+  int recognizer;          /* True to generate a recognizer (no values) */
+  int tokenhandle;         /* True to keep token handles on the stack */
+  int arena;               /* True if the parser has an arena (%arena) */
+  struct symbol *syncsym;  /* Token declared by %sync, or NULL */
+  struct state *syncstate; /* State the stack is reduced to after syncsym */
+  struct symbol *syncmajor; /* Symbol that leads from state 0 to syncstate */
+  struct profile *profile; /* Runtime profile for the report, or NULL */
+  struct profile *layout;  /* Runtime profile that orders the tables, or NULL */
+  int cplusplus;           /* True to generate a C++17 parser (lempar.cpp) */
   int nactiontab;          /* Number of entries in the yy_action[] table */
   int tablesize;           /* Total table size of all tables in bytes */
+  int tablelines;          /* Cache lines spanned by the lookup tables */
+  int hotlines90;          /* Lines serving 90% of the profiled lookups */
+  int hotlines99;          /* Lines serving 99% of the profiled lookups */
   int basisflag;           /* Print only basis configurations */
   int has_fallback;        /* True if any %fallback is seen in the grammar */
   int nolinenosflag;       /* True if #line statements should not be printed */
+  int splitstack;          /* True to keep minor values in a separate stack */
   char *argv0;             /* Name of the program */
 };
 
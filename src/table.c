@@ -174,6 +174,9 @@ struct symbol *Symbol_new(const char *x)
     sp->assoc = UNK;
     sp->firstset = 0;
     sp->lambda = LEMON_FALSE;
+    sp->inlined = LEMON_FALSE;
+    sp->hooked = LEMON_FALSE;
+    sp->arena = LEMON_FALSE;
     sp->destructor = 0;
     sp->destructor_emitted = 0;
     sp->destLineno = 0;
@@ -46,6 +46,36 @@
 **                       values which should be used if the original symbol
 **                       would not parse.  This permits keywords to sometimes
 **                       be used as identifiers, for example.
+**    YYLAZYREDUCE       If defined, a state that can only reduce waits for
+**                       the next token before reducing.  By default such
+**                       states reduce as soon as the token that enters them
+**                       is shifted, so the action that completes a
+**                       statement is not held back until more input arrives.
+**    YYDIRECTCODED      If defined, the automaton is compiled into the
+**                       functions yy_dc_shift() and yy_dc_goto() and the
+**                       yy_action[] tables below are not generated.
+**    YYSPLIT            If defined, the parser is split into several files
+**                       by lemon's -split option.  Everything up to the
+**                       stack definitions is an internal header shared by
+**                       the driver, the tables file and the files that
+**                       hold the reduce action functions.
+**    YYRECOGNIZER       If defined, the parser is a recognizer built by
+**                       lemon's -R option.  There are no semantic values:
+**                       the stack holds only state and major numbers,
+**                       Parse() takes no minor token and there are no
+**                       destructors.  Only the code of %hook rules runs.
+**    YYTOKENHANDLE      If defined (lemon's -t option), the stack holds
+**                       an unsigned int handle for each token, its index
+**                       in the caller's array of tokens, in place of the
+**                       ParseTOKENTYPE value.  Parse() takes the handle
+**                       and the actions reach the token in the array
+**                       through yyTokenValue().
+**    YYARENA            If defined (the %arena directive), each parser has
+**                       an arena that the actions allocate from with
+**                       ParseArenaAlloc().  It is rewound all at once.
+**    YYNOFALLBACKRETRY  If defined, the actions of fall-back tokens and of the
+**                       wildcard are already stored in the action tables, so
+**                       a token that does not parse is never looked up again.
 **    YYACTIONTYPE       is the data type used for "action codes" - numbers
 **                       that indicate what to do in response to the next
 **                       token.
@@ -64,14 +94,20 @@
 **                       for terminal symbols is called "yy0".
 **    YYSTACKDEPTH       is the maximum depth of the parser's stack.  If
 **                       zero the stack is dynamically sized using realloc()
+**    YYNRHSMAX          is the largest number of RHS symbols in any rule.
 **    ParseARG_SDECL     A static variable declaration for the %extra_argument
 **    ParseARG_PDECL     A parameter declaration for the %extra_argument
+**    ParseARG_PARAM     Code to pass %extra_argument as a subroutine parameter
 **    ParseARG_STORE     Code to store %extra_argument into yypParser
 **    ParseARG_FETCH     Code to extract %extra_argument from yypParser
 **    YYERRORSYMBOL      is the code number of the error symbol.  If not
 **                       defined, then do no error processing.
 **    YYNSTATE           the combined number of states.
 **    YYNRULE            the number of rules in the grammar
+**    YYNTOKEN           the number of terminals, counting $
+**    YYFINGERPRINT      a hash of the symbols and rules of the grammar
+**    YYTABLEPRINT       a hash of YYFINGERPRINT and of every action of
+**                       every state, as the states are numbered here
 **    YY_MAX_SHIFT       Maximum value for shift actions
 **    YY_MIN_SHIFTREDUCE Minimum value for shift-reduce actions
 **    YY_MAX_SHIFTREDUCE Maximum value for shift-reduce actions
@@ -79,6 +115,88 @@
 **    YY_ERROR_ACTION    The yy_action[] code for syntax error
 **    YY_ACCEPT_ACTION   The yy_action[] code for accept
 **    YY_NO_ACTION       The yy_action[] code for no-op
+**
+** The following may be defined in the %include section of the grammar
+** (or on the compiler command line) to tune the arena:
+**
+**    YYARENACHUNK       Bytes in each block of the arena.
+**
+** The following may be defined in the %include section of the grammar
+** (or on the compiler command line) to select the segmented stack:
+**
+**    YYSTACKSEGMENTED   If defined, YYSTACKDEPTH is ignored.  The stack
+**                       begins in a small buffer inside the parser object
+**                       and spills into a linked list of fixed-size
+**                       segments obtained from the allocator passed to
+**                       ParseAlloc().  Growth never copies the stack and
+**                       there is no depth limit.
+**    YYSTACKINLINE      Entries in the inline buffer.
+**    YYSTACKSEGSIZE     Entries in each heap segment.
+**
+** The following may be defined in the %include section of the grammar
+** to copy the semantic values taken by ParseSnapshot(), ParseRestore()
+** and ParseFork():
+**
+**    YYSNAPSHOTCOPY(P,X,D,S)  Make *D, the value of a symbol X in parser
+**                       P, a copy of *S.  The default is a plain
+**                       assignment.  Values that have a destructor must
+**                       be duplicated or retained here, because every
+**                       copy is destroyed on its own.  If the grammar
+**                       has destructors there is no default, and these
+**                       functions are left out unless it is defined.
+**
+**    YYSNAPSHOTSAME(P,X,A,B)  True if *A and *B, values of a symbol X in
+**                       parser P, are equal.  With YYCHECKPOINT a parser
+**                       is only found in the same state as a checkpoint
+**                       if this holds for every value on its stack.  The
+**                       default is true: only states are compared, and
+**                       checkpoints after the one ParseSynced() reports
+**                       keep the values from before the edit.
+**
+** With YYSTACKSEGMENTED a snapshot copies only the bottom and the top of
+** the stack, and shares the heap segments in between with the parser.
+** A parser copies a shared segment before it pops into it.
+**
+** The following may be defined in the %include section of the grammar
+** (or on the compiler command line) for incremental reparsing:
+**
+**    YYCHECKPOINT       If defined, ParseCheckpoints() makes the parser
+**                       keep snapshots of itself keyed by token offset,
+**                       and ParseResume() restarts it from the one before
+**                       an edit of the input.  Cannot be used with %arena.
+**
+** The following may be defined in the %include section of the grammar
+** (or on the compiler command line) to run the parser on its own thread:
+**
+**    YYPIPELINE         If defined, ParsePipelineStart() starts a thread
+**                       that passes to Parse() the tokens the caller
+**                       hands over with ParsePipelinePush().  Needs C11
+**                       atomics and POSIX threads.
+**    YYPIPELINESIZE     Tokens in the ring between the two threads.  A
+**                       power of two.
+**    YYPIPELINESPIN     Times the parser thread yields while waiting for
+**                       a token, before it sleeps until one is pushed.
+**
+** The following may be defined in the %include section of the grammar
+** (or on the compiler command line) to profile the parser:
+**
+**    YYPROFILE          If defined, each parser counts the tokens shifted
+**                       in every state, the gotos and reductions, the
+**                       fallback and wildcard matches, error recovery and
+**                       the depth of its stack.  ParseProfile() appends the
+**                       counts to a file that "lemon -M" merges into the
+**                       report of the grammar.
+**
+** The following may be defined in the %include section of the grammar
+** (or on the compiler command line) for syntax error diagnostics:
+**
+**    YYEXPECTED         If defined, lemon's sets of the terminals that
+**                       each state expects are compiled in.
+**                       ParseExpectedTokens() lists the terminals that
+**                       may follow the input seen so far, and during
+**                       error recovery a token that the state on top of
+**                       the stack does not expect is discarded with one
+**                       bit test, before any default reduction runs.
 */
 #ifndef INTERFACE
 # define INTERFACE 1
@@ -99,6 +217,21 @@
 # define yytestcase(X)
 #endif
 
+/* The declaration of the minor token parameter of Parse() and of the
+** functions it passes the token to, and the argument for it.  Both are
+** empty in a recognizer.
+*/
+#ifdef YYRECOGNIZER
+# define YYMINOR_PDECL
+# define YYMINOR_PARAM
+#elif defined(YYTOKENHANDLE)
+# define YYMINOR_PDECL ,unsigned int yyminor
+# define YYMINOR_PARAM ,yyminor
+#else
+# define YYMINOR_PDECL ,ParseTOKENTYPE yyminor
+# define YYMINOR_PARAM ,yyminor
+#endif
+
 
 /* Next are the tables used to determine what action to take based on the
 ** current state and lookahead token.  These tables are used to implement
@@ -155,26 +288,6 @@
 %%
 /********** End of lemon-generated parsing tables *****************************/
 
-/* The next table maps tokens (terminal symbols) into fallback tokens.  
-** If a construct like the following:
-** 
-**      %fallback ID X Y Z.
-**
-** appears in the grammar, then ID becomes a fallback token for X, Y,
-** and Z.  Whenever one of the tokens X, Y, or Z is input to the parser
-** but it does not parse, the type of the token is changed to ID and
-** the parse is retried before an error is thrown.
-**
-** This feature can be used, for example, to cause some keywords in a language
-** to revert to identifiers if they keyword does not apply in the context where
-** it appears.
-*/
-#ifdef YYFALLBACK
-static const YYCODETYPE yyFallback[] = {
-%%
-};
-#endif /* YYFALLBACK */
-
 /* The following structure represents a single element of the
 ** parser's stack.  Information stored includes:
 **
@@ -190,16 +303,164 @@ static const YYCODETYPE yyFallback[] = {
 ** After the "shift" half of a SHIFTREDUCE action, the stateno field
 ** actually contains the reduce action for the second half of the
 ** SHIFTREDUCE.
+**
+** If YYSPLITSTACK is defined (lemon's -S option) the semantic values are
+** kept in a separate array, yyvstack[], parallel to the array of state
+** and major numbers.  The table lookups then only touch the small
+** entries, however large YYMINORTYPE may be.  The reduce actions address
+** the semantic values through "yymvp" instead of "yymsp".
 */
 struct yyStackEntry {
   YYACTIONTYPE stateno;  /* The state-number, or reduce action in SHIFTREDUCE */
   YYCODETYPE major;      /* The major token value.  This is the code
                          ** number for the token at this stack level */
+#if !defined(YYSPLITSTACK) && !defined(YYRECOGNIZER)
   YYMINORTYPE minor;     /* The user-supplied minor token value.  This
                          ** is the value of the token  */
+#endif
 };
 typedef struct yyStackEntry yyStackEntry;
 
+/* Datatype of the argument to the memory allocated passed as the
+** second argument to ParseAlloc() below.  This can be changed by
+** putting an appropriate #define in the %include section of the input
+** grammar.
+*/
+#ifndef YYMALLOCARGTYPE
+# define YYMALLOCARGTYPE size_t
+#endif
+
+/* A plain assignment copies the values of a snapshot only if no value
+** has a destructor.  Otherwise the snapshot functions need the grammar
+** to define YYSNAPSHOTCOPY, and are left out if it does not.
+*/
+#if !defined(YYSNAPSHOTCOPY) && !defined(YYHASDESTRUCTOR)
+# define YYSNAPSHOTCOPY(P,X,D,S) (*(D) = *(S))
+#endif
+#if defined(YYCHECKPOINT) && !defined(YYSNAPSHOTCOPY)
+# error "YYCHECKPOINT needs YYSNAPSHOTCOPY in a grammar with destructors"
+#endif
+#if defined(YYCHECKPOINT) && !defined(YYSNAPSHOTSAME)
+# define YYSNAPSHOTSAME(P,X,A,B) 1
+#endif
+
+#ifdef YYSTACKSEGMENTED
+/* A segmented stack is a chain of fixed-size blocks of entries.  The
+** bottom block is the yystk0[] array inside the parser object.  When the
+** topmost block fills up, a new block is started and the YYNRHSMAX
+** entries at the top of the old block are moved into it.  In this way
+** the right-hand side of every rule, plus the entry beneath it, is always
+** contiguous in the topmost block and the reduce code can address it
+** through a plain yymsp[] pointer.  When a reduce or a pop reaches below
+** the bottom of the topmost block, its few remaining entries are moved
+** back down into the space they were originally taken from.  Each move
+** is bounded by YYNRHSMAX entries, no matter how deep the stack is.
+**
+** Every segment below the topmost one is full, up to the base of the
+** segment above it: YYSEGLIVE entries.  Such segments may be shared with
+** snapshots and with forked parsers, and nRef counts the segments and
+** snapshots that point to one.  A shared segment is never written.
+*/
+#ifndef YYSTACKINLINE
+# if YYNRHSMAX*2+2>32
+#  define YYSTACKINLINE (YYNRHSMAX*2+2)
+# else
+#  define YYSTACKINLINE 32
+# endif
+#endif
+#ifndef YYSTACKSEGSIZE
+# if YYNRHSMAX*2+2>256
+#  define YYSTACKSEGSIZE (YYNRHSMAX*2+2)
+# else
+#  define YYSTACKSEGSIZE 256
+# endif
+#endif
+#if YYSTACKINLINE<YYNRHSMAX*2+2 || YYSTACKSEGSIZE<YYNRHSMAX*2+2
+# error "YYSTACKINLINE and YYSTACKSEGSIZE must be at least 2*YYNRHSMAX+2"
+#endif
+#define YYSEGLIVE (YYSTACKSEGSIZE-YYNRHSMAX)  /* Entries of a lower segment */
+typedef struct yyStackSegment yyStackSegment;
+struct yyStackSegment {
+  yyStackSegment *pPrev;        /* Next lower segment.  NULL if yystk0[] */
+  int iBase;                    /* Stack index of aEntry[0] */
+  int nRef;                     /* Pointers to this segment */
+  yyStackEntry aEntry[YYSTACKSEGSIZE];  /* Entries of this segment */
+#ifdef YYSPLITSTACK
+  YYMINORTYPE aMinor[YYSTACKSEGSIZE];   /* Minor values of this segment */
+#endif
+};
+#if defined(YYRECOGNIZER)
+# define yySegMinor(S,I) ((YYMINORTYPE*)0)
+#elif defined(YYSPLITSTACK)
+# define yySegMinor(S,I) (&(S)->aMinor[I])
+#else
+# define yySegMinor(S,I) (&(S)->aEntry[I].minor)
+#endif
+#endif /* YYSTACKSEGMENTED */
+
+#ifdef YYARENA
+/* The arena is a chain of blocks that ParseArenaAlloc() carves memory
+** out of, in order.  Rewinding the arena makes all of its memory free
+** again at once, and keeps the blocks for the next parse.  The values of
+** the nonterminals named by %arena are taken to live in the arena, so
+** their destructors are never called.
+*/
+#ifndef YYARENACHUNK
+# define YYARENACHUNK 16384
+#endif
+typedef union {                 /* The alignment of arena allocations */
+  double r;
+  void *p;
+  long long i;
+} yyArenaAlign;
+typedef struct yyArenaChunk yyArenaChunk;
+struct yyArenaChunk {
+  yyArenaChunk *pNext;          /* Next block of the arena */
+  size_t nByte;                 /* Bytes available in aSpace[] */
+  yyArenaAlign aSpace[1];       /* The memory of this block */
+};
+#endif /* YYARENA */
+
+#ifdef YYCHECKPOINT
+#ifdef YYARENA
+# error "YYCHECKPOINT cannot be used with %arena"
+#endif
+/* A checkpoint is a snapshot of the parser taken before the token at
+** offset iToken of the input was passed to Parse().  The checkpoints of
+** a parser are kept in order of iToken.
+*/
+typedef struct yyCheckpoint yyCheckpoint;
+struct yyCheckpoint {
+  int iToken;                   /* Offset of the next token */
+  struct yySnapshot *pSnap;     /* The state of the parser */
+};
+#endif /* YYCHECKPOINT */
+
+#ifdef YYPROFILE
+/* The counters of a profiled parser.  aDepth[i] counts the parses whose
+** deepest stack had between 2**i and 2**(i+1)-1 entries above state 0. */
+#define YYPROFILEDEPTHS 32
+typedef struct yyProfile yyProfile;
+struct yyProfile {
+  unsigned long aShift[YYNSTATE];   /* Tokens shifted in each state */
+  unsigned long aGoto[YYNSTATE];    /* Gotos out of each state */
+  unsigned long aReduce[YYNRULE];   /* Reductions by each rule */
+  unsigned long aFallback[YYNOCODE];  /* Tokens retried as their fallback */
+  unsigned long aWildcard[YYNOCODE];  /* Tokens matched by the wildcard */
+  unsigned long nAccept;            /* Parses accepted */
+  unsigned long nFail;              /* Parses failed */
+  unsigned long nOverflow;          /* Stack overflows */
+  unsigned long nError;             /* Syntax errors reported */
+  unsigned long nErrorShift;        /* Shifts of the error symbol */
+  unsigned long nDiscard;           /* Tokens discarded by error recovery */
+  unsigned long aDepth[YYPROFILEDEPTHS];  /* Parses by deepest stack */
+  int iDepth;                       /* Deepest stack of the current parse */
+};
+# define yyProfileAdd(P,X)  ((P)->yyprof.X++)
+#else
+# define yyProfileAdd(P,X)
+#endif
+
 /* The state of the parser is completely contained in an instance of
 ** the following structure */
 struct yyParser {
@@ -209,16 +470,113 @@ struct yyParser {
 #endif
 #ifndef YYNOERRORRECOVERY
   int yyerrcnt;                 /* Shifts left before out of the error */
+#endif
+#ifdef YYPROFILE
+  yyProfile yyprof;             /* The counters of the profile */
 #endif
   ParseARG_SDECL                /* A place to hold %extra_argument */
-#if YYSTACKDEPTH<=0
+#ifdef YYTOKENHANDLE
+  ParseTOKENTYPE *yytokens;     /* The caller's tokens, indexed by handle */
+#endif
+#ifdef YYARENA
+  yyArenaChunk *yyarena;        /* First block of the arena, or NULL */
+  yyArenaChunk *yyarenaCur;     /* Block the next allocation comes from */
+  size_t yyarenaUsed;           /* Bytes used in yyarenaCur */
+  void *(*yyarenaMalloc)(YYMALLOCARGTYPE);  /* Allocator for new blocks */
+#endif
+#ifdef YYCHECKPOINT
+  int yytokenno;                /* Offset of the next token */
+  int yyckEvery;                /* Tokens between checkpoints.  0 if none */
+  int yyckWant;                 /* Take a checkpoint before the next token */
+  int yyckNextToken;            /* Offset of the next stored checkpoint */
+  int yyresync;                 /* True while comparing with old checkpoints */
+  int yysynced;                 /* Offset where the states matched, or -1 */
+  int nCk;                      /* Number of checkpoints */
+  int nCkAlloc;                 /* Slots allocated in aCk[] */
+  yyCheckpoint *aCk;            /* The checkpoints, in order of iToken */
+  size_t yyckBytes;             /* Bytes used by the snapshots of aCk[] */
+  size_t yyckBudget;            /* Bytes the snapshots may use */
+  void *(*yyckMalloc)(YYMALLOCARGTYPE);  /* Allocator of the checkpoints */
+  void (*yyckFree)(void*);      /* And its release function */
+#endif
+#if defined(YYSTACKSEGMENTED)
+  int yystkbase;                /* Stack index of yystack[0] */
+  int yystkend;                 /* Stack index one past the end of yystack */
+  yyStackEntry *yystack;        /* Entries of the topmost segment */
+  yyStackSegment *yyseg;        /* Topmost heap segment.  NULL if yystk0[] */
+  yyStackSegment *yysegFree;    /* Released segments kept for reuse */
+  void *(*yymalloc)(YYMALLOCARGTYPE);  /* Allocator for new segments */
+  yyStackEntry yystk0[YYSTACKINLINE];  /* Bottom of the stack */
+#ifdef YYSPLITSTACK
+  YYMINORTYPE *yyvstack;        /* Minor values of the topmost segment */
+  YYMINORTYPE yyvstk0[YYSTACKINLINE];  /* Minor values for yystk0[] */
+#endif
+#elif YYSTACKDEPTH<=0
   int yystksz;                  /* Current side of the stack */
   yyStackEntry *yystack;        /* The parser's stack */
+#ifdef YYSPLITSTACK
+  YYMINORTYPE *yyvstack;        /* Minor values parallel to yystack[] */
+#endif
 #else
   yyStackEntry yystack[YYSTACKDEPTH];  /* The parser's stack */
+#ifdef YYSPLITSTACK
+  YYMINORTYPE yyvstack[YYSTACKDEPTH];  /* Minor values parallel to yystack[] */
+#endif
 #endif
 };
 typedef struct yyParser yyParser;
+#ifdef YYARENA
+void *ParseArenaAlloc(void*, size_t);
+#endif
+
+/* Return a pointer to the entry on top of the parser's stack, and to
+** the minor value of that entry */
+#ifdef YYSTACKSEGMENTED
+# define yyStackTop(P) (&(P)->yystack[(P)->yyidx-(P)->yystkbase])
+# define yyMinorTop(P) (&(P)->yyvstack[(P)->yyidx-(P)->yystkbase])
+#else
+# define yyStackTop(P) (&(P)->yystack[(P)->yyidx])
+# define yyMinorTop(P) (&(P)->yyvstack[(P)->yyidx])
+#endif
+#if !defined(YYSPLITSTACK) && !defined(YYRECOGNIZER)
+# undef yyMinorTop
+# define yyMinorTop(P) (&yyStackTop(P)->minor)
+#endif
+
+/* The token of handle H, with YYTOKENHANDLE */
+#define yyTokenValue(P,H) ((P)->yytokens[H])
+
+/* Functions that the reduce action functions of a split parser call
+** from their own files have external linkage in a split parser.
+*/
+#ifdef YYSPLIT
+# define YYSHARED
+#else
+# define YYSHARED static
+#endif
+/************* Begin split parser declarations ********************************/
+%%
+/************* End split parser declarations **********************************/
+
+/* The next table maps tokens (terminal symbols) into fallback tokens.  
+** If a construct like the following:
+** 
+**      %fallback ID X Y Z.
+**
+** appears in the grammar, then ID becomes a fallback token for X, Y,
+** and Z.  Whenever one of the tokens X, Y, or Z is input to the parser
+** but it does not parse, the type of the token is changed to ID and
+** the parse is retried before an error is thrown.
+**
+** This feature can be used, for example, to cause some keywords in a language
+** to revert to identifiers if they keyword does not apply in the context where
+** it appears.
+*/
+#if defined(YYFALLBACK) && !defined(YYNOFALLBACKRETRY)
+static const YYCODETYPE yyFallback[] = {
+%%
+};
+#endif /* YYFALLBACK */
 
 #ifndef NDEBUG
 #include <stdio.h>
@@ -252,15 +610,16 @@ void ParseTrace(FILE *TraceFILE, char *zTracePrompt){
 }
 #endif /* NDEBUG */
 
-#ifndef NDEBUG
+#if !defined(NDEBUG) && !defined(YYSPLIT)
 /* For tracing shifts, the names of all terminals and nonterminals
-** are required.  The following table supplies these names */
+** are required.  The following table supplies these names.  A split
+** parser keeps this table and the next in its tables file. */
 static const char *const yyTokenName[] = { 
 %%
 };
 #endif /* NDEBUG */
 
-#ifndef NDEBUG
+#if !defined(NDEBUG) && !defined(YYSPLIT)
 /* For tracing reduce actions, the names of all rules are required.
 */
 static const char *const yyRuleName[] = {
@@ -269,7 +628,130 @@ static const char *const yyRuleName[] = {
 #endif /* NDEBUG */
 
 
-#if YYSTACKDEPTH<=0
+#if defined(YYSTACKSEGMENTED)
+/*
+** Start a new segment on top of a full segmented stack.  The YYNRHSMAX
+** topmost entries move into the new segment.  Return non-zero if no
+** memory is available for the new segment.
+*/
+static int yySpillStack(yyParser *p){
+  yyStackSegment *pNew;
+  int i;
+
+  assert( p->yyidx==p->yystkend );
+  pNew = p->yysegFree;
+  if( pNew ){
+    p->yysegFree = pNew->pPrev;
+  }else{
+    pNew = (yyStackSegment*)(*p->yymalloc)(
+                                 (YYMALLOCARGTYPE)sizeof(yyStackSegment) );
+    if( pNew==0 ) return 1;
+  }
+  pNew->pPrev = p->yyseg;
+  pNew->iBase = p->yystkend - YYNRHSMAX;
+  pNew->nRef = 1;
+  for(i=0; i<YYNRHSMAX; i++){
+    pNew->aEntry[i] = p->yystack[pNew->iBase + i - p->yystkbase];
+#ifdef YYSPLITSTACK
+    pNew->aMinor[i] = p->yyvstack[pNew->iBase + i - p->yystkbase];
+#endif
+  }
+  p->yyseg = pNew;
+  p->yystack = pNew->aEntry;
+#ifdef YYSPLITSTACK
+  p->yyvstack = pNew->aMinor;
+#endif
+  p->yystkbase = pNew->iBase;
+  p->yystkend = pNew->iBase + YYSTACKSEGSIZE;
+#ifndef NDEBUG
+  if( yyTraceFILE ){
+    fprintf(yyTraceFILE,"%sStack spills into a new segment at depth %d!\n",
+            yyTracePrompt, p->yyidx);
+  }
+#endif
+  return 0;
+}
+
+#ifdef YYSNAPSHOTCOPY
+/*
+** The topmost segment of a stack holds n entries, and the segment below
+** it is shared.  Instead of moving down into that segment, turn the
+** topmost one into a copy of it: the n entries move up to where they
+** belong in the copy and the values of the shared segment are copied
+** with YYSNAPSHOTCOPY beneath them.
+*/
+static void yyUnshareStack(yyParser *p, int n){
+  yyStackSegment *pSeg = p->yyseg;
+  yyStackSegment *pShared = pSeg->pPrev;
+  int i;
+
+  for(i=0; i<n; i++){
+    pSeg->aEntry[YYSEGLIVE+i] = pSeg->aEntry[i];
+#ifdef YYSPLITSTACK
+    pSeg->aMinor[YYSEGLIVE+i] = pSeg->aMinor[i];
+#endif
+  }
+  for(i=0; i<YYSEGLIVE; i++){
+    pSeg->aEntry[i].stateno = pShared->aEntry[i].stateno;
+    pSeg->aEntry[i].major = pShared->aEntry[i].major;
+#ifndef YYRECOGNIZER
+    YYSNAPSHOTCOPY(p, pShared->aEntry[i].major, yySegMinor(pSeg,i),
+                   yySegMinor(pShared,i));
+#endif
+  }
+  pSeg->iBase = pShared->iBase;
+  pSeg->pPrev = pShared->pPrev;
+  if( pSeg->pPrev ) pSeg->pPrev->nRef++;
+  pShared->nRef--;
+  p->yystkbase = pSeg->iBase;
+  p->yystkend = pSeg->iBase + YYSTACKSEGSIZE;
+}
+#endif /* YYSNAPSHOTCOPY */
+
+/*
+** Release the topmost segment of a segmented stack and move the entries
+** it still holds, at most YYNRHSMAX of them, back into the segment
+** below.  The released segment is kept for reuse by yySpillStack().
+*/
+static void yyJoinStack(yyParser *p){
+  yyStackSegment *pOld = p->yyseg;
+  int n = p->yyidx + 1 - p->yystkbase;   /* Entries left in pOld */
+  int i;
+
+  assert( pOld!=0 );
+  assert( n>=0 && n<=YYNRHSMAX );
+#ifdef YYSNAPSHOTCOPY
+  if( pOld->pPrev && pOld->pPrev->nRef>1 ){
+    yyUnshareStack(p, n);
+    return;
+  }
+#endif
+  p->yyseg = pOld->pPrev;
+  if( p->yyseg ){
+    p->yystack = p->yyseg->aEntry;
+#ifdef YYSPLITSTACK
+    p->yyvstack = p->yyseg->aMinor;
+#endif
+    p->yystkbase = p->yyseg->iBase;
+    p->yystkend = p->yystkbase + YYSTACKSEGSIZE;
+  }else{
+    p->yystack = p->yystk0;
+#ifdef YYSPLITSTACK
+    p->yyvstack = p->yyvstk0;
+#endif
+    p->yystkbase = 0;
+    p->yystkend = YYSTACKINLINE;
+  }
+  for(i=0; i<n; i++){
+    p->yystack[pOld->iBase + i - p->yystkbase] = pOld->aEntry[i];
+#ifdef YYSPLITSTACK
+    p->yyvstack[pOld->iBase + i - p->yystkbase] = pOld->aMinor[i];
+#endif
+  }
+  pOld->pPrev = p->yysegFree;
+  p->yysegFree = pOld;
+}
+#elif YYSTACKDEPTH<=0
 /*
 ** Try to increase the size of the parser stack.
 */
@@ -281,6 +763,14 @@ static void yyGrowStack(yyParser *p){
   pNew = realloc(p->yystack, newSize*sizeof(pNew[0]));
   if( pNew ){
     p->yystack = pNew;
+#ifdef YYSPLITSTACK
+    {
+      YYMINORTYPE *pNewMinor;
+      pNewMinor = realloc(p->yyvstack, newSize*sizeof(pNewMinor[0]));
+      if( pNewMinor==0 ) return;
+      p->yyvstack = pNewMinor;
+    }
+#endif
     p->yystksz = newSize;
 #ifndef NDEBUG
     if( yyTraceFILE ){
@@ -292,13 +782,25 @@ static void yyGrowStack(yyParser *p){
 }
 #endif
 
-/* Datatype of the argument to the memory allocated passed as the
-** second argument to ParseAlloc() below.  This can be changed by
-** putting an appropriate #define in the %include section of the input
-** grammar.
+#ifdef YYPROFILE
+/*
+** Set all the counters of the profile of a parser to zero.
 */
-#ifndef YYMALLOCARGTYPE
-# define YYMALLOCARGTYPE size_t
+void ParseProfileReset(void *p){
+  unsigned char *z = (unsigned char*)&((yyParser*)p)->yyprof;
+  size_t i;
+  for(i=0; i<sizeof(yyProfile); i++) z[i] = 0;
+}
+
+/*
+** Count a parse that has ended in the histogram of stack depths.
+*/
+static void yyProfileEnd(yyParser *p){
+  int i = 0;
+  while( (p->yyprof.iDepth>>i)>1 && i<YYPROFILEDEPTHS-1 ) i++;
+  p->yyprof.aDepth[i]++;
+  p->yyprof.iDepth = 0;
+}
 #endif
 
 /* 
@@ -318,11 +820,51 @@ void *ParseAlloc(void *(*mallocProc)(YYMALLOCARGTYPE)){
   pParser = (yyParser*)(*mallocProc)( (YYMALLOCARGTYPE)sizeof(yyParser) );
   if( pParser ){
     pParser->yyidx = -1;
+#ifdef YYTOKENHANDLE
+    pParser->yytokens = 0;
+#endif
+#ifdef YYARENA
+    pParser->yyarena = 0;
+    pParser->yyarenaCur = 0;
+    pParser->yyarenaUsed = 0;
+    pParser->yyarenaMalloc = mallocProc;
+#endif
 #ifdef YYTRACKMAXSTACKDEPTH
     pParser->yyidxMax = 0;
 #endif
-#if YYSTACKDEPTH<=0
+#ifdef YYPROFILE
+    ParseProfileReset(pParser);
+#endif
+#ifdef YYCHECKPOINT
+    pParser->yytokenno = 0;
+    pParser->yyckEvery = 0;
+    pParser->yyckWant = 0;
+    pParser->yyckNextToken = -1;
+    pParser->yyresync = 0;
+    pParser->yysynced = -1;
+    pParser->nCk = 0;
+    pParser->nCkAlloc = 0;
+    pParser->aCk = 0;
+    pParser->yyckBytes = 0;
+    pParser->yyckBudget = 0;
+    pParser->yyckMalloc = 0;
+    pParser->yyckFree = 0;
+#endif
+#if defined(YYSTACKSEGMENTED)
+    pParser->yystack = pParser->yystk0;
+#ifdef YYSPLITSTACK
+    pParser->yyvstack = pParser->yyvstk0;
+#endif
+    pParser->yystkbase = 0;
+    pParser->yystkend = YYSTACKINLINE;
+    pParser->yyseg = 0;
+    pParser->yysegFree = 0;
+    pParser->yymalloc = mallocProc;
+#elif YYSTACKDEPTH<=0
     pParser->yystack = NULL;
+#ifdef YYSPLITSTACK
+    pParser->yyvstack = NULL;
+#endif
     pParser->yystksz = 0;
     yyGrowStack(pParser);
 #endif
@@ -330,14 +872,66 @@ void *ParseAlloc(void *(*mallocProc)(YYMALLOCARGTYPE)){
   return pParser;
 }
 
+#ifdef YYARENA
+/*
+** Allocate n bytes from the arena of a parser, aligned for any type.
+** The memory stays valid until the arena is rewound, which happens after
+** the %parse_accept, %parse_failure or %stack_overflow code has run, and
+** in ParseReset() and ParseFree().  Return NULL if out of memory.
+*/
+void *ParseArenaAlloc(void *p, size_t n){
+  yyParser *pParser = (yyParser*)p;
+  yyArenaChunk *pChunk = pParser->yyarenaCur;
+  void *pRet;
+
+  n = (n + sizeof(yyArenaAlign) - 1)/sizeof(yyArenaAlign)*sizeof(yyArenaAlign);
+  while( pChunk==0 || pParser->yyarenaUsed + n > pChunk->nByte ){
+    yyArenaChunk *pNext = pChunk ? pChunk->pNext : pParser->yyarena;
+    if( pNext==0 ){
+      size_t nByte = n>YYARENACHUNK ? n : YYARENACHUNK;
+      pNext = (yyArenaChunk*)(*pParser->yyarenaMalloc)( (YYMALLOCARGTYPE)
+                 (sizeof(yyArenaChunk) - sizeof(yyArenaAlign) + nByte) );
+      if( pNext==0 ) return 0;
+      pNext->pNext = 0;
+      pNext->nByte = nByte;
+      if( pChunk ){
+        pChunk->pNext = pNext;
+      }else{
+        pParser->yyarena = pNext;
+      }
+    }
+    pChunk = pNext;
+    pParser->yyarenaCur = pChunk;
+    pParser->yyarenaUsed = 0;
+  }
+  pRet = (char*)pChunk->aSpace + pParser->yyarenaUsed;
+  pParser->yyarenaUsed += n;
+  return pRet;
+}
+
+/*
+** Make all the memory of the arena free again.
+*/
+static void yyArenaRewind(yyParser *pParser){
+  pParser->yyarenaCur = pParser->yyarena;
+  pParser->yyarenaUsed = 0;
+}
+#else
+# define yyArenaRewind(P)
+#endif /* YYARENA */
+
 /* The following function deletes the "minor type" or semantic value
 ** associated with a symbol.  The symbol can be either a terminal
 ** or nonterminal. "yymajor" is the symbol code, and "yypminor" is
 ** a pointer to the value to be deleted.  The code used to do the 
 ** deletions is derived from the %destructor and/or %token_destructor
-** directives of the input grammar.
+** directives of the input grammar.  A recognizer has no values to delete.
 */
-static void yy_destructor(
+#ifdef YYRECOGNIZER
+# define yy_destructor(P,X,Y)
+#endif
+#ifndef YYRECOGNIZER
+YYSHARED void yy_destructor(
   yyParser *yypParser,    /* The parser */
   YYCODETYPE yymajor,     /* Type code for object to destroy */
   YYMINORTYPE *yypminor   /* The object to be destroyed */
@@ -360,6 +954,7 @@ static void yy_destructor(
     default:  break;   /* If no destructor action specified: do nothing */
   }
 }
+#endif /* YYRECOGNIZER */
 
 /*
 ** Pop the parser's stack once.
@@ -369,8 +964,15 @@ static void yy_destructor(
 */
 static void yy_pop_parser_stack(yyParser *pParser){
   yyStackEntry *yytos;
+#ifndef YYRECOGNIZER
+  YYMINORTYPE *yypminor;
+#endif
   assert( pParser->yyidx>=0 );
-  yytos = &pParser->yystack[pParser->yyidx--];
+  yytos = yyStackTop(pParser);
+#ifndef YYRECOGNIZER
+  yypminor = yyMinorTop(pParser);
+#endif
+  pParser->yyidx--;
 #ifndef NDEBUG
   if( yyTraceFILE ){
     fprintf(yyTraceFILE,"%sPopping %s\n",
@@ -378,9 +980,44 @@ static void yy_pop_parser_stack(yyParser *pParser){
       yyTokenName[yytos->major]);
   }
 #endif
-  yy_destructor(pParser, yytos->major, &yytos->minor);
+  yy_destructor(pParser, yytos->major, yypminor);
+#ifdef YYSTACKSEGMENTED
+  if( pParser->yyidx<pParser->yystkbase && pParser->yyseg ){
+    yyJoinStack(pParser);
+  }
+#endif
+}
+
+/*
+** Pop every entry off the stack of a parser.  When the rest of a
+** segmented stack is shared, the parser lets go of it as a whole rather
+** than copying it to pop it: its last entry is moved down to sit right
+** above yystk0[].
+*/
+static void yyClearStack(yyParser *pParser){
+  while( pParser->yyidx>=0 ){
+#if defined(YYSTACKSEGMENTED) && defined(YYSNAPSHOTCOPY)
+    yyStackSegment *pSeg = pParser->yyseg;
+    if( pSeg && pSeg->pPrev && pSeg->pPrev->nRef>1
+     && pParser->yyidx==pParser->yystkbase ){
+      pSeg->pPrev->nRef--;
+      pSeg->pPrev = 0;
+      pSeg->iBase = YYSTACKINLINE - YYNRHSMAX;
+      pParser->yystkbase = pSeg->iBase;
+      pParser->yystkend = pSeg->iBase + YYSTACKSEGSIZE;
+      pParser->yyidx = pSeg->iBase;
+    }
+#endif
+    yy_pop_parser_stack(pParser);
+  }
 }
 
+#ifdef YYCHECKPOINT
+static void yyCheckpointClear(yyParser*);
+#else
+# define yyCheckpointClear(P)
+#endif
+
 /* 
 ** Deallocate and destroy a parser.  Destructors are called for
 ** all stack elements before shutting the parser down.
@@ -397,13 +1034,910 @@ void ParseFree(
 #ifndef YYPARSEFREENEVERNULL
   if( pParser==0 ) return;
 #endif
-  while( pParser->yyidx>=0 ) yy_pop_parser_stack(pParser);
-#if YYSTACKDEPTH<=0
+  yyClearStack(pParser);
+  yyCheckpointClear(pParser);
+#if defined(YYSTACKSEGMENTED)
+  assert( pParser->yyseg==0 );
+  while( pParser->yysegFree ){
+    yyStackSegment *pSeg = pParser->yysegFree;
+    pParser->yysegFree = pSeg->pPrev;
+    (*freeProc)((void*)pSeg);
+  }
+#elif YYSTACKDEPTH<=0
   free(pParser->yystack);
+#ifdef YYSPLITSTACK
+  free(pParser->yyvstack);
+#endif
+#endif
+#ifdef YYARENA
+  while( pParser->yyarena ){
+    yyArenaChunk *pChunk = pParser->yyarena;
+    pParser->yyarena = pChunk->pNext;
+    (*freeProc)((void*)pChunk);
+  }
 #endif
   (*freeProc)((void*)pParser);
 }
 
+/*
+** Return a parser to its initial state, ready for new input.  Destructors
+** are called for all stack elements and the arena, if any, is rewound.
+** Checkpoints, if any, are dropped.
+*/
+void ParseReset(void *p){
+  yyParser *pParser = (yyParser*)p;
+  yyClearStack(pParser);
+  yyArenaRewind(pParser);
+  yyCheckpointClear(pParser);
+}
+
+#ifdef YYTOKENHANDLE
+/*
+** Give the parser the array of tokens that the handles passed to Parse()
+** index into.  The array belongs to the caller.  It must hold every
+** token that is on the stack, and be given again if it moves.
+*/
+void ParseTokens(void *p, ParseTOKENTYPE *aToken){
+  ((yyParser*)p)->yytokens = aToken;
+}
+#endif
+
+#ifdef YYSNAPSHOTCOPY
+/* A copy of the stack of a parser, taken by ParseSnapshot().  Only the
+** live entries are copied, from the bottom of the stack up, so that a
+** snapshot is no larger than the stack it was taken from.  With a
+** segmented stack, the entries from nBottom up to but not including iTop
+** are not copied: they are the full segments of the parser below its
+** topmost one, and pShared points to these.
+*/
+typedef struct yySnapEntry yySnapEntry;
+struct yySnapEntry {
+  yyStackEntry e;               /* State and major number */
+#ifdef YYSPLITSTACK
+  YYMINORTYPE minor;            /* The minor value of the entry */
+#endif
+};
+typedef struct yySnapshot yySnapshot;
+struct yySnapshot {
+  int yyidx;                    /* Index of the top entry */
+#ifndef YYNOERRORRECOVERY
+  int yyerrcnt;                 /* Shifts left before out of the error */
+#endif
+#ifdef YYTOKENHANDLE
+  ParseTOKENTYPE *yytokens;     /* The caller's tokens, indexed by handle */
+#endif
+#ifdef YYSTACKSEGMENTED
+  int nBottom;                  /* Entries copied from the bottom up */
+  int iTop;                     /* Stack index of the entries after those */
+  yyStackSegment *pShared;      /* The segments in between.  Or NULL */
+#endif
+  yySnapEntry aEntry[1];        /* The entries copied */
+};
+#define yySnapshotBytes(IDX) \
+  (sizeof(yySnapshot) + ((IDX)>0 ? (IDX) : 0)*sizeof(yySnapEntry))
+#ifdef YYSTACKSEGMENTED
+# define yySnapCount(S) ((S)->nBottom + (S)->yyidx + 1 - (S)->iTop)
+#else
+# define yySnapCount(S) ((S)->yyidx + 1)
+#endif
+#if defined(YYRECOGNIZER)
+# define yySnapMinor(S,I) ((YYMINORTYPE*)0)
+#elif defined(YYSPLITSTACK)
+# define yySnapMinor(S,I) (&(S)->aEntry[I].minor)
+#else
+# define yySnapMinor(S,I) (&(S)->aEntry[I].e.minor)
+#endif
+#endif /* YYSNAPSHOTCOPY */
+
+/*
+** Return the entry at index i of the stack of a parser, and write a
+** pointer to its minor value into *ppMinor.  In a segmented stack the
+** entry is found in the topmost segment that covers index i, or in
+** yystk0[] without a search if it is below all of the segments.
+*/
+static yyStackEntry *yyStackAt(yyParser *p, int i, YYMINORTYPE **ppMinor){
+  yyStackEntry *pEntry;
+#ifdef YYSTACKSEGMENTED
+  if( i<p->yystkbase ){
+    yyStackSegment *pSeg;
+    pSeg = i<YYSTACKINLINE-YYNRHSMAX ? 0 : p->yyseg->pPrev;
+    while( pSeg && i<pSeg->iBase ) pSeg = pSeg->pPrev;
+    if( pSeg ){
+      pEntry = &pSeg->aEntry[i - pSeg->iBase];
+#ifdef YYSPLITSTACK
+      *ppMinor = &pSeg->aMinor[i - pSeg->iBase];
+#endif
+    }else{
+      pEntry = &p->yystk0[i];
+#ifdef YYSPLITSTACK
+      *ppMinor = &p->yyvstk0[i];
+#endif
+    }
+  }else{
+    pEntry = &p->yystack[i - p->yystkbase];
+#ifdef YYSPLITSTACK
+    *ppMinor = &p->yyvstack[i - p->yystkbase];
+#endif
+  }
+#else
+  pEntry = &p->yystack[i];
+#ifdef YYSPLITSTACK
+  *ppMinor = &p->yyvstack[i];
+#endif
+#endif
+#if !defined(YYSPLITSTACK) && !defined(YYRECOGNIZER)
+  *ppMinor = &pEntry->minor;
+#endif
+  return pEntry;
+}
+
+/*
+** Push one uninitialized entry onto the stack of a parser, growing the
+** stack if it must.  Return non-zero if the stack cannot grow.
+*/
+static int yyPushEntry(yyParser *p){
+#if defined(YYSTACKSEGMENTED)
+  p->yyidx++;
+  if( p->yyidx>=p->yystkend && yySpillStack(p) ){
+    p->yyidx--;
+    return 1;
+  }
+#elif YYSTACKDEPTH<=0
+  if( p->yyidx>=p->yystksz-1 ){
+    yyGrowStack(p);
+    if( p->yyidx>=p->yystksz-1 ) return 1;
+  }
+  p->yyidx++;
+#else
+  if( p->yyidx>=YYSTACKDEPTH-1 ) return 1;
+  p->yyidx++;
+#endif
+#ifdef YYTRACKMAXSTACKDEPTH
+  if( p->yyidx>p->yyidxMax ) p->yyidxMax = p->yyidx;
+#endif
+  return 0;
+}
+
+#ifdef YYSNAPSHOTCOPY
+/*
+** Copy entry i of a stack into the entry on top of the stack of pTo.
+** The bottom entry has no value.
+*/
+static void yyCopyEntry(
+  yyParser *pTo,              /* The parser whose top entry is written */
+  int i,                      /* Index of the entry being copied */
+  const yyStackEntry *pFrom,  /* The entry being copied */
+  YYMINORTYPE *pMinor         /* The minor value of pFrom */
+){
+  yyStackEntry *yytos = yyStackTop(pTo);
+  yytos->stateno = pFrom->stateno;
+  yytos->major = pFrom->major;
+#ifndef YYRECOGNIZER
+  if( i>0 ) YYSNAPSHOTCOPY(pTo, pFrom->major, yyMinorTop(pTo), pMinor);
+#else
+  (void)i;
+  (void)pMinor;
+#endif
+}
+
+#ifdef YYSTACKSEGMENTED
+/*
+** Find the part of the stack of a parser that can be shared: the full
+** segments below its topmost one.  Write the number of entries beneath
+** them into *pnBottom and the stack index of the entries above them into
+** *piTop, and return the topmost of them.  Return NULL if there are none,
+** with all of the stack in *pnBottom.
+*/
+static yyStackSegment *yySharedStack(yyParser *p, int *pnBottom, int *piTop){
+  if( p->yyseg && p->yyseg->pPrev ){
+    *pnBottom = YYSTACKINLINE - YYNRHSMAX;
+    *piTop = p->yystkbase;
+    return p->yyseg->pPrev;
+  }
+  *pnBottom = *piTop = p->yyidx + 1;
+  return 0;
+}
+
+/*
+** Put the segments pShared on the stack of the parser p, which holds
+** the entries beneath them, and an empty topmost segment above them for
+** the entries from stack index iTop up.  Return non-zero if out of
+** memory.
+*/
+static int yyShareStack(yyParser *p, yyStackSegment *pShared, int iTop){
+  yyStackSegment *pSeg = p->yysegFree;
+
+  assert( p->yyseg==0 && p->yyidx==YYSTACKINLINE-YYNRHSMAX-1 );
+  if( pSeg ){
+    p->yysegFree = pSeg->pPrev;
+  }else{
+    pSeg = (yyStackSegment*)(*p->yymalloc)(
+                                 (YYMALLOCARGTYPE)sizeof(yyStackSegment) );
+    if( pSeg==0 ) return 1;
+  }
+  pSeg->pPrev = pShared;
+  pSeg->iBase = iTop;
+  pSeg->nRef = 1;
+  pShared->nRef++;
+  p->yyseg = pSeg;
+  p->yystack = pSeg->aEntry;
+#ifdef YYSPLITSTACK
+  p->yyvstack = pSeg->aMinor;
+#endif
+  p->yystkbase = iTop;
+  p->yystkend = iTop + YYSTACKSEGSIZE;
+  p->yyidx = iTop - 1;
+  return 0;
+}
+
+/*
+** Drop a pointer to the segment pSeg.  Once nothing points to it, the
+** values in the segment are destroyed, the pointer it holds to the next
+** lower segment is dropped in turn and the segment is released with
+** freeProc.
+*/
+static void yyReleaseSegment(
+  yyParser *p,                /* A parser of the same grammar */
+  yyStackSegment *pSeg,       /* The segment.  May be NULL */
+  void (*freeProc)(void*)     /* Function used to reclaim memory */
+){
+  while( pSeg && --pSeg->nRef==0 ){
+    yyStackSegment *pPrev = pSeg->pPrev;
+    int i;
+    for(i=YYSEGLIVE-1; i>=0; i--){
+      yy_destructor(p, pSeg->aEntry[i].major, yySegMinor(pSeg,i));
+    }
+    (*freeProc)((void*)pSeg);
+    pSeg = pPrev;
+  }
+  (void)p;
+}
+#endif /* YYSTACKSEGMENTED */
+
+/*
+** Return the entry at stack index i of a snapshot, and write a pointer
+** to its minor value into *ppMinor.
+*/
+static yyStackEntry *yySnapAt(yySnapshot *pSnap, int i, YYMINORTYPE **ppMinor){
+#ifdef YYSTACKSEGMENTED
+  if( i>=pSnap->nBottom ){
+    if( i<pSnap->iTop ){
+      yyStackSegment *pSeg = pSnap->pShared;
+      while( i<pSeg->iBase ) pSeg = pSeg->pPrev;
+      *ppMinor = yySegMinor(pSeg, i - pSeg->iBase);
+      return &pSeg->aEntry[i - pSeg->iBase];
+    }
+    i += pSnap->nBottom - pSnap->iTop;
+  }
+#endif
+  *ppMinor = yySnapMinor(pSnap, i);
+  return &pSnap->aEntry[i].e;
+}
+
+/*
+** Take a snapshot of the state of a parser, to be given back to it, or
+** to another parser of the same grammar, by ParseRestore().  The values
+** on the stack are copied with YYSNAPSHOTCOPY.  The snapshot is released
+** by ParseSnapshotFree().  Return NULL if out of memory.
+**
+** With a segmented stack only yystk0[] and the topmost segment are
+** copied, so the time and space this takes do not grow with the depth
+** of the stack.
+*/
+void *ParseSnapshot(void *p, void *(*mallocProc)(YYMALLOCARGTYPE)){
+  yyParser *pParser = (yyParser*)p;
+  yySnapshot *pSnap;
+  int nBottom, iTop;          /* Entries [nBottom,iTop) are not copied */
+  int i, k;
+#ifdef YYSTACKSEGMENTED
+  yyStackSegment *pShared = yySharedStack(pParser, &nBottom, &iTop);
+#else
+  nBottom = iTop = pParser->yyidx + 1;
+#endif
+
+  pSnap = (yySnapshot*)(*mallocProc)( (YYMALLOCARGTYPE)yySnapshotBytes(
+                                    nBottom + pParser->yyidx - iTop) );
+  if( pSnap==0 ) return 0;
+  pSnap->yyidx = pParser->yyidx;
+#ifndef YYNOERRORRECOVERY
+  pSnap->yyerrcnt = pParser->yyerrcnt;
+#endif
+#ifdef YYTOKENHANDLE
+  pSnap->yytokens = pParser->yytokens;
+#endif
+#ifdef YYSTACKSEGMENTED
+  pSnap->nBottom = nBottom;
+  pSnap->iTop = iTop;
+  pSnap->pShared = pShared;
+  if( pShared ) pShared->nRef++;
+#endif
+  for(i=k=0; i<=pParser->yyidx; i++, k++){
+    YYMINORTYPE *pMinor = 0;
+    yyStackEntry *pEntry;
+    if( i==nBottom ) i = iTop;
+    pEntry = yyStackAt(pParser, i, &pMinor);
+    pSnap->aEntry[k].e.stateno = pEntry->stateno;
+    pSnap->aEntry[k].e.major = pEntry->major;
+#ifndef YYRECOGNIZER
+    if( i>0 ){
+      YYSNAPSHOTCOPY(pParser, pEntry->major, yySnapMinor(pSnap,k), pMinor);
+    }
+#endif
+  }
+  return pSnap;
+}
+
+/*
+** Put a parser back in the state recorded by a snapshot.  Destructors
+** are called for the entries now on its stack, and the values of the
+** snapshot are copied with YYSNAPSHOTCOPY, so the snapshot can be
+** restored again.  Return non-zero, leaving the parser empty, if the
+** stack cannot grow.
+*/
+int ParseRestore(void *p, void *pSnapshot){
+  yyParser *pParser = (yyParser*)p;
+  yySnapshot *pSnap = (yySnapshot*)pSnapshot;
+  int i;
+
+  yyClearStack(pParser);
+  for(i=0; i<=pSnap->yyidx; i++){
+    YYMINORTYPE *pMinor = 0;
+    yyStackEntry *pEntry;
+#ifdef YYSTACKSEGMENTED
+    if( i==pSnap->nBottom && pSnap->pShared ){
+      if( yyShareStack(pParser, pSnap->pShared, pSnap->iTop) ){
+        yyClearStack(pParser);
+        return 1;
+      }
+      i = pSnap->iTop;
+    }
+#endif
+    pEntry = yySnapAt(pSnap, i, &pMinor);
+    if( yyPushEntry(pParser) ){
+      yyClearStack(pParser);
+      return 1;
+    }
+    yyCopyEntry(pParser, i, pEntry, pMinor);
+  }
+#ifndef YYNOERRORRECOVERY
+  pParser->yyerrcnt = pSnap->yyerrcnt;
+#endif
+#ifdef YYTOKENHANDLE
+  pParser->yytokens = pSnap->yytokens;
+#endif
+  return 0;
+}
+
+/*
+** Release a snapshot.  Destructors are called for its values, with the
+** %extra_argument of the parser p.  With a segmented stack, freeProc
+** also releases the segments that nothing else shares any more, so it
+** must match the allocator given to ParseAlloc().
+*/
+void ParseSnapshotFree(
+  void *p,                    /* A parser of the same grammar */
+  void *pSnapshot,            /* The snapshot to be released */
+  void (*freeProc)(void*)     /* Function used to reclaim memory */
+){
+  yySnapshot *pSnap = (yySnapshot*)pSnapshot;
+  int i;
+  if( pSnap==0 ) return;
+  for(i=yySnapCount(pSnap)-1; i>0; i--){
+    yy_destructor((yyParser*)p, pSnap->aEntry[i].e.major, yySnapMinor(pSnap,i));
+  }
+#ifdef YYSTACKSEGMENTED
+  yyReleaseSegment((yyParser*)p, pSnap->pShared, freeProc);
+#endif
+  (void)p;
+  (*freeProc)((void*)pSnap);
+}
+
+#ifndef YYARENA
+/*
+** Allocate a new parser in the same state as p, with a copy of its
+** stack and %extra_argument.  The two parsers may then be fed different
+** input.  With a segmented stack the two share the full segments below
+** the topmost one.  Return NULL if out of memory.
+*/
+void *ParseFork(
+  void *p,                                /* The parser to be copied */
+  void *(*mallocProc)(YYMALLOCARGTYPE),   /* Allocates the new parser */
+  void (*freeProc)(void*)                 /* Frees it if the copy fails */
+){
+  yyParser *pFrom = (yyParser*)p;
+  yyParser *yypParser;
+  int i;
+#ifdef YYSTACKSEGMENTED
+  int nBottom, iTop;
+  yyStackSegment *pShared = yySharedStack(pFrom, &nBottom, &iTop);
+#endif
+
+  yypParser = (yyParser*)ParseAlloc(mallocProc);
+  if( yypParser==0 ) return 0;
+  {
+    yyParser *pTo = yypParser;
+    yypParser = pFrom;
+    {
+      ParseARG_FETCH;
+      yypParser = pTo;
+      ParseARG_STORE;
+    }
+  }
+  for(i=0; i<=pFrom->yyidx; i++){
+    YYMINORTYPE *pMinor = 0;
+    yyStackEntry *pEntry;
+#ifdef YYSTACKSEGMENTED
+    if( i==nBottom && pShared ){
+      if( yyShareStack(yypParser, pShared, iTop) ){
+        ParseFree(yypParser, freeProc);
+        return 0;
+      }
+      i = iTop;
+    }
+#endif
+    pEntry = yyStackAt(pFrom, i, &pMinor);
+    if( yyPushEntry(yypParser) ){
+      ParseFree(yypParser, freeProc);
+      return 0;
+    }
+    yyCopyEntry(yypParser, i, pEntry, pMinor);
+  }
+#ifndef YYNOERRORRECOVERY
+  yypParser->yyerrcnt = pFrom->yyerrcnt;
+#endif
+#ifdef YYTOKENHANDLE
+  yypParser->yytokens = pFrom->yytokens;
+#endif
+  return yypParser;
+}
+#endif /* YYARENA */
+#endif /* YYSNAPSHOTCOPY */
+
+/*
+** Write the unsigned integer v as a varint at offset i of the n-byte
+** buffer a[], seven bits to a byte, low bits first.  Bytes past the end
+** of the buffer are counted but not written.  Return the offset after it.
+*/
+static int yyPutVarint(unsigned char *a, int n, int i, unsigned int v){
+  do{
+    unsigned char c = (unsigned char)(v & 0x7f);
+    v >>= 7;
+    if( v ) c |= 0x80;
+    if( i<n ) a[i] = c;
+    i++;
+  }while( v );
+  return i;
+}
+
+/*
+** Read a varint at offset i of the n-byte buffer a[] into *pV.  Return
+** the offset after it, or -1 if it is cut short or too large.
+*/
+static int yyGetVarint(const unsigned char *a, int n, int i, unsigned int *pV){
+  unsigned int v = 0;
+  int shift = 0;
+  do{
+    if( i>=n || shift>28 ) return -1;
+    v |= (unsigned int)(a[i] & 0x7f) << shift;
+    shift += 7;
+  }while( a[i++] & 0x80 );
+  *pV = v;
+  return i;
+}
+
+/*
+** Write the state of a parser into the nOut-byte buffer aOut[], and
+** return the number of bytes it takes.  Nothing past nOut bytes is
+** written, so a call with nOut==0 measures the state.  A header holds
+** YYTABLEPRINT, so that only a parser with the same tables loads the
+** state.  Then only the live entries of the stack are written: their
+** state and symbol numbers as varints, followed by the value of each
+** symbol.
+**
+** A value is written by xValue(pArg, major, pValue, a, n), where pValue
+** points to the value of symbol major.  It returns the number of bytes
+** the value takes, and writes them to a[] if n is at least that.  If
+** xValue is NULL the bytes of each value are copied as they are, which
+** only suits values without pointers.  Return -1 if xValue fails.
+**
+** The %extra_argument is not written, and with -t nor are the tokens:
+** give ParseTokens() again after ParseDeserialize().
+*/
+int ParseSerialize(
+  void *p,                          /* The parser */
+  unsigned char *aOut,              /* Write the state here */
+  int nOut,                         /* Bytes available in aOut[] */
+  int (*xValue)(void*,int,void*,unsigned char*,int),  /* Writes a value */
+  void *pArg                        /* First argument to xValue */
+){
+  yyParser *pParser = (yyParser*)p;
+  int iOff = 0;
+  int i;
+
+  iOff = yyPutVarint(aOut, nOut, iOff, YYNSTATE);
+  iOff = yyPutVarint(aOut, nOut, iOff, YYNRULE);
+  iOff = yyPutVarint(aOut, nOut, iOff, YYTABLEPRINT);
+  iOff = yyPutVarint(aOut, nOut, iOff, (unsigned int)(pParser->yyidx+1));
+#ifndef YYNOERRORRECOVERY
+  iOff = yyPutVarint(aOut, nOut, iOff,
+               pParser->yyidx<0 ? 0 : (unsigned int)(pParser->yyerrcnt+1));
+#endif
+  for(i=0; i<=pParser->yyidx; i++){
+    YYMINORTYPE *pMinor = 0;
+    yyStackEntry *pEntry = yyStackAt(pParser, i, &pMinor);
+    iOff = yyPutVarint(aOut, nOut, iOff, pEntry->stateno);
+    iOff = yyPutVarint(aOut, nOut, iOff, pEntry->major);
+#ifndef YYRECOGNIZER
+    if( i==0 ) continue;
+    if( xValue ){
+      int nValue = xValue(pArg, pEntry->major, (void*)pMinor,
+                          iOff<nOut ? &aOut[iOff] : 0, iOff<nOut ? nOut-iOff : 0);
+      if( nValue<0 ) return -1;
+      iOff += nValue;
+    }else{
+      const unsigned char *z = (const unsigned char*)pMinor;
+      int j;
+      for(j=0; j<(int)sizeof(YYMINORTYPE); j++, iOff++){
+        if( iOff<nOut ) aOut[iOff] = z[j];
+      }
+    }
+#endif
+  }
+  (void)xValue;
+  (void)pArg;
+  return iOff;
+}
+
+#ifndef YYRECOGNIZER
+/*
+** Empty the stack of a parser whose top entry has no valid value.  The
+** top entry is dropped without calling its destructor.
+*/
+static void yyDropStack(yyParser *p){
+  p->yyidx--;
+#ifdef YYSTACKSEGMENTED
+  if( p->yyidx<p->yystkbase && p->yyseg ) yyJoinStack(p);
+#endif
+  while( p->yyidx>=0 ) yy_pop_parser_stack(p);
+}
+#endif
+
+/*
+** Put a parser in the state written by ParseSerialize() into the nIn
+** bytes of aIn[].  Destructors are called for the entries now on its
+** stack.  Each value is read by xValue(pArg, major, pValue, a, n), which
+** fills in *pValue from the n bytes at a[] and returns the number of
+** bytes it used, or -1 if they are not a valid value, after releasing
+** anything it allocated for it.  With a NULL xValue the bytes are copied
+** as they are.  The %extra_argument, if any, is passed as to Parse(), as
+** the destructors may need it.  Return non-zero, leaving the parser
+** empty, if the buffer is not the state of a parser built from the same
+** tables or if out of memory.  The bottom entry must be state 0, and every entry
+** above it must hold the state that the entry below goes to on its
+** symbol, so only a stack that Parse() could have built is loaded.  Only
+** the top entry may hold a reduce action.  The values are not checked.
+*/
+static int yyDeserializeEntry(yyParser*, unsigned int, unsigned int, int);
+int ParseDeserialize(
+  void *p,                          /* The parser */
+  const unsigned char *aIn,         /* The state written by ParseSerialize() */
+  int nIn,                          /* Bytes in aIn[] */
+  int (*xValue)(void*,int,void*,const unsigned char*,int),  /* Reads a value */
+  void *pArg                        /* First argument to xValue */
+  ParseARG_PDECL                    /* Optional %extra_argument parameter */
+){
+  yyParser *yypParser = (yyParser*)p;
+  yyParser *pParser = yypParser;
+  unsigned int nState, nRule, nPrint, nEntry, v;
+  int iOff = 0;
+  unsigned int i;
+
+  ParseARG_STORE;
+  while( pParser->yyidx>=0 ) yy_pop_parser_stack(pParser);
+  if( (iOff = yyGetVarint(aIn, nIn, iOff, &nState))<0
+   || (iOff = yyGetVarint(aIn, nIn, iOff, &nRule))<0
+   || (iOff = yyGetVarint(aIn, nIn, iOff, &nPrint))<0
+   || nState!=YYNSTATE || nRule!=YYNRULE || nPrint!=YYTABLEPRINT
+   || (iOff = yyGetVarint(aIn, nIn, iOff, &nEntry))<0
+  ){
+    return 1;
+  }
+#ifndef YYNOERRORRECOVERY
+  if( (iOff = yyGetVarint(aIn, nIn, iOff, &v))<0 ) return 1;
+  pParser->yyerrcnt = (int)v - 1;
+#endif
+  for(i=0; i<nEntry; i++){
+    unsigned int stateno, major;
+    yyStackEntry *yytos;
+    if( (iOff = yyGetVarint(aIn, nIn, iOff, &stateno))<0
+     || (iOff = yyGetVarint(aIn, nIn, iOff, &major))<0
+     || stateno>YY_MAX_REDUCE || major>=YYNOCODE
+     || (stateno>YY_MAX_SHIFT && stateno<YY_MIN_REDUCE)
+     || (i==0 && (stateno!=0 || major!=0))
+     || (i>0 && !yyDeserializeEntry(pParser, stateno, major, i==nEntry-1))
+     || yyPushEntry(pParser)
+    ){
+      while( pParser->yyidx>=0 ) yy_pop_parser_stack(pParser);
+      return 1;
+    }
+    yytos = yyStackTop(pParser);
+    yytos->stateno = (YYACTIONTYPE)stateno;
+    yytos->major = (YYCODETYPE)major;
+#ifndef YYRECOGNIZER
+    if( i==0 ) continue;
+    if( xValue ){
+      int nValue = xValue(pArg, (int)major, (void*)yyMinorTop(pParser),
+                          &aIn[iOff], nIn-iOff);
+      if( nValue<0 || nValue>nIn-iOff ){
+        yyDropStack(pParser);
+        return 1;
+      }
+      iOff += nValue;
+    }else{
+      unsigned char *z = (unsigned char*)yyMinorTop(pParser);
+      int j;
+      if( nIn-iOff<(int)sizeof(YYMINORTYPE) ){
+        yyDropStack(pParser);
+        return 1;
+      }
+      for(j=0; j<(int)sizeof(YYMINORTYPE); j++) z[j] = aIn[iOff++];
+    }
+#endif
+  }
+  (void)xValue;
+  (void)pArg;
+  (void)v;
+  return 0;
+}
+
+#ifdef YYCHECKPOINT
+/*
+** Return the index of the first checkpoint of a parser at or after
+** token offset iToken, or nCk if there is none.
+*/
+static int yyCheckpointFind(yyParser *p, int iToken){
+  int lo = 0, hi = p->nCk;
+  while( lo<hi ){
+    int mid = (lo + hi)/2;
+    if( p->aCk[mid].iToken<iToken ){
+      lo = mid + 1;
+    }else{
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+/*
+** Note the offset of the first checkpoint after token offset iToken, so
+** that Parse() only has to compare offsets to find out when it is there.
+*/
+static void yyCheckpointNext(yyParser *p, int iToken){
+  int i = yyCheckpointFind(p, iToken+1);
+  p->yyckNextToken = i<p->nCk ? p->aCk[i].iToken : -1;
+}
+
+/*
+** Release the snapshot of checkpoint i.
+*/
+static void yyCheckpointDrop(yyParser *p, int i){
+  yySnapshot *pSnap = p->aCk[i].pSnap;
+  p->yyckBytes -= yySnapshotBytes(yySnapCount(pSnap)-1);
+  ParseSnapshotFree(p, pSnap, p->yyckFree);
+}
+
+/*
+** Release all the checkpoints of a parser and count tokens from zero.
+*/
+static void yyCheckpointClear(yyParser *p){
+  int i;
+  for(i=0; i<p->nCk; i++) yyCheckpointDrop(p, i);
+  if( p->aCk ) (*p->yyckFree)((void*)p->aCk);
+  p->aCk = 0;
+  p->nCk = 0;
+  p->nCkAlloc = 0;
+  p->yytokenno = 0;
+  p->yyckWant = 0;
+  p->yyckNextToken = -1;
+  p->yyresync = 0;
+  p->yysynced = -1;
+}
+
+/*
+** Store a snapshot of a parser as the checkpoint for token offset k, at
+** index i of aCk[], in place of the one already there for k if any.
+** When the snapshots use more than the budget, every other checkpoint
+** is dropped and the interval between them is doubled.
+*/
+static void yyCheckpointTake(yyParser *p, int i, int k){
+  yySnapshot *pSnap;
+  int j;
+
+  if( i>=p->nCk || p->aCk[i].iToken!=k ){
+    if( p->nCk>=p->nCkAlloc ){
+      int nNew = p->nCkAlloc*2 + 16;
+      yyCheckpoint *aNew = (yyCheckpoint*)(*p->yyckMalloc)(
+                                (YYMALLOCARGTYPE)(nNew*sizeof(yyCheckpoint)) );
+      if( aNew==0 ) return;
+      for(j=0; j<p->nCk; j++) aNew[j] = p->aCk[j];
+      if( p->aCk ) (*p->yyckFree)((void*)p->aCk);
+      p->aCk = aNew;
+      p->nCkAlloc = nNew;
+    }
+    pSnap = (yySnapshot*)ParseSnapshot(p, p->yyckMalloc);
+    if( pSnap==0 ) return;
+    for(j=p->nCk; j>i; j--) p->aCk[j] = p->aCk[j-1];
+    p->nCk++;
+  }else{
+    pSnap = (yySnapshot*)ParseSnapshot(p, p->yyckMalloc);
+    if( pSnap==0 ) return;
+    yyCheckpointDrop(p, i);
+  }
+  p->aCk[i].iToken = k;
+  p->aCk[i].pSnap = pSnap;
+  p->yyckBytes += yySnapshotBytes(yySnapCount(pSnap)-1);
+  while( p->yyckBudget>0 && p->yyckBytes>p->yyckBudget && p->nCk>1 ){
+    int n = 1;
+    for(j=1; j<p->nCk; j++){
+      if( j&1 ){
+        yyCheckpointDrop(p, j);
+      }else{
+        p->aCk[n++] = p->aCk[j];
+      }
+    }
+    p->nCk = n;
+    if( p->yyckEvery>0 && p->yyckEvery<=0x3fffffff ) p->yyckEvery *= 2;
+  }
+}
+
+/*
+** Return true if the stack of a parser holds the same states and symbols
+** as a snapshot, and values that YYSNAPSHOTSAME finds equal.
+*/
+static int yySameState(yyParser *p, yySnapshot *pSnap){
+  int i;
+  if( p->yyidx!=pSnap->yyidx ) return 0;
+#ifndef YYNOERRORRECOVERY
+  if( p->yyidx>=0 && p->yyerrcnt!=pSnap->yyerrcnt ) return 0;
+#endif
+  for(i=p->yyidx; i>=0; i--){
+    YYMINORTYPE *pMinor = 0, *pOldMinor = 0;
+    yyStackEntry *pEntry, *pOld;
+#ifdef YYSTACKSEGMENTED
+    /* Segments that the parser still shares with the snapshot match */
+    if( i==pSnap->iTop-1 && pSnap->pShared && p->yyseg
+     && p->yyseg->pPrev==pSnap->pShared ){
+      i = pSnap->nBottom;
+      continue;
+    }
+#endif
+    pEntry = yyStackAt(p, i, &pMinor);
+    pOld = yySnapAt(pSnap, i, &pOldMinor);
+    if( pEntry->stateno!=pOld->stateno || pEntry->major!=pOld->major ){
+      return 0;
+    }
+#ifndef YYRECOGNIZER
+    if( i>0 && !YYSNAPSHOTSAME(p, pEntry->major, pMinor, pOldMinor) ){
+      return 0;
+    }
+#endif
+  }
+  return 1;
+}
+
+/*
+** Called by Parse() before each token.  Take the checkpoints that are
+** due and, after ParseResume(), compare the parser with the checkpoints
+** that were kept from before the edit.
+*/
+static void yyCheckpointStep(yyParser *p){
+  int k = p->yytokenno++;
+  int i;
+
+  if( k==p->yyckNextToken ){
+    i = yyCheckpointFind(p, k);
+    if( p->yyresync && yySameState(p, p->aCk[i].pSnap) ){
+      p->yyresync = 0;
+      p->yysynced = k;
+    }else{
+      yyCheckpointTake(p, i, k);
+    }
+    yyCheckpointNext(p, k);
+  }else if( p->yyckWant || (p->yyckEvery>0 && k%p->yyckEvery==0) ){
+    i = yyCheckpointFind(p, k);
+    if( i>=p->nCk || p->aCk[i].iToken!=k ){
+      yyCheckpointTake(p, i, k);
+      yyCheckpointNext(p, k);
+    }
+  }
+  p->yyckWant = 0;
+}
+
+/*
+** Make a parser take a checkpoint every nEvery tokens (never if nEvery
+** is 0), and before the next token whenever ParseCheckpoint() is called.
+** The checkpoints are allocated with mallocProc and released with
+** freeProc.  When their snapshots use more than nBudget bytes, every
+** other checkpoint is dropped and the interval doubled.  A budget of 0
+** is unlimited.  Tokens are counted from the next call to Parse().
+*/
+void ParseCheckpoints(
+  void *p,                                /* The parser */
+  int nEvery,                             /* Tokens between checkpoints */
+  size_t nBudget,                         /* Bytes the checkpoints may use */
+  void *(*mallocProc)(YYMALLOCARGTYPE),   /* Allocates the checkpoints */
+  void (*freeProc)(void*)                 /* Releases them */
+){
+  yyParser *pParser = (yyParser*)p;
+  yyCheckpointClear(pParser);
+  pParser->yyckEvery = nEvery>0 ? nEvery : 0;
+  pParser->yyckBudget = nBudget;
+  pParser->yyckMalloc = mallocProc;
+  pParser->yyckFree = freeProc;
+}
+
+/*
+** Take a checkpoint before the next token, for example at the end of a
+** statement.
+*/
+void ParseCheckpoint(void *p){
+  ((yyParser*)p)->yyckWant = 1;
+}
+
+/*
+** Prepare a parser to parse its input again after an edit that replaced
+** the nOld tokens at offset iToken with nNew tokens.  The parser is
+** restored from the last checkpoint at or before iToken, and the offset
+** of that checkpoint is returned: the input is passed to Parse() again
+** from that token on.  Checkpoints inside the edit are dropped and those
+** after it are moved by nNew-nOld tokens.  Once the parser reaches one
+** of these in the same state, ParseSynced() returns its offset and the
+** rest of the input parses as it did before.  Return -1, with the parser
+** left empty, if out of memory.
+*/
+int ParseResume(void *p, int iToken, int nOld, int nNew){
+  yyParser *pParser = (yyParser*)p;
+  int i = yyCheckpointFind(pParser, iToken+1);
+  int iFrom = i>0 ? pParser->aCk[i-1].iToken : 0;
+  int j, n;
+
+  /* A checkpoint that the edit moves back to iFrom would be passed over
+  ** by Parse() and never checked, so it is dropped too */
+  n = i;
+  for(j=i; j<pParser->nCk; j++){
+    if( pParser->aCk[j].iToken<iToken+nOld
+     || pParser->aCk[j].iToken+nNew-nOld<=iFrom ){
+      yyCheckpointDrop(pParser, j);
+    }else{
+      pParser->aCk[n] = pParser->aCk[j];
+      pParser->aCk[n].iToken += nNew - nOld;
+      n++;
+    }
+  }
+  pParser->nCk = n;
+  if( i>0 ){
+    if( ParseRestore(p, pParser->aCk[i-1].pSnap) ) return -1;
+  }else{
+    yyClearStack(pParser);
+  }
+  pParser->yytokenno = iFrom;
+  pParser->yyckWant = 0;
+  pParser->yyresync = 1;
+  pParser->yysynced = -1;
+  yyCheckpointNext(pParser, iFrom);
+  return iFrom;
+}
+
+/*
+** Return the offset of the checkpoint at which the parser was found in
+** the same state as before the edit given to ParseResume(), or -1 if it
+** has not been yet.
+*/
+int ParseSynced(void *p){
+  return ((yyParser*)p)->yysynced;
+}
+#endif /* YYCHECKPOINT */
+
 /*
 ** Return the peak depth of the stack for a parser.
 */
@@ -414,6 +1948,35 @@ int ParseStackPeak(void *p){
 }
 #endif
 
+#ifdef YYDIRECTCODED
+/*
+** Find the appropriate action for a parser given the terminal
+** look-ahead token iLookAhead.  In a direct-coded parser the actions
+** are compiled into the yy_dc_shift() and yy_dc_goto() functions.
+*/
+static unsigned int yy_find_shift_action(
+  yyParser *pParser,        /* The parser */
+  YYCODETYPE iLookAhead     /* The look-ahead token */
+){
+  int stateno = yyStackTop(pParser)->stateno;
+  if( stateno>=YY_MIN_REDUCE ) return stateno;
+  assert( stateno < YYNSTATE );
+  assert( iLookAhead!=YYNOCODE );
+  return yy_dc_shift(stateno, iLookAhead);
+}
+
+/*
+** Find the appropriate action for a parser given the non-terminal
+** look-ahead token iLookAhead.
+*/
+static int yy_find_reduce_action(
+  int stateno,              /* Current state number */
+  YYCODETYPE iLookAhead     /* The look-ahead token */
+){
+  assert( iLookAhead!=YYNOCODE );
+  return yy_dc_goto(stateno, iLookAhead);
+}
+#else /* !YYDIRECTCODED */
 /*
 ** Find the appropriate action for a parser given the terminal
 ** look-ahead token iLookAhead.
@@ -423,7 +1986,7 @@ static unsigned int yy_find_shift_action(
   YYCODETYPE iLookAhead     /* The look-ahead token */
 ){
   int i;
-  int stateno = pParser->yystack[pParser->yyidx].stateno;
+  int stateno = yyStackTop(pParser)->stateno;
  
   if( stateno>=YY_MIN_REDUCE ) return stateno;
   assert( stateno <= YY_SHIFT_COUNT );
@@ -433,6 +1996,7 @@ static unsigned int yy_find_shift_action(
     assert( iLookAhead!=YYNOCODE );
     i += iLookAhead;
     if( i<0 || i>=YY_ACTTAB_COUNT || yy_lookahead[i]!=iLookAhead ){
+#ifndef YYNOFALLBACKRETRY
       if( iLookAhead>0 ){
 #ifdef YYFALLBACK
         YYCODETYPE iFallback;            /* Fallback token */
@@ -445,6 +2009,7 @@ static unsigned int yy_find_shift_action(
           }
 #endif
           assert( yyFallback[iFallback]==0 ); /* Fallback loop must terminate */
+          yyProfileAdd(pParser, aFallback[iLookAhead]);
           iLookAhead = iFallback;
           continue;
         }
@@ -468,11 +2033,13 @@ static unsigned int yy_find_shift_action(
                  yyTokenName[YYWILDCARD]);
             }
 #endif /* NDEBUG */
+            yyProfileAdd(pParser, aWildcard[iLookAhead]);
             return yy_action[j];
           }
         }
 #endif /* YYWILDCARD */
       }
+#endif /* YYNOFALLBACKRETRY */
       return yy_default[stateno];
     }else{
       return yy_action[i];
@@ -510,6 +2077,53 @@ static int yy_find_reduce_action(
 #endif
   return yy_action[i];
 }
+#endif /* YYDIRECTCODED */
+
+/*
+** Return true if the entry on top of the stack of a parser goes to state
+** stateno on symbol major, as Parse() does when it shifts a terminal or
+** takes the goto after a reduction.  A reduce action is only accepted
+** as the new top of the stack, bTop.  Every table lookup is bounds
+** checked, as the state and symbol come from ParseDeserialize().
+*/
+static int yyDeserializeEntry(
+  yyParser *pParser,        /* The parser, its stack loaded up to here */
+  unsigned int stateno,     /* The state of the new entry */
+  unsigned int major,       /* The symbol of the new entry */
+  int bTop                  /* True if the new entry is the top one */
+){
+  int iFrom = yyStackTop(pParser)->stateno;
+  unsigned int act;
+  if( iFrom>YY_MAX_SHIFT || major>=YYNOCODE ) return 0;
+  if( major<YYNTOKEN ){
+#ifndef YYDIRECTCODED
+    if( iFrom>YY_SHIFT_COUNT ) return 0;
+#endif
+    act = yy_find_shift_action(pParser, (YYCODETYPE)major);
+  }else{
+#ifdef YYDIRECTCODED
+    act = (unsigned int)yy_dc_goto(iFrom, (int)major);
+#else
+    int i;
+    act = yy_default[iFrom];
+    if( iFrom<=YY_REDUCE_COUNT && yy_reduce_ofst[iFrom]!=YY_REDUCE_USE_DFLT ){
+      i = yy_reduce_ofst[iFrom] + (int)major;
+      if( i>=0 && i<YY_ACTTAB_COUNT && yy_lookahead[i]==major ){
+        act = yy_action[i];
+      }
+    }
+#endif
+  }
+  if( act>YY_MAX_SHIFTREDUCE ) return 0;
+  if( act>YY_MAX_SHIFT ) act += YY_MIN_REDUCE - YY_MIN_SHIFTREDUCE;
+  if( act!=stateno ) return 0;
+  if( act>YY_MAX_SHIFT ) return bTop;
+#ifndef YYDIRECTCODED
+  /* The next token looks up the state of the top entry */
+  if( bTop && act>YY_SHIFT_COUNT ) return 0;
+#endif
+  return 1;
+}
 
 /*
 ** The following routine is called if the stack overflows.
@@ -523,11 +2137,16 @@ static void yyStackOverflow(yyParser *yypParser){
    }
 #endif
    while( yypParser->yyidx>=0 ) yy_pop_parser_stack(yypParser);
+#ifdef YYPROFILE
+   yypParser->yyprof.nOverflow++;
+   yyProfileEnd(yypParser);
+#endif
    /* Here code is inserted which will execute if the parser
    ** stack every overflows */
 /******** Begin %stack_overflow code ******************************************/
 %%
 /******** End %stack_overflow code ********************************************/
+   yyArenaRewind(yypParser);
    ParseARG_STORE; /* Suppress warning about unused %extra_argument var */
 }
 
@@ -539,11 +2158,11 @@ static void yyTraceShift(yyParser *yypParser, int yyNewState){
   if( yyTraceFILE ){
     if( yyNewState<YYNSTATE ){
       fprintf(yyTraceFILE,"%sShift '%s', go to state %d\n",
-         yyTracePrompt,yyTokenName[yypParser->yystack[yypParser->yyidx].major],
+         yyTracePrompt,yyTokenName[yyStackTop(yypParser)->major],
          yyNewState);
     }else{
       fprintf(yyTraceFILE,"%sShift '%s'\n",
-         yyTracePrompt,yyTokenName[yypParser->yystack[yypParser->yyidx].major]);
+         yyTracePrompt,yyTokenName[yyStackTop(yypParser)->major]);
     }
   }
 }
@@ -557,8 +2176,8 @@ static void yyTraceShift(yyParser *yypParser, int yyNewState){
 static void yy_shift(
   yyParser *yypParser,          /* The parser to be shifted */
   int yyNewState,               /* The new state to shift in */
-  int yyMajor,                  /* The major token to shift in */
-  ParseTOKENTYPE yyMinor        /* The minor token to shift in */
+  int yyMajor                   /* The major token to shift in */
+  YYMINOR_PDECL                 /* The minor token to shift in */
 ){
   yyStackEntry *yytos;
   yypParser->yyidx++;
@@ -567,7 +2186,17 @@ static void yy_shift(
     yypParser->yyidxMax = yypParser->yyidx;
   }
 #endif
-#if YYSTACKDEPTH>0 
+#ifdef YYPROFILE
+  if( yypParser->yyidx>yypParser->yyprof.iDepth ){
+    yypParser->yyprof.iDepth = yypParser->yyidx;
+  }
+#endif
+#if defined(YYSTACKSEGMENTED)
+  if( yypParser->yyidx>=yypParser->yystkend && yySpillStack(yypParser) ){
+    yyStackOverflow(yypParser);
+    return;
+  }
+#elif YYSTACKDEPTH>0 
   if( yypParser->yyidx>=YYSTACKDEPTH ){
     yyStackOverflow(yypParser);
     return;
@@ -581,10 +2210,12 @@ static void yy_shift(
     }
   }
 #endif
-  yytos = &yypParser->yystack[yypParser->yyidx];
+  yytos = yyStackTop(yypParser);
   yytos->stateno = (YYACTIONTYPE)yyNewState;
   yytos->major = (YYCODETYPE)yyMajor;
-  yytos->minor.yy0 = yyMinor;
+#ifndef YYRECOGNIZER
+  yyMinorTop(yypParser)->yy0 = yyminor;
+#endif
   yyTraceShift(yypParser, yyNewState);
 }
 
@@ -600,20 +2231,60 @@ static const struct {
 
 static void yy_accept(yyParser*);  /* Forward Declaration */
 
+/* When YYREDUCEFUNC is defined, the code for each rule is a separate
+** function and yyReduceFunc[] maps every rule number to its function,
+** or to NULL if the rule has no code.  When YYREDUCEGOTO is defined,
+** the reduce cases are labels reached through a computed goto on
+** compilers that support it, and ordinary switch cases elsewhere.
+*/
+#if defined(YYREDUCEGOTO) && (defined(__GNUC__) || defined(__clang__))
+# define YYCOMPUTEDGOTO 1
+#endif
+#ifdef YYCOMPUTEDGOTO
+# define yyrulecase(N)  yyrule_##N
+# define yyruledone     goto yy_reduce_done
+#else
+# define yyrulecase(N)  case N
+# define yyruledone     break
+#endif
+/********** Begin reduce action functions *************************************/
+%%
+/********** End reduce action functions ***************************************/
+
 /*
 ** Perform a reduce action and the shift that must immediately
 ** follow the reduce.
+**
+** Return the action for the new top of the stack, if it is already
+** known without a lookahead lookup.  When the goto lands in a state whose
+** only action is a reduce (lemon encodes such gotos as SHIFTREDUCE
+** actions) the reduce code itself is returned so that the caller can run
+** the whole cascade of reductions back-to-back.  Otherwise the new state
+** number, or YY_ACCEPT_ACTION, or YY_NO_ACTION after a stack overflow, is
+** returned.
 */
-static void yy_reduce(
+static int yy_reduce(
   yyParser *yypParser,         /* The parser */
   unsigned int yyruleno        /* Number of the rule by which to reduce */
 ){
   int yygoto;                     /* The next state */
   int yyact;                      /* The next action */
   yyStackEntry *yymsp;            /* The top of the parser's stack */
+#ifdef YYSPLITSTACK
+  YYMINORTYPE *yymvp;             /* The top of the minor value stack */
+#endif
   int yysize;                     /* Amount to pop the stack */
   ParseARG_FETCH;
-  yymsp = &yypParser->yystack[yypParser->yyidx];
+#ifdef YYSTACKSEGMENTED
+  /* The RHS and the entry beneath it must be in the topmost segment */
+  if( yypParser->yyidx - yyRuleInfo[yyruleno].nrhs < yypParser->yystkbase ){
+    yyJoinStack(yypParser);
+  }
+#endif
+  yymsp = yyStackTop(yypParser);
+#ifdef YYSPLITSTACK
+  yymvp = yyMinorTop(yypParser);
+#endif
 #ifndef NDEBUG
   if( yyTraceFILE && yyruleno<(int)(sizeof(yyRuleName)/sizeof(yyRuleName[0])) ){
     yysize = yyRuleInfo[yyruleno].nrhs;
@@ -631,23 +2302,53 @@ static void yy_reduce(
       yypParser->yyidxMax = yypParser->yyidx;
     }
 #endif
-#if YYSTACKDEPTH>0 
+#ifdef YYPROFILE
+    if( yypParser->yyidx+1>yypParser->yyprof.iDepth ){
+      yypParser->yyprof.iDepth = yypParser->yyidx+1;
+    }
+#endif
+#if defined(YYSTACKSEGMENTED)
+    if( yypParser->yyidx>=yypParser->yystkend-1 ){
+      yypParser->yyidx++;
+      if( yySpillStack(yypParser) ){
+        yyStackOverflow(yypParser);
+        return YY_NO_ACTION;
+      }
+      yypParser->yyidx--;
+      yymsp = yyStackTop(yypParser);
+#ifdef YYSPLITSTACK
+      yymvp = yyMinorTop(yypParser);
+#endif
+    }
+#elif YYSTACKDEPTH>0 
     if( yypParser->yyidx>=YYSTACKDEPTH-1 ){
       yyStackOverflow(yypParser);
-      return;
+      return YY_NO_ACTION;
     }
 #else
     if( yypParser->yyidx>=yypParser->yystksz-1 ){
       yyGrowStack(yypParser);
       if( yypParser->yyidx>=yypParser->yystksz-1 ){
         yyStackOverflow(yypParser);
-        return;
+        return YY_NO_ACTION;
       }
     }
 #endif
   }
 
+#if defined(YYREDUCEFUNC)
+  if( yyReduceFunc[yyruleno] ){
+#ifdef YYSPLITSTACK
+    yyReduceFunc[yyruleno](yypParser, yymsp, yymvp);
+#else
+    yyReduceFunc[yyruleno](yypParser, yymsp);
+#endif
+  }
+#elif defined(YYCOMPUTEDGOTO)
+  {
+#else
   switch( yyruleno ){
+#endif
   /* Beginning here are the reduction cases.  A typical example
   ** follows:
   **   case 0:
@@ -659,10 +2360,17 @@ static void yy_reduce(
 /********** Begin reduce actions **********************************************/
 %%
 /********** End reduce actions ************************************************/
+#if defined(YYCOMPUTEDGOTO)
+  }
+yy_reduce_done:
+#elif !defined(YYREDUCEFUNC)
   };
+#endif
   assert( yyruleno<sizeof(yyRuleInfo)/sizeof(yyRuleInfo[0]) );
   yygoto = yyRuleInfo[yyruleno].lhs;
   yysize = yyRuleInfo[yyruleno].nrhs;
+  yyProfileAdd(yypParser, aReduce[yyruleno]);
+  yyProfileAdd(yypParser, aGoto[yymsp[-yysize].stateno]);
   yyact = yy_find_reduce_action(yymsp[-yysize].stateno,(YYCODETYPE)yygoto);
   if( yyact <= YY_MAX_SHIFTREDUCE ){
     if( yyact>YY_MAX_SHIFT ) yyact += YY_MIN_REDUCE - YY_MIN_SHIFTREDUCE;
@@ -676,8 +2384,36 @@ static void yy_reduce(
     yypParser->yyidx -= yysize;
     yy_accept(yypParser);
   }
+  return yyact;
 }
 
+#ifdef YYEXPECTED
+/* True if state S expects terminal T.  S is not a reduce action. */
+#define yyExpects(S,T) \
+  ((yyExpectSet[yyExpectIndex[S]*YYEXPECTBYTES+((T)>>3)]>>((T)&7))&1)
+
+/*
+** Write to aToken[] the codes of the terminals that are not a syntax
+** error in the current state of parser p, at most nToken of them, and
+** return how many there are.  Call it from the %syntax_error code, where
+** the parser is yypParser, or between calls to Parse().  Return -1 if the
+** top of the stack is a reduction that waits for the next token, which
+** can only happen with YYLAZYREDUCE.
+*/
+int ParseExpectedTokens(void *p, int *aToken, int nToken){
+  yyParser *yypParser = (yyParser*)p;
+  int stateno = yypParser->yyidx<0 ? 0 : yyStackTop(yypParser)->stateno;
+  int i, n;
+  if( stateno>YY_MAX_SHIFT ) return -1;
+  for(i=n=0; i<YYEXPECTBYTES*8; i++){
+    if( !yyExpects(stateno, i) ) continue;
+    if( n<nToken ) aToken[n] = i;
+    n++;
+  }
+  return n;
+}
+#endif /* YYEXPECTED */
+
 /*
 ** The following code executes when the parse fails
 */
@@ -692,11 +2428,16 @@ static void yy_parse_failed(
   }
 #endif
   while( yypParser->yyidx>=0 ) yy_pop_parser_stack(yypParser);
+#ifdef YYPROFILE
+  yypParser->yyprof.nFail++;
+  yyProfileEnd(yypParser);
+#endif
   /* Here code is inserted which will be executed whenever the
   ** parser fails */
 /************ Begin %parse_failure code ***************************************/
 %%
 /************ End %parse_failure code *****************************************/
+  yyArenaRewind(yypParser);
   ParseARG_STORE; /* Suppress warning about unused %extra_argument variable */
 }
 #endif /* YYNOERRORRECOVERY */
@@ -706,11 +2447,16 @@ static void yy_parse_failed(
 */
 static void yy_syntax_error(
   yyParser *yypParser,           /* The parser */
-  int yymajor,                   /* The major type of the error token */
-  ParseTOKENTYPE yyminor         /* The minor type of the error token */
+  int yymajor                    /* The major type of the error token */
+  YYMINOR_PDECL                  /* The minor type of the error token */
 ){
   ParseARG_FETCH;
+#if defined(YYTOKENHANDLE)
+#define TOKEN yyTokenValue(yypParser,yyminor)
+#elif !defined(YYRECOGNIZER)
 #define TOKEN yyminor
+#endif
+  yyProfileAdd(yypParser, nError);
 /************ Begin %syntax_error code ****************************************/
 %%
 /************ End %syntax_error code ******************************************/
@@ -730,11 +2476,16 @@ static void yy_accept(
   }
 #endif
   while( yypParser->yyidx>=0 ) yy_pop_parser_stack(yypParser);
+#ifdef YYPROFILE
+  yypParser->yyprof.nAccept++;
+  yyProfileEnd(yypParser);
+#endif
   /* Here code is inserted which will be executed whenever the
   ** parser accepts */
 /*********** Begin %parse_accept code *****************************************/
 %%
 /*********** End %parse_accept code *******************************************/
+  yyArenaRewind(yypParser);
   ParseARG_STORE; /* Suppress warning about unused %extra_argument variable */
 }
 
@@ -744,7 +2495,9 @@ static void yy_accept(
 ** The second argument is the major token number.  The third is
 ** the minor token.  The fourth optional argument is whatever the
 ** user wants (and specified in the grammar) and is available for
-** use by the action routines.
+** use by the action routines.  A recognizer (YYRECOGNIZER) takes no
+** minor token, so its optional argument comes third.  With YYTOKENHANDLE
+** the third argument is the handle of the token.
 **
 ** Inputs:
 ** <ul>
@@ -759,11 +2512,13 @@ static void yy_accept(
 */
 void Parse(
   void *yyp,                   /* The parser */
-  int yymajor,                 /* The major token code number */
-  ParseTOKENTYPE yyminor       /* The value for the token */
+  int yymajor                  /* The major token code number */
+  YYMINOR_PDECL                /* The value for the token */
   ParseARG_PDECL               /* Optional %extra_argument parameter */
 ){
+#ifndef YYRECOGNIZER
   YYMINORTYPE yyminorunion;
+#endif
   unsigned int yyact;   /* The parser action. */
 #if !defined(YYERRORSYMBOL) && !defined(YYNOERRORRECOVERY)
   int yyendofinput;     /* True if we are at the end of input */
@@ -776,7 +2531,7 @@ void Parse(
   /* (re)initialize the parser, if necessary */
   yypParser = (yyParser*)yyp;
   if( yypParser->yyidx<0 ){
-#if YYSTACKDEPTH<=0
+#if !defined(YYSTACKSEGMENTED) && YYSTACKDEPTH<=0
     if( yypParser->yystksz <=0 ){
       yyStackOverflow(yypParser);
       return;
@@ -786,8 +2541,8 @@ void Parse(
 #ifndef YYNOERRORRECOVERY
     yypParser->yyerrcnt = -1;
 #endif
-    yypParser->yystack[0].stateno = 0;
-    yypParser->yystack[0].major = 0;
+    yyStackTop(yypParser)->stateno = 0;
+    yyStackTop(yypParser)->major = 0;
 #ifndef NDEBUG
     if( yyTraceFILE ){
       fprintf(yyTraceFILE,"%sInitialize. Empty stack. State 0\n",
@@ -799,6 +2554,9 @@ void Parse(
   yyendofinput = (yymajor==0);
 #endif
   ParseARG_STORE;
+#ifdef YYCHECKPOINT
+  if( yypParser->yyckMalloc ) yyCheckpointStep(yypParser);
+#endif
 
 #ifndef NDEBUG
   if( yyTraceFILE ){
@@ -806,20 +2564,63 @@ void Parse(
   }
 #endif
 
-  do{
+#if defined(YYEXPECTED) && !defined(YYNOERRORRECOVERY)
+  /* Until error recovery shifts a token, discard each token that the
+  ** state on top of the stack does not expect without looking up an
+  ** action.  The end of input takes the usual path. */
+#ifdef YYERRORSYMBOL
+  if( yyStackTop(yypParser)->major==YYERRORSYMBOL && yymajor!=0 )
+#else
+  if( yypParser->yyerrcnt==3 && yymajor!=0 )
+#endif
+  {
+    int yystate = yyStackTop(yypParser)->stateno;
+    if( yystate<=YY_MAX_SHIFT && !yyExpects(yystate, yymajor) ){
+#ifndef NDEBUG
+      if( yyTraceFILE ){
+        fprintf(yyTraceFILE,"%sDiscard input token %s\n",
+           yyTracePrompt,yyTokenName[yymajor]);
+      }
+#endif
+#ifndef YYRECOGNIZER
+      yyminorunion.yy0 = yyminor;
+#endif
+      yyProfileAdd(yypParser, nDiscard);
+      yy_destructor(yypParser, (YYCODETYPE)yymajor, &yyminorunion);
+      yymajor = YYNOCODE;
+    }
+  }
+#endif
+
+  while( yymajor!=YYNOCODE && yypParser->yyidx>=0 ){
     yyact = yy_find_shift_action(yypParser,(YYCODETYPE)yymajor);
     if( yyact <= YY_MAX_SHIFTREDUCE ){
       if( yyact > YY_MAX_SHIFT ) yyact += YY_MIN_REDUCE - YY_MIN_SHIFTREDUCE;
-      yy_shift(yypParser,yyact,yymajor,yyminor);
+      yyProfileAdd(yypParser, aShift[yyStackTop(yypParser)->stateno]);
+      yy_shift(yypParser,yyact,yymajor YYMINOR_PARAM);
 #ifndef YYNOERRORRECOVERY
       yypParser->yyerrcnt--;
 #endif
       yymajor = YYNOCODE;
+#ifndef YYLAZYREDUCE
+      /* The new state can only reduce, so do that now rather than when
+      ** the next token arrives */
+      while( yyact>=YY_MIN_REDUCE && yyact<=YY_MAX_REDUCE
+             && yypParser->yyidx>=0 ){
+        yyact = yy_reduce(yypParser,yyact-YY_MIN_REDUCE);
+      }
+#endif
     }else if( yyact <= YY_MAX_REDUCE ){
-      yy_reduce(yypParser,yyact-YY_MIN_REDUCE);
+      /* Run reductions back-to-back for as long as each goto lands in
+      ** a state that can only reduce */
+      do{
+        yyact = yy_reduce(yypParser,yyact-YY_MIN_REDUCE);
+      }while( yyact>=YY_MIN_REDUCE && yyact<=YY_MAX_REDUCE );
     }else{
       assert( yyact == YY_ERROR_ACTION );
+#ifndef YYRECOGNIZER
       yyminorunion.yy0 = yyminor;
+#endif
 #ifdef YYERRORSYMBOL
       int yymx;
 #endif
@@ -849,9 +2650,9 @@ void Parse(
       **
       */
       if( yypParser->yyerrcnt<0 ){
-        yy_syntax_error(yypParser,yymajor,yyminor);
+        yy_syntax_error(yypParser,yymajor YYMINOR_PARAM);
       }
-      yymx = yypParser->yystack[yypParser->yyidx].major;
+      yymx = yyStackTop(yypParser)->major;
       if( yymx==YYERRORSYMBOL || yyerrorhit ){
 #ifndef NDEBUG
         if( yyTraceFILE ){
@@ -859,6 +2660,7 @@ void Parse(
              yyTracePrompt,yyTokenName[yymajor]);
         }
 #endif
+        yyProfileAdd(yypParser, nDiscard);
         yy_destructor(yypParser, (YYCODETYPE)yymajor, &yyminorunion);
         yymajor = YYNOCODE;
       }else{
@@ -866,7 +2668,7 @@ void Parse(
           yypParser->yyidx >= 0 &&
           yymx != YYERRORSYMBOL &&
           (yyact = yy_find_reduce_action(
-                        yypParser->yystack[yypParser->yyidx].stateno,
+                        yyStackTop(yypParser)->stateno,
                         YYERRORSYMBOL)) >= YY_MIN_REDUCE
         ){
           yy_pop_parser_stack(yypParser);
@@ -876,7 +2678,8 @@ void Parse(
           yy_parse_failed(yypParser);
           yymajor = YYNOCODE;
         }else if( yymx!=YYERRORSYMBOL ){
-          yy_shift(yypParser,yyact,YYERRORSYMBOL,yyminor);
+          yyProfileAdd(yypParser, nErrorShift);
+          yy_shift(yypParser,yyact,YYERRORSYMBOL YYMINOR_PARAM);
         }
       }
       yypParser->yyerrcnt = 3;
@@ -889,7 +2692,7 @@ void Parse(
       ** Applications can set this macro (for example inside %include) if
       ** they intend to abandon the parse upon the first syntax error seen.
       */
-      yy_syntax_error(yypParser,yymajor, yyminor);
+      yy_syntax_error(yypParser,yymajor YYMINOR_PARAM);
       yy_destructor(yypParser,(YYCODETYPE)yymajor,&yyminorunion);
       yymajor = YYNOCODE;
       
@@ -904,9 +2707,10 @@ void Parse(
       ** three input tokens have been successfully shifted.
       */
       if( yypParser->yyerrcnt<=0 ){
-        yy_syntax_error(yypParser,yymajor, yyminor);
+        yy_syntax_error(yypParser,yymajor YYMINOR_PARAM);
       }
       yypParser->yyerrcnt = 3;
+      yyProfileAdd(yypParser, nDiscard);
       yy_destructor(yypParser,(YYCODETYPE)yymajor,&yyminorunion);
       if( yyendofinput ){
         yy_parse_failed(yypParser);
@@ -914,16 +2718,641 @@ void Parse(
       yymajor = YYNOCODE;
 #endif
     }
-  }while( yymajor!=YYNOCODE && yypParser->yyidx>=0 );
+  }
 #ifndef NDEBUG
   if( yyTraceFILE ){
     int i;
     fprintf(yyTraceFILE,"%sReturn. Stack=",yyTracePrompt);
+#ifdef YYSTACKSEGMENTED
+    /* Only the topmost segment is shown */
+    i = yypParser->yystkbase>1 ? yypParser->yystkbase : 1;
+    if( i>1 ) fprintf(yyTraceFILE,"[...");
+    for(; i<=yypParser->yyidx; i++)
+      fprintf(yyTraceFILE,"%c%s", i==1 ? '[' : ' ', 
+              yyTokenName[yypParser->yystack[i-yypParser->yystkbase].major]);
+#else
     for(i=1; i<=yypParser->yyidx; i++)
       fprintf(yyTraceFILE,"%c%s", i==1 ? '[' : ' ', 
               yyTokenName[yypParser->yystack[i].major]);
+#endif
     fprintf(yyTraceFILE,"]\n");
   }
 #endif
   return;
 }
+
+#ifdef YYPROFILE
+/*
+** Append the counters of the profile of a parser to the file out, as
+** text that "lemon -M" reads.  States and rules are written under the
+** numbers lemon gave them before it optimized the tables, so that the
+** profile fits any build of the same grammar.  Zero counters are left
+** out.  Return non-zero if the file could not be written.
+*/
+int ParseProfile(void *p, FILE *out){
+  yyProfile *pProf = &((yyParser*)p)->yyprof;
+  int i;
+  fprintf(out, "lemon-profile %d %d\n", YYNOCODE, YYNRULE);
+  for(i=0; i<YYNSTATE; i++){
+    if( pProf->aShift[i]==0 && pProf->aGoto[i]==0 ) continue;
+    fprintf(out, "state %d %lu %lu\n", (int)yyProfileState[i],
+            pProf->aShift[i], pProf->aGoto[i]);
+  }
+  for(i=0; i<YYNRULE; i++){
+    if( pProf->aReduce[i]==0 ) continue;
+    fprintf(out, "rule %d %lu\n", (int)yyProfileRule[i], pProf->aReduce[i]);
+  }
+  for(i=0; i<YYNOCODE; i++){
+    if( pProf->aFallback[i] ){
+      fprintf(out, "fallback %d %lu\n", i, pProf->aFallback[i]);
+    }
+    if( pProf->aWildcard[i] ){
+      fprintf(out, "wildcard %d %lu\n", i, pProf->aWildcard[i]);
+    }
+  }
+  fprintf(out, "parses %lu %lu %lu\n",
+          pProf->nAccept, pProf->nFail, pProf->nOverflow);
+  fprintf(out, "errors %lu %lu %lu\n",
+          pProf->nError, pProf->nErrorShift, pProf->nDiscard);
+  for(i=0; i<YYPROFILEDEPTHS; i++){
+    if( pProf->aDepth[i] ) fprintf(out, "depth %d %lu\n", i, pProf->aDepth[i]);
+  }
+  fprintf(out, "end\n");
+  return ferror(out)!=0;
+}
+#endif /* YYPROFILE */
+
+#ifdef YYPIPELINE
+/*
+** A pipeline runs a parser on a thread of its own, fed by the thread that
+** reads the input through a ring of tokens.  The ring has a single
+** producer and a single consumer, so neither side takes a lock: each
+** owns one of the two indices and only reads the other.  Each side keeps
+** its own copy of the index of the other side and reloads it only when
+** the ring looks full or empty.  The indices are on separate cache lines.
+** The parser thread takes all the tokens that are ready at once and
+** hands their slots back in batches.  When the ring stays empty for a
+** while, the parser thread raises the "sleeping" flag and waits on a
+** condition variable.  The reader only takes the mutex to wake it when
+** it sees that flag, so pushing a token takes no lock and no fence.
+*/
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <time.h>
+#ifndef YYPIPELINESIZE
+# define YYPIPELINESIZE 4096
+#endif
+#if (YYPIPELINESIZE & (YYPIPELINESIZE-1))!=0
+# error "YYPIPELINESIZE must be a power of two"
+#endif
+#ifndef YYPIPELINESPIN
+# define YYPIPELINESPIN 100
+#endif
+#define YYPIPELINEWAIT 1000000  /* Nanoseconds of the first sleep */
+#define YYPIPELINEBATCH 64    /* Slots handed back at a time, at most */
+typedef struct yyPipeToken yyPipeToken;
+struct yyPipeToken {
+  int major;                    /* The major token code number */
+#ifdef YYTOKENHANDLE
+  unsigned int minor;           /* The handle of the token */
+#elif !defined(YYRECOGNIZER)
+  ParseTOKENTYPE minor;         /* The value of the token */
+#endif
+};
+typedef struct yyPipeline yyPipeline;
+struct yyPipeline {
+  atomic_uint iHead;            /* Tokens pushed.  Written by the reader */
+  unsigned int iTailSeen;       /* The reader's copy of iTail */
+  char aPad1[64];
+  atomic_uint iTail;            /* Tokens parsed.  Written by the parser */
+  unsigned int iHeadSeen;       /* The parser's copy of iHead */
+  char aPad2[64];
+  void *pParser;                /* The parser the tokens are passed to */
+  ParseARG_SDECL                /* The %extra_argument for Parse() */
+  pthread_t thread;             /* The thread that runs the parser */
+  int noThread;                 /* True if the thread could not start */
+  atomic_int sleeping;          /* True while the parser thread sleeps */
+  pthread_mutex_t mutex;        /* Held to go to sleep or to wake up */
+  pthread_cond_t cond;          /* Signaled when a token is pushed */
+  yyPipeToken a[YYPIPELINESIZE];  /* The ring of tokens */
+};
+
+/*
+** The body of the parser thread.  It returns after passing the end of
+** input to Parse().
+*/
+static void *yyPipelineMain(void *pArg){
+  yyPipeline *yypParser = (yyPipeline*)pArg;
+  unsigned int iTail = atomic_load_explicit(&yypParser->iTail,
+                                            memory_order_relaxed);
+  int nSpin = 0;
+  ParseARG_FETCH;
+  for(;;){
+    unsigned int iHead = yypParser->iHeadSeen;
+    if( iHead==iTail ){
+      iHead = atomic_load_explicit(&yypParser->iHead, memory_order_acquire);
+      if( iHead==iTail && nSpin<YYPIPELINESPIN ){
+        nSpin++;
+        sched_yield();
+        continue;
+      }
+      if( iHead==iTail ){
+        /* The reader does not fence its store of iHead from its load of
+        ** the flag, so a token pushed just as the flag goes up may not
+        ** wake this thread.  The first wait is therefore short.  Any
+        ** later push sees the flag, which has been up since then. */
+        struct timespec ts;
+        int nWait = 0;
+        pthread_mutex_lock(&yypParser->mutex);
+        atomic_store(&yypParser->sleeping, 1);
+        while( (iHead = atomic_load(&yypParser->iHead))==iTail ){
+          if( nWait++==0 ){
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_nsec += YYPIPELINEWAIT;
+            if( ts.tv_nsec>=1000000000 ){
+              ts.tv_sec++;
+              ts.tv_nsec -= 1000000000;
+            }
+            pthread_cond_timedwait(&yypParser->cond, &yypParser->mutex, &ts);
+          }else{
+            pthread_cond_wait(&yypParser->cond, &yypParser->mutex);
+          }
+        }
+        atomic_store_explicit(&yypParser->sleeping, 0, memory_order_relaxed);
+        pthread_mutex_unlock(&yypParser->mutex);
+      }
+      nSpin = 0;
+      yypParser->iHeadSeen = iHead;
+    }
+    while( iTail!=iHead ){
+      yyPipeToken *pTok = &yypParser->a[iTail & (YYPIPELINESIZE-1)];
+      int yymajor = pTok->major;
+      Parse(yypParser->pParser, yymajor
+#ifndef YYRECOGNIZER
+            , pTok->minor
+#endif
+            ParseARG_PARAM);
+      iTail++;
+      if( yymajor==0 ){
+        atomic_store_explicit(&yypParser->iTail, iTail, memory_order_release);
+        return 0;
+      }
+      if( (iTail & (YYPIPELINEBATCH-1))==0 ){
+        atomic_store_explicit(&yypParser->iTail, iTail, memory_order_release);
+      }
+    }
+    atomic_store_explicit(&yypParser->iTail, iTail, memory_order_release);
+  }
+}
+
+/*
+** Start a thread that runs the parser p on the tokens given to
+** ParsePipelinePush(), passing them to Parse() with the %extra_argument
+** given here.  The actions of the grammar run on that thread.  The
+** pipeline is allocated with mallocProc, as for ParseAlloc().  Return
+** NULL if out of memory.  If the thread cannot be started, the tokens
+** are passed to Parse() by ParsePipelinePush() on the calling thread.
+*/
+void *ParsePipelineStart(
+  void *p,                                  /* The parser to run */
+  void *(*mallocProc)(YYMALLOCARGTYPE)      /* Allocator for the pipeline */
+  ParseARG_PDECL                            /* The %extra_argument */
+){
+  yyPipeline *yypParser;
+  yypParser = (yyPipeline*)(*mallocProc)( (YYMALLOCARGTYPE)sizeof(yyPipeline) );
+  if( yypParser==0 ) return 0;
+  atomic_init(&yypParser->iHead, 0);
+  atomic_init(&yypParser->iTail, 0);
+  yypParser->iTailSeen = 0;
+  yypParser->iHeadSeen = 0;
+  yypParser->pParser = p;
+  ParseARG_STORE;
+  atomic_init(&yypParser->sleeping, 0);
+  pthread_mutex_init(&yypParser->mutex, 0);
+  pthread_cond_init(&yypParser->cond, 0);
+  yypParser->noThread = pthread_create(&yypParser->thread, 0,
+                                       yyPipelineMain, yypParser)!=0;
+  return yypParser;
+}
+
+/*
+** Hand a token over to the parser thread.  This only waits when the ring
+** is full, until the parser has caught up, and only takes a lock to wake
+** the parser thread when it sleeps.  The last token pushed must be the
+** end of input, with major number 0.
+*/
+void ParsePipelinePush(
+  void *pPipe,                 /* The pipeline */
+  int yymajor                  /* The major token code number */
+  YYMINOR_PDECL                /* The value for the token */
+){
+  yyPipeline *pPipeline = (yyPipeline*)pPipe;
+  unsigned int iHead = atomic_load_explicit(&pPipeline->iHead,
+                                            memory_order_relaxed);
+  yyPipeToken *pTok;
+  if( pPipeline->noThread ){
+    yyPipeline *yypParser = pPipeline;
+    ParseARG_FETCH;
+    Parse(yypParser->pParser, yymajor
+#ifndef YYRECOGNIZER
+          , yyminor
+#endif
+          ParseARG_PARAM);
+    return;
+  }
+  while( iHead - pPipeline->iTailSeen>=YYPIPELINESIZE ){
+    pPipeline->iTailSeen = atomic_load_explicit(&pPipeline->iTail,
+                                                memory_order_acquire);
+    if( iHead - pPipeline->iTailSeen>=YYPIPELINESIZE ) sched_yield();
+  }
+  pTok = &pPipeline->a[iHead & (YYPIPELINESIZE-1)];
+  pTok->major = yymajor;
+#ifndef YYRECOGNIZER
+  pTok->minor = yyminor;
+#endif
+  atomic_store_explicit(&pPipeline->iHead, iHead+1, memory_order_release);
+  if( atomic_load_explicit(&pPipeline->sleeping, memory_order_relaxed) ){
+    pthread_mutex_lock(&pPipeline->mutex);
+    pthread_cond_signal(&pPipeline->cond);
+    pthread_mutex_unlock(&pPipeline->mutex);
+  }
+}
+
+/*
+** Wait until the parser thread has passed the end of input to Parse(),
+** so that the accept or failure code of the grammar has run, and release
+** the pipeline with freeProc, as for ParseFree().  The parser itself is
+** left to the caller.
+*/
+void ParsePipelineFinish(
+  void *pPipe,                 /* The pipeline */
+  void (*freeProc)(void*)      /* Function used to reclaim memory */
+){
+  yyPipeline *pPipeline = (yyPipeline*)pPipe;
+  if( !pPipeline->noThread ) pthread_join(pPipeline->thread, 0);
+  pthread_cond_destroy(&pPipeline->cond);
+  pthread_mutex_destroy(&pPipeline->mutex);
+  (*freeProc)(pPipeline);
+}
+#endif /* YYPIPELINE */
+
+#ifdef YYSYNCSTATE
+/*
+** A parallel parse splits an array of tokens into chunks just after
+** %sync tokens and parses the chunks at the same time on several
+** threads, each thread with a parser of its own.  Lemon has proven that
+** after a %sync token the stack always comes back to state 0 with state
+** YYSYNCSTATE on it, so a chunk other than the first is parsed from a
+** stack that holds only those two entries, and each chunk leaves just
+** those two entries behind once the first token of the next chunk has
+** been seen.  The YYSYNCMAJOR values the chunks leave are merged in
+** input order and the last chunk is parsed on top of them, followed by
+** the end of input.
+*/
+#include <pthread.h>
+#define YYPARALLELCHUNKS 4    /* Chunks per thread, for load balance */
+typedef struct yyParallelChunk yyParallelChunk;
+struct yyParallelChunk {
+  ParseARG_SDECL                /* The %extra_argument.  Must be first */
+  int iFirst;                   /* Index of the first token of the chunk */
+  int nToken;                   /* Number of tokens in the chunk */
+  int done;                     /* True when the chunk has been parsed */
+  int rc;                       /* Non-zero if the chunk ran out of memory */
+#ifndef YYRECOGNIZER
+  int hasValue;                 /* True if the chunk left a value */
+  YYMINORTYPE value;            /* The YYSYNCMAJOR value it left */
+#endif
+};
+typedef struct yyParallel yyParallel;
+struct yyParallel {
+  pthread_mutex_t mutex;        /* Guards iNext and the done flags */
+  pthread_cond_t cond;          /* Signaled when a chunk is done */
+  int iNext;                    /* The next chunk to be parsed */
+  int nChunk;                   /* Number of chunks */
+  yyParallelChunk *aChunk;      /* The chunks, in input order */
+  const int *aMajor;            /* Major token numbers of the input */
+#ifndef YYRECOGNIZER
+  ParseTOKENTYPE *aMinor;       /* Values of the tokens of the input */
+#endif
+  void (*xStart)(void*,int,int,int,void*);  /* Called before each chunk */
+  void *pCtx;                   /* First argument to xStart and xDone */
+};
+typedef struct yyParallelWorker yyParallelWorker;
+struct yyParallelWorker {
+  yyParallel *pPar;             /* The parse this worker is part of */
+  void *pParser;                /* The parser of this worker */
+  pthread_t thread;             /* The thread of this worker */
+};
+#ifndef YYRECOGNIZER
+static const YYMINORTYPE yyParallelZero;
+#endif
+
+/*
+** Set up the stack of a parser as it is just after a %sync token.  The
+** value of the YYSYNCMAJOR entry is all zero bytes.  Return non-zero if
+** out of memory.
+*/
+static int yyParallelRestart(yyParser *p){
+  while( p->yyidx>=0 ) yy_pop_parser_stack(p);
+  if( yyPushEntry(p) ) return 1;
+  yyStackTop(p)->stateno = 0;
+  yyStackTop(p)->major = 0;
+  if( yyPushEntry(p) ){
+    while( p->yyidx>=0 ) yy_pop_parser_stack(p);
+    return 1;
+  }
+  yyStackTop(p)->stateno = YYSYNCSTATE;
+  yyStackTop(p)->major = YYSYNCMAJOR;
+#ifndef YYRECOGNIZER
+  *yyMinorTop(p) = yyParallelZero;
+#endif
+#ifndef YYNOERRORRECOVERY
+  p->yyerrcnt = -1;
+#endif
+  return 0;
+}
+
+/*
+** Make the reductions that the look-ahead token yymajor calls for, but
+** do not shift it.  Unless there was a syntax error, this leaves state
+** YYSYNCSTATE on top of state 0.
+*/
+static void yyParallelFlush(yyParser *p, int yymajor){
+  while( p->yyidx>0
+      && (p->yyidx>1 || yyStackTop(p)->stateno!=YYSYNCSTATE) ){
+    unsigned int yyact = yy_find_shift_action(p, (YYCODETYPE)yymajor);
+    if( yyact<YY_MIN_REDUCE || yyact>YY_MAX_REDUCE ) break;
+    yy_reduce(p, yyact-YY_MIN_REDUCE);
+  }
+}
+
+/*
+** Hand the tokens of chunk yypParser to parser p, followed by the end of
+** input if bEnd is true.
+*/
+static void yyParallelTokens(
+  yyParallel *pPar,
+  void *p,
+  yyParallelChunk *yypParser,
+  int bEnd
+){
+  int i;
+  ParseARG_FETCH;
+  for(i=yypParser->iFirst; i<yypParser->iFirst+yypParser->nToken; i++){
+#if defined(YYTOKENHANDLE)
+    Parse(p, pPar->aMajor[i], (unsigned int)i ParseARG_PARAM);
+#elif !defined(YYRECOGNIZER)
+    Parse(p, pPar->aMajor[i], pPar->aMinor[i] ParseARG_PARAM);
+#else
+    Parse(p, pPar->aMajor[i] ParseARG_PARAM);
+#endif
+  }
+  if( bEnd ){
+#if defined(YYTOKENHANDLE)
+    Parse(p, 0, 0 ParseARG_PARAM);
+#elif !defined(YYRECOGNIZER)
+    Parse(p, 0, yyParallelZero.yy0 ParseARG_PARAM);
+#else
+    Parse(p, 0 ParseARG_PARAM);
+#endif
+  }
+}
+
+#ifndef YYRECOGNIZER
+/*
+** Give parser p the %extra_argument of chunk yypParser, for the
+** destructors it calls outside of Parse().
+*/
+static void yyParallelArg(yyParser *p, yyParallelChunk *yypParser){
+  ParseARG_FETCH;
+  {
+    yyParser *yypParser = p;
+    ParseARG_STORE;
+    (void)yypParser;
+  }
+}
+#endif
+
+/*
+** The body of a worker thread.  It parses chunks until there are none
+** left but the last, and takes the YYSYNCMAJOR value each one leaves.
+*/
+static void *yyParallelMain(void *pArg){
+  yyParallelWorker *pWorker = (yyParallelWorker*)pArg;
+  yyParallel *pPar = pWorker->pPar;
+  yyParser *p = (yyParser*)pWorker->pParser;
+  for(;;){
+    yyParallelChunk *pChunk;
+    int iChunk;
+    pthread_mutex_lock(&pPar->mutex);
+    iChunk = pPar->iNext++;
+    pthread_mutex_unlock(&pPar->mutex);
+    if( iChunk>=pPar->nChunk-1 ) return 0;
+    pChunk = &pPar->aChunk[iChunk];
+    pPar->xStart(pPar->pCtx, iChunk, pChunk->iFirst, pChunk->nToken,
+                 (void*)pChunk);
+    if( iChunk>0 && yyParallelRestart(p) ){
+      pChunk->rc = 1;
+    }else{
+      yyParallelTokens(pPar, p, pChunk, 0);
+      yyParallelFlush(p, pPar->aMajor[pChunk[1].iFirst]);
+      if( p->yyidx==1 && yyStackTop(p)->stateno==YYSYNCSTATE ){
+#ifndef YYRECOGNIZER
+        pChunk->value = *yyMinorTop(p);
+        pChunk->hasValue = 1;
+        yyDropStack(p);
+#endif
+      }
+      while( p->yyidx>=0 ) yy_pop_parser_stack(p);
+    }
+    pthread_mutex_lock(&pPar->mutex);
+    pChunk->done = 1;
+    pthread_cond_broadcast(&pPar->cond);
+    pthread_mutex_unlock(&pPar->mutex);
+  }
+}
+
+/*
+** Parse the nToken tokens of aMajor[] (and their values in aMinor[]) on
+** nThread threads.  The end of input is not part of the array.
+**
+** The tokens are split into chunks, each of which but the last ends just
+** after a %sync token.  A chunk other than the first starts as if all the
+** input before it had been reduced to the symbol YYSYNCMAJOR, with a
+** value of all zero bytes, so the rules that build that symbol must take
+** a zero value as empty.  Each chunk but the last is reduced to a
+** YYSYNCMAJOR value of its own.  On the calling thread and in input
+** order, xMerge(pCtx, pLeft, pRight) merges each of these values into
+** the one before: pLeft and pRight point to values of the type of
+** YYSYNCMAJOR, and xMerge takes over pRight.  The last chunk is then
+** parsed on top of the merged value, followed by the end of input, so
+** the accept code runs once, as it does for Parse().  A syntax error is
+** reported in the chunk where it occurs, but its error recovery cannot
+** reach into the chunk before, and a chunk that it leaves in some other
+** state adds no value.
+**
+** Before a chunk is parsed, xStart(pCtx, iChunk, iFirst, nToken, pArg)
+** is called on the thread that parses it and must write the
+** %extra_argument for that chunk into *pArg.  When a chunk is done,
+** xDone(pCtx, iChunk, pArg) is called on the calling thread, in the order
+** of the chunks, so its results can be merged in input order.  Token
+** handles, with -t, are indices into aMinor[].  Return non-zero if out
+** of memory, in which case some chunks may not have been parsed.
+*/
+int ParseParallel(
+  void *(*mallocProc)(YYMALLOCARGTYPE),  /* Allocates the parsers */
+  void (*freeProc)(void*),               /* Releases them */
+  const int *aMajor,                     /* Major token numbers */
+#ifndef YYRECOGNIZER
+  ParseTOKENTYPE *aMinor,                /* Values of the tokens */
+#endif
+  int nToken,                            /* Number of tokens */
+  int nThread,                           /* Number of threads to use */
+  void (*xStart)(void*,int,int,int,void*),  /* Sets up a chunk */
+  void (*xDone)(void*,int,void*),        /* Takes the result of a chunk */
+#ifndef YYRECOGNIZER
+  void (*xMerge)(void*,void*,void*),     /* Merges YYSYNCMAJOR values */
+#endif
+  void *pCtx                             /* First argument to the above */
+){
+  yyParallel par;
+  yyParallelWorker *aWorker;
+  yyParallelChunk *pLast;
+  yyParser *pParser;
+  int nTarget, nStarted, nWorker, i, iFirst, rc = 0;
+#ifndef YYRECOGNIZER
+  YYMINORTYPE merged = yyParallelZero;
+  int hasMerged = 0;
+#endif
+
+  if( nThread<1 ) nThread = 1;
+  nTarget = nToken/(nThread*YYPARALLELCHUNKS);
+  if( nTarget<1 ) nTarget = 1;
+
+  /* Split the input just after %sync tokens, into chunks of at least
+  ** nTarget tokens where it can */
+  par.nChunk = 1;
+  for(i=0, iFirst=0; i<nToken-1; i++){
+    if( aMajor[i]==YYSYNCTOKEN && i+1-iFirst>=nTarget ){
+      par.nChunk++;
+      iFirst = i+1;
+    }
+  }
+  par.aChunk = (yyParallelChunk*)(*mallocProc)(
+                  (YYMALLOCARGTYPE)(par.nChunk*sizeof(yyParallelChunk)) );
+  aWorker = (yyParallelWorker*)(*mallocProc)(
+                  (YYMALLOCARGTYPE)(nThread*sizeof(yyParallelWorker)) );
+  if( par.aChunk==0 || aWorker==0 ){
+    if( par.aChunk ) (*freeProc)(par.aChunk);
+    if( aWorker ) (*freeProc)(aWorker);
+    return 1;
+  }
+  par.nChunk = 0;
+  for(i=0, iFirst=0; i<nToken; i++){
+    if( i==nToken-1 || (aMajor[i]==YYSYNCTOKEN && i+1-iFirst>=nTarget) ){
+      par.aChunk[par.nChunk++].iFirst = iFirst;
+      iFirst = i+1;
+    }
+  }
+  if( par.nChunk==0 ) par.aChunk[par.nChunk++].iFirst = 0;
+  for(i=0; i<par.nChunk; i++){
+    yyParallelChunk *pChunk = &par.aChunk[i];
+    pChunk->nToken = (i<par.nChunk-1 ? pChunk[1].iFirst : nToken)
+                     - pChunk->iFirst;
+    pChunk->done = 0;
+    pChunk->rc = 0;
+#ifndef YYRECOGNIZER
+    pChunk->hasValue = 0;
+#endif
+  }
+  par.iNext = 0;
+  par.aMajor = aMajor;
+#ifndef YYRECOGNIZER
+  par.aMinor = aMinor;
+#endif
+  par.xStart = xStart;
+  par.pCtx = pCtx;
+
+  /* Start the workers for all the chunks but the last.  If no thread
+  ** can be started, the calling thread parses them itself */
+  if( nThread>par.nChunk-1 ) nThread = par.nChunk-1;
+  if( nThread<1 ) nThread = 1;
+  for(nWorker=0; nWorker<nThread; nWorker++){
+    aWorker[nWorker].pPar = &par;
+    aWorker[nWorker].pParser = ParseAlloc(mallocProc);
+    if( aWorker[nWorker].pParser==0 ) break;
+#ifdef YYTOKENHANDLE
+    ParseTokens(aWorker[nWorker].pParser, aMinor);
+#endif
+  }
+  if( nWorker==0 ){
+    (*freeProc)(aWorker);
+    (*freeProc)(par.aChunk);
+    return 1;
+  }
+  pthread_mutex_init(&par.mutex, 0);
+  pthread_cond_init(&par.cond, 0);
+  nStarted = 0;
+  if( par.nChunk>1 ){
+    for(; nStarted<nWorker; nStarted++){
+      if( pthread_create(&aWorker[nStarted].thread, 0, yyParallelMain,
+                         &aWorker[nStarted]) ){
+        break;
+      }
+    }
+    if( nStarted==0 ) yyParallelMain(&aWorker[0]);
+  }
+
+  /* Hand the chunks over to xDone and merge their values, in input
+  ** order */
+  for(i=0; i<par.nChunk-1; i++){
+    yyParallelChunk *pChunk = &par.aChunk[i];
+    pthread_mutex_lock(&par.mutex);
+    while( !pChunk->done ){
+      pthread_cond_wait(&par.cond, &par.mutex);
+    }
+    pthread_mutex_unlock(&par.mutex);
+    if( pChunk->rc ) rc = 1;
+    xDone(pCtx, i, (void*)pChunk);
+#ifndef YYRECOGNIZER
+    if( pChunk->hasValue ){
+      if( hasMerged ){
+        xMerge(pCtx, (void*)&merged, (void*)&pChunk->value);
+      }else{
+        merged = pChunk->value;
+        hasMerged = 1;
+      }
+    }
+#endif
+  }
+  for(i=0; i<nStarted; i++) pthread_join(aWorker[i].thread, 0);
+
+  /* Parse the last chunk on top of the merged value, and end the input */
+  pLast = &par.aChunk[par.nChunk-1];
+  pParser = (yyParser*)aWorker[0].pParser;
+  xStart(pCtx, par.nChunk-1, pLast->iFirst, pLast->nToken, (void*)pLast);
+  if( par.nChunk>1 && yyParallelRestart(pParser) ){
+    rc = pLast->rc = 1;
+#ifndef YYRECOGNIZER
+    if( hasMerged ){
+      yyParallelArg(pParser, pLast);
+      yy_destructor(pParser, (YYCODETYPE)YYSYNCMAJOR, &merged);
+    }
+#endif
+  }else{
+#ifndef YYRECOGNIZER
+    if( hasMerged ) *yyMinorTop(pParser) = merged;
+#endif
+    yyParallelTokens(&par, pParser, pLast, 1);
+  }
+  xDone(pCtx, par.nChunk-1, (void*)pLast);
+
+  for(i=0; i<nWorker; i++) ParseFree(aWorker[i].pParser, freeProc);
+  pthread_cond_destroy(&par.cond);
+  pthread_mutex_destroy(&par.mutex);
+  (*freeProc)(aWorker);
+  (*freeProc)(par.aChunk);
+  return rc;
+}
+#endif /* YYSYNCSTATE */
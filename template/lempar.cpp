@@ -0,0 +1,956 @@
+/*
+** 2000-05-29
+**
+** The author disclaims copyright to this source code.  In place of
+** a legal notice, here is a blessing:
+**
+**    May you do good and not evil.
+**    May you find forgiveness for yourself and forgive others.
+**    May you share freely, never taking more than you give.
+**
+*************************************************************************
+** C++17 driver template for the LEMON parser generator.
+**
+** The "lemon" program uses this template in place of lempar.c when it is
+** run with the "-C" option.  The parser works as the one of lempar.c,
+** but the semantic values may be of any C++ type that can be default
+** constructed and move constructed, such as std::string or
+** std::unique_ptr.  Each value on the stack is constructed as the member
+** of YYMINORTYPE that belongs to its symbol and is destroyed when it
+** leaves the stack.  The value of the left-hand side of a rule is moved
+** into the stack, and a label shared by the left-hand side and the
+** left-most symbol of the right-hand side hands the value over in place.
+** The actions and destructors must not throw.
+**
+** As in lempar.c, "lemon" inserts text at each "%%" line and changes any
+** "P-a-r-s-e" identifier prefix (without the interstitial "-" characters)
+** into the value of the %name directive from the grammar.
+**
+** The following is the concatenation of all %include directives from the
+** input grammar file:
+*/
+#include <array>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <utility>
+/************ Begin %include sections from the grammar ************************/
+%%
+/**************** End of %include directives **********************************/
+/* These constants specify the various numeric values for terminal symbols
+** in a format understandable to "makeheaders".  This section is blank unless
+** "lemon" is run with the "-m" command-line option.
+***************** Begin makeheaders token definitions *************************/
+%%
+/**************** End makeheaders token definitions ***************************/
+
+/* The next sections is a series of control #defines.  Their meaning is
+** described in lempar.c.  YYMINORTYPE is a union with a member for each
+** type of value, and yyVisitValue() calls a function object with the
+** member that holds the value of a given symbol.  Of the options that
+** lempar.c takes from the %include section, YYSTACKDEPTH,
+** YYTRACKMAXSTACKDEPTH, YYNOERRORRECOVERY, YYLAZYREDUCE, YYMALLOCARGTYPE
+** and YYPARSEFREENEVERNULL apply here as well.
+*/
+#ifndef INTERFACE
+# define INTERFACE 1
+#endif
+/************* Begin control #defines *****************************************/
+%%
+/************* End control #defines *******************************************/
+
+/* Define the yytestcase() macro to be a no-op if is not already defined
+** otherwise.
+*/
+#ifndef yytestcase
+# define yytestcase(X)
+#endif
+
+/* The operations on a single value that the reduce actions use.  The
+** type of the value is that of the member of YYMINORTYPE passed in.
+*/
+template<class T> static inline void yyConstructAt(T &v){
+  ::new((void*)&v) T();
+}
+template<class T> static inline void yyDestroyAt(T &v){
+  v.~T();
+}
+template<class T> static inline void yyMoveInto(T &to, T &from){
+  ::new((void*)&to) T(std::move(from));
+  from.~T();
+}
+
+/* Function objects for yyVisitValue() */
+struct yyDestroyValue {
+  template<class T> void operator()(T &v) const { v.~T(); }
+};
+struct yyRelocateValue {
+  void *pTo;                    /* Storage of the same member in another
+                                ** YYMINORTYPE */
+  template<class T> void operator()(T &v) const {
+    ::new(pTo) T(std::move(v));
+    v.~T();
+  }
+};
+
+/* The parsing tables.  They are laid out as described in lempar.c, as
+** constexpr std::array members of the struct yyTables.  The lookup
+** functions below take the struct as a template parameter, so that the
+** compiler sees the tables and their sizes as constants.
+*********** Begin parsing tables **********************************************/
+%%
+/********** End of lemon-generated parsing tables *****************************/
+
+#ifndef YYDIRECTCODED
+/*
+** Return true if the tables T are consistent: every table has the size
+** that the constants give it, every action is a valid action code and
+** every lookahead is a symbol code or YYNOCODE-1 for an unused entry.
+** This is evaluated at compile time.
+*/
+template<class T> static constexpr bool yyTablesOk(){
+  if( T::yy_action.size()!=YY_ACTTAB_COUNT ) return false;
+  if( T::yy_lookahead.size()!=YY_ACTTAB_COUNT ) return false;
+  if( T::yy_shift_ofst.size()!=YY_SHIFT_COUNT+1 ) return false;
+  if( T::yy_reduce_ofst.size()!=YY_REDUCE_COUNT+1 ) return false;
+  if( T::yy_default.size()!=YYNSTATE ) return false;
+  for(int i=0; i<YY_ACTTAB_COUNT; i++){
+    int a = T::yy_action[i];
+    if( a>YY_MAX_SHIFT && (a<YY_MIN_SHIFTREDUCE || a>YY_NO_ACTION) ){
+      return false;
+    }
+    if( T::yy_lookahead[i]>=YYNOCODE ) return false;
+  }
+  for(int i=0; i<YYNSTATE; i++){
+    int a = T::yy_default[i];
+    if( a<YY_MIN_REDUCE || a>YY_NO_ACTION ) return false;
+  }
+  for(int i=0; i<=YY_SHIFT_COUNT; i++){
+    int o = T::yy_shift_ofst[i];
+    if( o!=YY_SHIFT_USE_DFLT && (o<YY_SHIFT_MIN || o>YY_SHIFT_MAX) ){
+      return false;
+    }
+  }
+  for(int i=0; i<=YY_REDUCE_COUNT; i++){
+    int o = T::yy_reduce_ofst[i];
+    if( o!=YY_REDUCE_USE_DFLT && (o<YY_REDUCE_MIN || o>YY_REDUCE_MAX) ){
+      return false;
+    }
+  }
+  return true;
+}
+static_assert( yyTablesOk<yyTables>(), "inconsistent parsing tables" );
+#endif /* YYDIRECTCODED */
+
+/* A single element of the parser's stack.  See lempar.c.  The value in
+** "minor" is alive in every entry but the bottom one, as the member of
+** YYMINORTYPE that belongs to the symbol in "major".
+*/
+struct yyStackEntry {
+  YYACTIONTYPE stateno;  /* The state-number, or reduce action in SHIFTREDUCE */
+  YYCODETYPE major;      /* The major token value.  This is the code
+                         ** number for the token at this stack level */
+  YYMINORTYPE minor;     /* The user-supplied minor token value.  This
+                         ** is the value of the token  */
+};
+
+/* Datatype of the argument to the memory allocated passed as the
+** second argument to ParseAlloc() below.
+*/
+#ifndef YYMALLOCARGTYPE
+# define YYMALLOCARGTYPE size_t
+#endif
+
+/* The state of the parser is completely contained in an instance of
+** the following structure */
+struct yyParser {
+  int yyidx;                    /* Index of top element in stack */
+#ifdef YYTRACKMAXSTACKDEPTH
+  int yyidxMax;                 /* Maximum value of yyidx */
+#endif
+#ifndef YYNOERRORRECOVERY
+  int yyerrcnt;                 /* Shifts left before out of the error */
+#endif
+  ParseARG_SDECL                /* A place to hold %extra_argument */
+#if YYSTACKDEPTH<=0
+  int yystksz;                  /* Current side of the stack */
+  yyStackEntry *yystack;        /* The parser's stack */
+#else
+  yyStackEntry yystack[YYSTACKDEPTH];  /* The parser's stack */
+#endif
+};
+/************* Begin split parser declarations ********************************/
+%%
+/************* End split parser declarations **********************************/
+
+/* The next table maps tokens (terminal symbols) into fallback tokens.
+** See lempar.c.
+*/
+#if defined(YYFALLBACK) && !defined(YYNOFALLBACKRETRY)
+static const YYCODETYPE yyFallback[] = {
+%%
+};
+#endif /* YYFALLBACK */
+
+#ifndef NDEBUG
+static FILE *yyTraceFILE = 0;
+static char *yyTracePrompt = 0;
+#endif /* NDEBUG */
+
+#ifndef NDEBUG
+/*
+** Turn parser tracing on by giving a stream to which to write the trace
+** and a prompt to preface each trace message.  Tracing is turned off
+** by making either argument NULL.
+*/
+void ParseTrace(FILE *TraceFILE, char *zTracePrompt){
+  yyTraceFILE = TraceFILE;
+  yyTracePrompt = zTracePrompt;
+  if( yyTraceFILE==0 ) yyTracePrompt = 0;
+  else if( yyTracePrompt==0 ) yyTraceFILE = 0;
+}
+#endif /* NDEBUG */
+
+#ifndef NDEBUG
+/* For tracing shifts, the names of all terminals and nonterminals
+** are required.  The following table supplies these names */
+static const char *const yyTokenName[] = {
+%%
+};
+#endif /* NDEBUG */
+
+#ifndef NDEBUG
+/* For tracing reduce actions, the names of all rules are required.
+*/
+static const char *const yyRuleName[] = {
+%%
+};
+#endif /* NDEBUG */
+
+#if YYSTACKDEPTH<=0
+/*
+** Try to increase the size of the parser stack.  The values can not
+** simply be copied to the new stack, as realloc() would do: each one is
+** moved into its new place and destroyed in the old.
+*/
+static void yyGrowStack(yyParser *p){
+  int newSize;
+  int i;
+  yyStackEntry *pNew;
+
+  newSize = p->yystksz*2 + 100;
+  pNew = (yyStackEntry*)std::malloc(newSize*sizeof(pNew[0]));
+  if( pNew ){
+    for(i=0; i<newSize; i++) ::new((void*)&pNew[i]) yyStackEntry;
+    for(i=0; i<=p->yyidx; i++){
+      pNew[i].stateno = p->yystack[i].stateno;
+      pNew[i].major = p->yystack[i].major;
+      if( i>0 ){
+        yyVisitValue(p->yystack[i].major, &p->yystack[i].minor,
+                     yyRelocateValue{(void*)&pNew[i].minor});
+      }
+    }
+    std::free(p->yystack);
+    p->yystack = pNew;
+    p->yystksz = newSize;
+#ifndef NDEBUG
+    if( yyTraceFILE ){
+      fprintf(yyTraceFILE,"%sStack grows to %d entries!\n",
+              yyTracePrompt, p->yystksz);
+    }
+#endif
+  }
+}
+#endif
+
+/*
+** This function allocates a new parser.
+** The only argument is a pointer to a function which works like
+** malloc.
+*/
+void *ParseAlloc(void *(*mallocProc)(YYMALLOCARGTYPE)){
+  yyParser *pParser;
+  pParser = (yyParser*)(*mallocProc)( (YYMALLOCARGTYPE)sizeof(yyParser) );
+  if( pParser ){
+    ::new((void*)pParser) yyParser;
+    pParser->yyidx = -1;
+#ifdef YYTRACKMAXSTACKDEPTH
+    pParser->yyidxMax = 0;
+#endif
+#if YYSTACKDEPTH<=0
+    pParser->yystack = NULL;
+    pParser->yystksz = 0;
+    yyGrowStack(pParser);
+#endif
+  }
+  return pParser;
+}
+
+/* The following function deletes the "minor type" or semantic value
+** associated with a symbol.  The code of the %destructor and/or
+** %token_destructor directives of the input grammar runs first, then
+** the C++ destructor of the value.
+*/
+static void yy_destructor(
+  yyParser *yypParser,    /* The parser */
+  YYCODETYPE yymajor,     /* Type code for object to destroy */
+  YYMINORTYPE *yypminor   /* The object to be destroyed */
+){
+  ParseARG_FETCH;
+  switch( yymajor ){
+/********* Begin destructor definitions ***************************************/
+%%
+/********* End destructor definitions *****************************************/
+    default:  break;   /* If no destructor action specified: do nothing */
+  }
+  yyVisitValue(yymajor, yypminor, yyDestroyValue());
+  ParseARG_STORE; /* Suppress warning about unused %extra_argument variable */
+}
+
+/*
+** Pop the parser's stack once, destroying the value of the entry.  The
+** bottom entry has no value.
+*/
+static void yy_pop_parser_stack(yyParser *pParser){
+  yyStackEntry *yytos;
+  assert( pParser->yyidx>=0 );
+  yytos = &pParser->yystack[pParser->yyidx];
+  pParser->yyidx--;
+#ifndef NDEBUG
+  if( yyTraceFILE ){
+    fprintf(yyTraceFILE,"%sPopping %s\n",
+      yyTracePrompt,
+      yyTokenName[yytos->major]);
+  }
+#endif
+  if( pParser->yyidx>=0 ){
+    yy_destructor(pParser, yytos->major, &yytos->minor);
+  }
+}
+
+/*
+** Deallocate and destroy a parser.  Destructors are called for
+** all stack elements before shutting the parser down.
+*/
+void ParseFree(
+  void *p,                    /* The parser to be deleted */
+  void (*freeProc)(void*)     /* Function used to reclaim memory */
+){
+  yyParser *pParser = (yyParser*)p;
+#ifndef YYPARSEFREENEVERNULL
+  if( pParser==0 ) return;
+#endif
+  while( pParser->yyidx>=0 ) yy_pop_parser_stack(pParser);
+#if YYSTACKDEPTH<=0
+  std::free(pParser->yystack);
+#endif
+  pParser->~yyParser();
+  (*freeProc)((void*)pParser);
+}
+
+/*
+** Return a parser to its initial state, ready for new input.  Destructors
+** are called for all stack elements.
+*/
+void ParseReset(void *p){
+  yyParser *pParser = (yyParser*)p;
+  while( pParser->yyidx>=0 ) yy_pop_parser_stack(pParser);
+}
+
+/*
+** Return the peak depth of the stack for a parser.
+*/
+#ifdef YYTRACKMAXSTACKDEPTH
+int ParseStackPeak(void *p){
+  yyParser *pParser = (yyParser*)p;
+  return pParser->yyidxMax;
+}
+#endif
+
+#ifdef YYDIRECTCODED
+/*
+** Find the appropriate action for a parser given the terminal
+** look-ahead token iLookAhead.  In a direct-coded parser the actions
+** are compiled into the yy_dc_shift() and yy_dc_goto() functions.
+*/
+static unsigned int yy_find_shift_action(
+  yyParser *pParser,        /* The parser */
+  YYCODETYPE iLookAhead     /* The look-ahead token */
+){
+  int stateno = pParser->yystack[pParser->yyidx].stateno;
+  if( stateno>=YY_MIN_REDUCE ) return stateno;
+  assert( stateno < YYNSTATE );
+  assert( iLookAhead!=YYNOCODE );
+  return yy_dc_shift(stateno, iLookAhead);
+}
+
+/*
+** Find the appropriate action for a parser given the non-terminal
+** look-ahead token iLookAhead.
+*/
+static int yy_find_reduce_action(
+  int stateno,              /* Current state number */
+  YYCODETYPE iLookAhead     /* The look-ahead token */
+){
+  assert( iLookAhead!=YYNOCODE );
+  return yy_dc_goto(stateno, iLookAhead);
+}
+#else /* !YYDIRECTCODED */
+/*
+** Find the appropriate action for a parser given the terminal
+** look-ahead token iLookAhead.
+*/
+template<class T = yyTables>
+static unsigned int yy_find_shift_action(
+  yyParser *pParser,        /* The parser */
+  YYCODETYPE iLookAhead     /* The look-ahead token */
+){
+  int i;
+  int stateno = pParser->yystack[pParser->yyidx].stateno;
+
+  if( stateno>=YY_MIN_REDUCE ) return stateno;
+  assert( stateno <= YY_SHIFT_COUNT );
+  do{
+    i = T::yy_shift_ofst[stateno];
+    if( i==YY_SHIFT_USE_DFLT ) return T::yy_default[stateno];
+    assert( iLookAhead!=YYNOCODE );
+    i += iLookAhead;
+    if( i<0 || i>=YY_ACTTAB_COUNT || T::yy_lookahead[i]!=iLookAhead ){
+#ifndef YYNOFALLBACKRETRY
+      if( iLookAhead>0 ){
+#ifdef YYFALLBACK
+        YYCODETYPE iFallback;            /* Fallback token */
+        if( iLookAhead<sizeof(yyFallback)/sizeof(yyFallback[0])
+               && (iFallback = yyFallback[iLookAhead])!=0 ){
+#ifndef NDEBUG
+          if( yyTraceFILE ){
+            fprintf(yyTraceFILE, "%sFALLBACK %s => %s\n",
+               yyTracePrompt, yyTokenName[iLookAhead], yyTokenName[iFallback]);
+          }
+#endif
+          assert( yyFallback[iFallback]==0 ); /* Fallback loop must terminate */
+          iLookAhead = iFallback;
+          continue;
+        }
+#endif
+#ifdef YYWILDCARD
+        {
+          int j = i - iLookAhead + YYWILDCARD;
+          if(
+#if YY_SHIFT_MIN+YYWILDCARD<0
+            j>=0 &&
+#endif
+#if YY_SHIFT_MAX+YYWILDCARD>=YY_ACTTAB_COUNT
+            j<YY_ACTTAB_COUNT &&
+#endif
+            T::yy_lookahead[j]==YYWILDCARD
+          ){
+#ifndef NDEBUG
+            if( yyTraceFILE ){
+              fprintf(yyTraceFILE, "%sWILDCARD %s => %s\n",
+                 yyTracePrompt, yyTokenName[iLookAhead],
+                 yyTokenName[YYWILDCARD]);
+            }
+#endif /* NDEBUG */
+            return T::yy_action[j];
+          }
+        }
+#endif /* YYWILDCARD */
+      }
+#endif /* YYNOFALLBACKRETRY */
+      return T::yy_default[stateno];
+    }else{
+      return T::yy_action[i];
+    }
+  }while(1);
+}
+
+/*
+** Find the appropriate action for a parser given the non-terminal
+** look-ahead token iLookAhead.
+*/
+template<class T = yyTables>
+static int yy_find_reduce_action(
+  int stateno,              /* Current state number */
+  YYCODETYPE iLookAhead     /* The look-ahead token */
+){
+  int i;
+#ifdef YYERRORSYMBOL
+  if( stateno>YY_REDUCE_COUNT ){
+    return T::yy_default[stateno];
+  }
+#else
+  assert( stateno<=YY_REDUCE_COUNT );
+#endif
+  i = T::yy_reduce_ofst[stateno];
+  assert( i!=YY_REDUCE_USE_DFLT );
+  assert( iLookAhead!=YYNOCODE );
+  i += iLookAhead;
+#ifdef YYERRORSYMBOL
+  if( i<0 || i>=YY_ACTTAB_COUNT || T::yy_lookahead[i]!=iLookAhead ){
+    return T::yy_default[stateno];
+  }
+#else
+  assert( i>=0 && i<YY_ACTTAB_COUNT );
+  assert( T::yy_lookahead[i]==iLookAhead );
+#endif
+  return T::yy_action[i];
+}
+#endif /* YYDIRECTCODED */
+
+/*
+** The following routine is called if the stack overflows.
+*/
+static void yyStackOverflow(yyParser *yypParser){
+   ParseARG_FETCH;
+#ifndef NDEBUG
+   if( yyTraceFILE ){
+     fprintf(yyTraceFILE,"%sStack Overflow!\n",yyTracePrompt);
+   }
+#endif
+   while( yypParser->yyidx>=0 ) yy_pop_parser_stack(yypParser);
+   /* Here code is inserted which will execute if the parser
+   ** stack every overflows */
+/******** Begin %stack_overflow code ******************************************/
+%%
+/******** End %stack_overflow code ********************************************/
+   ParseARG_STORE; /* Suppress warning about unused %extra_argument var */
+}
+
+/*
+** Print tracing information for a SHIFT action
+*/
+#ifndef NDEBUG
+static void yyTraceShift(yyParser *yypParser, int yyNewState){
+  if( yyTraceFILE ){
+    if( yyNewState<YYNSTATE ){
+      fprintf(yyTraceFILE,"%sShift '%s', go to state %d\n",
+         yyTracePrompt,yyTokenName[yypParser->yystack[yypParser->yyidx].major],
+         yyNewState);
+    }else{
+      fprintf(yyTraceFILE,"%sShift '%s'\n",
+         yyTracePrompt,yyTokenName[yypParser->yystack[yypParser->yyidx].major]);
+    }
+  }
+}
+#else
+# define yyTraceShift(X,Y)
+#endif
+
+/*
+** Push a new entry for a shift.  Its value is not yet constructed.
+** Return NULL after a stack overflow.
+*/
+static yyStackEntry *yy_push(
+  yyParser *yypParser,          /* The parser to be shifted */
+  int yyNewState,               /* The new state to shift in */
+  int yyMajor                   /* The major token to shift in */
+){
+  yyStackEntry *yytos;
+#if YYSTACKDEPTH>0
+  if( yypParser->yyidx>=YYSTACKDEPTH-1 ){
+    yyStackOverflow(yypParser);
+    return 0;
+  }
+#else
+  if( yypParser->yyidx>=yypParser->yystksz-1 ){
+    yyGrowStack(yypParser);
+    if( yypParser->yyidx>=yypParser->yystksz-1 ){
+      yyStackOverflow(yypParser);
+      return 0;
+    }
+  }
+#endif
+  yypParser->yyidx++;
+#ifdef YYTRACKMAXSTACKDEPTH
+  if( yypParser->yyidx>yypParser->yyidxMax ){
+    yypParser->yyidxMax = yypParser->yyidx;
+  }
+#endif
+  yytos = &yypParser->yystack[yypParser->yyidx];
+  yytos->stateno = (YYACTIONTYPE)yyNewState;
+  yytos->major = (YYCODETYPE)yyMajor;
+  return yytos;
+}
+
+/*
+** Perform a shift action.  The token is moved onto the stack.
+*/
+static void yy_shift(
+  yyParser *yypParser,          /* The parser to be shifted */
+  int yyNewState,               /* The new state to shift in */
+  int yyMajor,                  /* The major token to shift in */
+  ParseTOKENTYPE &yyminor       /* The minor token to shift in */
+){
+  yyStackEntry *yytos = yy_push(yypParser, yyNewState, yyMajor);
+  if( yytos ){
+    ::new((void*)&yytos->minor.yy0) ParseTOKENTYPE(std::move(yyminor));
+    yyTraceShift(yypParser, yyNewState);
+  }
+}
+
+/*
+** Run the destructors of a token that is thrown away.
+*/
+static void yy_discard_token(
+  yyParser *yypParser,          /* The parser */
+  int yymajor,                  /* The major token */
+  ParseTOKENTYPE &yyminor       /* The minor token */
+){
+  YYMINORTYPE yyminorunion;
+  ::new((void*)&yyminorunion.yy0) ParseTOKENTYPE(std::move(yyminor));
+  yy_destructor(yypParser, (YYCODETYPE)yymajor, &yyminorunion);
+}
+
+/* The following table contains information about every rule that
+** is used during the reduce.
+*/
+static const struct {
+  YYCODETYPE lhs;         /* Symbol on the left-hand side of the rule */
+  unsigned char nrhs;     /* Number of right-hand side symbols in the rule */
+} yyRuleInfo[] = {
+%%
+};
+
+static void yy_accept(yyParser*);  /* Forward Declaration */
+
+/* When YYREDUCEGOTO is defined, the reduce cases are labels reached
+** through a computed goto on compilers that support it, and ordinary
+** switch cases elsewhere.
+*/
+#if defined(YYREDUCEGOTO) && (defined(__GNUC__) || defined(__clang__))
+# define YYCOMPUTEDGOTO 1
+#endif
+#ifdef YYCOMPUTEDGOTO
+# define yyrulecase(N)  yyrule_##N
+# define yyruledone     goto yy_reduce_done
+#else
+# define yyrulecase(N)  case N
+# define yyruledone     break
+#endif
+/********** Begin reduce action functions *************************************/
+%%
+/********** End reduce action functions ***************************************/
+
+/*
+** Perform a reduce action and the shift that must immediately
+** follow the reduce.  The code of each rule destroys the values of the
+** right-hand side and leaves the value of the left-hand side in the
+** slot of the left-most of them.  The return value is as in lempar.c.
+*/
+static int yy_reduce(
+  yyParser *yypParser,         /* The parser */
+  unsigned int yyruleno        /* Number of the rule by which to reduce */
+){
+  int yygoto;                     /* The next state */
+  int yyact;                      /* The next action */
+  yyStackEntry *yymsp;            /* The top of the parser's stack */
+  int yysize;                     /* Amount to pop the stack */
+  ParseARG_FETCH;
+  yymsp = &yypParser->yystack[yypParser->yyidx];
+#ifndef NDEBUG
+  if( yyTraceFILE && yyruleno<(int)(sizeof(yyRuleName)/sizeof(yyRuleName[0])) ){
+    yysize = yyRuleInfo[yyruleno].nrhs;
+    fprintf(yyTraceFILE, "%sReduce [%s], go to state %d.\n", yyTracePrompt,
+      yyRuleName[yyruleno], yymsp[-yysize].stateno);
+  }
+#endif /* NDEBUG */
+
+  /* Check that the stack is large enough to grow by a single entry
+  ** if the RHS of the rule is empty.  This ensures that there is room
+  ** enough on the stack to push the LHS value */
+  if( yyRuleInfo[yyruleno].nrhs==0 ){
+#ifdef YYTRACKMAXSTACKDEPTH
+    if( yypParser->yyidx>yypParser->yyidxMax ){
+      yypParser->yyidxMax = yypParser->yyidx;
+    }
+#endif
+#if YYSTACKDEPTH>0
+    if( yypParser->yyidx>=YYSTACKDEPTH-1 ){
+      yyStackOverflow(yypParser);
+      return YY_NO_ACTION;
+    }
+#else
+    if( yypParser->yyidx>=yypParser->yystksz-1 ){
+      yyGrowStack(yypParser);
+      if( yypParser->yyidx>=yypParser->yystksz-1 ){
+        yyStackOverflow(yypParser);
+        return YY_NO_ACTION;
+      }
+      yymsp = &yypParser->yystack[yypParser->yyidx];
+    }
+#endif
+  }
+
+#if defined(YYCOMPUTEDGOTO)
+  {
+#else
+  switch( yyruleno ){
+#endif
+  /* Beginning here are the reduction cases.  A typical example
+  ** follows:
+  **   case 0: {
+  **     YYMINORTYPE yylhsminor;
+  **     yyConstructAt(yylhsminor.yy1);
+  **  #line <lineno> <grammarfile>
+  **     { ... }           // User supplied code
+  **  #line <lineno> <thisfile>
+  **     yyDestroyAt(yymsp[0].minor.yy0);
+  **     yyMoveInto(yymsp[0].minor.yy1, yylhsminor.yy1);
+  **   }
+  **     break;
+  */
+/********** Begin reduce actions **********************************************/
+%%
+/********** End reduce actions ************************************************/
+#if defined(YYCOMPUTEDGOTO)
+  }
+yy_reduce_done:
+#else
+  };
+#endif
+  assert( yyruleno<sizeof(yyRuleInfo)/sizeof(yyRuleInfo[0]) );
+  yygoto = yyRuleInfo[yyruleno].lhs;
+  yysize = yyRuleInfo[yyruleno].nrhs;
+  yyact = yy_find_reduce_action(yymsp[-yysize].stateno,(YYCODETYPE)yygoto);
+  if( yyact <= YY_MAX_SHIFTREDUCE ){
+    if( yyact>YY_MAX_SHIFT ) yyact += YY_MIN_REDUCE - YY_MIN_SHIFTREDUCE;
+    yypParser->yyidx -= yysize - 1;
+    yymsp -= yysize-1;
+    yymsp->stateno = (YYACTIONTYPE)yyact;
+    yymsp->major = (YYCODETYPE)yygoto;
+    yyTraceShift(yypParser, yyact);
+  }else{
+    assert( yyact == YY_ACCEPT_ACTION );
+    /* The value of the start symbol is not kept */
+    yyVisitValue(yygoto, &yymsp[1-yysize].minor, yyDestroyValue());
+    yypParser->yyidx -= yysize;
+    yy_accept(yypParser);
+  }
+  return yyact;
+}
+
+/*
+** The following code executes when the parse fails
+*/
+#ifndef YYNOERRORRECOVERY
+static void yy_parse_failed(
+  yyParser *yypParser           /* The parser */
+){
+  ParseARG_FETCH;
+#ifndef NDEBUG
+  if( yyTraceFILE ){
+    fprintf(yyTraceFILE,"%sFail!\n",yyTracePrompt);
+  }
+#endif
+  while( yypParser->yyidx>=0 ) yy_pop_parser_stack(yypParser);
+  /* Here code is inserted which will be executed whenever the
+  ** parser fails */
+/************ Begin %parse_failure code ***************************************/
+%%
+/************ End %parse_failure code *****************************************/
+  ParseARG_STORE; /* Suppress warning about unused %extra_argument variable */
+}
+#endif /* YYNOERRORRECOVERY */
+
+/*
+** The following code executes when a syntax error first occurs.
+*/
+static void yy_syntax_error(
+  yyParser *yypParser,           /* The parser */
+  int yymajor,                   /* The major type of the error token */
+  ParseTOKENTYPE &yyminor        /* The minor type of the error token */
+){
+  ParseARG_FETCH;
+#define TOKEN yyminor
+/************ Begin %syntax_error code ****************************************/
+%%
+/************ End %syntax_error code ******************************************/
+  ParseARG_STORE; /* Suppress warning about unused %extra_argument variable */
+}
+
+/*
+** The following is executed when the parser accepts
+*/
+static void yy_accept(
+  yyParser *yypParser           /* The parser */
+){
+  ParseARG_FETCH;
+#ifndef NDEBUG
+  if( yyTraceFILE ){
+    fprintf(yyTraceFILE,"%sAccept!\n",yyTracePrompt);
+  }
+#endif
+  while( yypParser->yyidx>=0 ) yy_pop_parser_stack(yypParser);
+  /* Here code is inserted which will be executed whenever the
+  ** parser accepts */
+/*********** Begin %parse_accept code *****************************************/
+%%
+/*********** End %parse_accept code *******************************************/
+  ParseARG_STORE; /* Suppress warning about unused %extra_argument variable */
+}
+
+/* The main parser program.  See Parse() in lempar.c.  The token is
+** moved onto the stack when it is shifted.  A token that is thrown away
+** goes through yy_destructor(); one that is neither shifted nor thrown
+** away, as after a stack overflow, is destroyed on return.
+*/
+void Parse(
+  void *yyp,                   /* The parser */
+  int yymajor,                 /* The major token code number */
+  ParseTOKENTYPE yyminor       /* The value for the token */
+  ParseARG_PDECL               /* Optional %extra_argument parameter */
+){
+  unsigned int yyact;   /* The parser action. */
+#if !defined(YYERRORSYMBOL) && !defined(YYNOERRORRECOVERY)
+  int yyendofinput;     /* True if we are at the end of input */
+#endif
+#ifdef YYERRORSYMBOL
+  int yyerrorhit = 0;   /* True if yymajor has invoked an error */
+#endif
+  yyParser *yypParser;  /* The parser */
+
+  /* (re)initialize the parser, if necessary */
+  yypParser = (yyParser*)yyp;
+  if( yypParser->yyidx<0 ){
+#if YYSTACKDEPTH<=0
+    if( yypParser->yystksz <=0 ){
+      yyStackOverflow(yypParser);
+      return;
+    }
+#endif
+    yypParser->yyidx = 0;
+#ifndef YYNOERRORRECOVERY
+    yypParser->yyerrcnt = -1;
+#endif
+    yypParser->yystack[0].stateno = 0;
+    yypParser->yystack[0].major = 0;
+#ifndef NDEBUG
+    if( yyTraceFILE ){
+      fprintf(yyTraceFILE,"%sInitialize. Empty stack. State 0\n",
+              yyTracePrompt);
+    }
+#endif
+  }
+#if !defined(YYERRORSYMBOL) && !defined(YYNOERRORRECOVERY)
+  yyendofinput = (yymajor==0);
+#endif
+  ParseARG_STORE;
+
+#ifndef NDEBUG
+  if( yyTraceFILE ){
+    fprintf(yyTraceFILE,"%sInput '%s'\n",yyTracePrompt,yyTokenName[yymajor]);
+  }
+#endif
+
+  do{
+    yyact = yy_find_shift_action(yypParser,(YYCODETYPE)yymajor);
+    if( yyact <= YY_MAX_SHIFTREDUCE ){
+      if( yyact > YY_MAX_SHIFT ) yyact += YY_MIN_REDUCE - YY_MIN_SHIFTREDUCE;
+      yy_shift(yypParser,yyact,yymajor,yyminor);
+#ifndef YYNOERRORRECOVERY
+      yypParser->yyerrcnt--;
+#endif
+      yymajor = YYNOCODE;
+#ifndef YYLAZYREDUCE
+      /* The new state can only reduce, so do that now rather than when
+      ** the next token arrives */
+      while( yyact>=YY_MIN_REDUCE && yyact<=YY_MAX_REDUCE
+             && yypParser->yyidx>=0 ){
+        yyact = yy_reduce(yypParser,yyact-YY_MIN_REDUCE);
+      }
+#endif
+    }else if( yyact <= YY_MAX_REDUCE ){
+      /* Run reductions back-to-back for as long as each goto lands in
+      ** a state that can only reduce */
+      do{
+        yyact = yy_reduce(yypParser,yyact-YY_MIN_REDUCE);
+      }while( yyact>=YY_MIN_REDUCE && yyact<=YY_MAX_REDUCE );
+    }else{
+      assert( yyact == YY_ERROR_ACTION );
+#ifdef YYERRORSYMBOL
+      int yymx;
+#endif
+#ifndef NDEBUG
+      if( yyTraceFILE ){
+        fprintf(yyTraceFILE,"%sSyntax Error!\n",yyTracePrompt);
+      }
+#endif
+#ifdef YYERRORSYMBOL
+      /* A syntax error has occurred.  See lempar.c for the recovery.
+      ** The error symbol gets a default-constructed value.
+      */
+      if( yypParser->yyerrcnt<0 ){
+        yy_syntax_error(yypParser,yymajor,yyminor);
+      }
+      yymx = yypParser->yystack[yypParser->yyidx].major;
+      if( yymx==YYERRORSYMBOL || yyerrorhit ){
+#ifndef NDEBUG
+        if( yyTraceFILE ){
+          fprintf(yyTraceFILE,"%sDiscard input token %s\n",
+             yyTracePrompt,yyTokenName[yymajor]);
+        }
+#endif
+        yy_discard_token(yypParser, yymajor, yyminor);
+        yymajor = YYNOCODE;
+      }else{
+        while(
+          yypParser->yyidx >= 0 &&
+          yymx != YYERRORSYMBOL &&
+          (yyact = yy_find_reduce_action(
+                        yypParser->yystack[yypParser->yyidx].stateno,
+                        YYERRORSYMBOL)) >= YY_MIN_REDUCE
+        ){
+          yy_pop_parser_stack(yypParser);
+        }
+        if( yypParser->yyidx < 0 || yymajor==0 ){
+          yy_discard_token(yypParser, yymajor, yyminor);
+          yy_parse_failed(yypParser);
+          yymajor = YYNOCODE;
+        }else if( yymx!=YYERRORSYMBOL ){
+          yyStackEntry *yytos = yy_push(yypParser,yyact,YYERRORSYMBOL);
+          if( yytos ){
+            yyConstructAt(yytos->minor.YYERRSYMDT);
+            yyTraceShift(yypParser, yyact);
+          }
+        }
+      }
+      yypParser->yyerrcnt = 3;
+      yyerrorhit = 1;
+#elif defined(YYNOERRORRECOVERY)
+      /* Invoke the syntax error routine and continue going as if nothing
+      ** had happened.  See lempar.c.
+      */
+      yy_syntax_error(yypParser,yymajor,yyminor);
+      yy_discard_token(yypParser, yymajor, yyminor);
+      yymajor = YYNOCODE;
+
+#else  /* YYERRORSYMBOL is not defined */
+      /* Report an error message, throw away the input token and fail the
+      ** parse at the end of the input.  See lempar.c.
+      */
+      if( yypParser->yyerrcnt<=0 ){
+        yy_syntax_error(yypParser,yymajor,yyminor);
+      }
+      yypParser->yyerrcnt = 3;
+      yy_discard_token(yypParser, yymajor, yyminor);
+      if( yyendofinput ){
+        yy_parse_failed(yypParser);
+      }
+      yymajor = YYNOCODE;
+#endif
+    }
+  }while( yymajor!=YYNOCODE && yypParser->yyidx>=0 );
+#ifndef NDEBUG
+  if( yyTraceFILE ){
+    int i;
+    fprintf(yyTraceFILE,"%sReturn. Stack=",yyTracePrompt);
+    for(i=1; i<=yypParser->yyidx; i++)
+      fprintf(yyTraceFILE,"%c%s", i==1 ? '[' : ' ',
+              yyTokenName[yypParser->yystack[i].major]);
+    fprintf(yyTraceFILE,"]\n");
+  }
+#endif
+  return;
+}
@@ -0,0 +1,365 @@
+/*
+** 2000-05-29
+**
+** The author disclaims copyright to this source code.  In place of
+** a legal notice, here is a blessing:
+**
+**    May you do good and not evil.
+**    May you find forgiveness for yourself and forgive others.
+**    May you share freely, never taking more than you give.
+**
+*************************************************************************
+** Template for a LEMON parser that runs on the shared parser engine.
+**
+** The "lemon" program uses this template in place of lempar.c when it is
+** run with the "-e" option.  The parser it generates holds the parsing
+** tables and the actions of the grammar, and a descriptor, yyGrammar,
+** through which the engine in lemonrt.c reaches them.  The engine is
+** built once, as the "lemonrt" library, however many grammars use it.
+** As in lempar.c, "lemon" inserts text at each "%%" line and changes any
+** "P-a-r-s-e" identifier prefix (without the interstitial "-" characters)
+** into the value of the %name directive from the grammar.
+**
+** The following is the concatenation of all %include directives from the
+** input grammar file:
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "lemonrt.h"
+/************ Begin %include sections from the grammar ************************/
+%%
+/**************** End of %include directives **********************************/
+/* These constants specify the various numeric values for terminal symbols
+** in a format understandable to "makeheaders".  This section is blank unless
+** "lemon" is run with the "-m" command-line option.
+***************** Begin makeheaders token definitions *************************/
+%%
+/**************** End makeheaders token definitions ***************************/
+
+/* The next sections is a series of control #defines.  Their meaning is
+** described in lempar.c.  A parser for the shared engine always keeps
+** its semantic values in a stack of their own (YYSPLITSTACK), and its
+** YYCODETYPE and YYACTIONTYPE are those of the engine.  Of the options
+** that lempar.c takes from the %include section, YYSTACKDEPTH,
+** YYNOERRORRECOVERY and YYLAZYREDUCE apply here as well.
+*/
+#ifndef INTERFACE
+# define INTERFACE 1
+#endif
+/************* Begin control #defines *****************************************/
+%%
+/************* End control #defines *******************************************/
+
+#ifndef yytestcase
+# define yytestcase(X)
+#endif
+
+/* The parsing tables.  They are laid out as described in lempar.c.
+*********** Begin parsing tables **********************************************/
+%%
+/********** End of lemon-generated parsing tables *****************************/
+
+typedef lemonrt_entry yyStackEntry;
+
+/* The parser object.  The engine's state comes first, so that the engine
+** and the code of the grammar can both address the object. */
+struct yyParser {
+  lemonrt_parser yyrt;          /* The state of the engine */
+  ParseARG_SDECL                /* A place to hold %extra_argument */
+};
+typedef struct yyParser yyParser;
+/************* Begin split parser declarations ********************************/
+%%
+/************* End split parser declarations **********************************/
+
+/* The next table maps tokens (terminal symbols) into fallback tokens.
+** See lempar.c.
+*/
+#if defined(YYFALLBACK) && !defined(YYNOFALLBACKRETRY)
+static const YYCODETYPE yyFallback[] = {
+%%
+};
+#endif /* YYFALLBACK */
+
+#ifndef NDEBUG
+/* For tracing shifts, the names of all terminals and nonterminals
+** are required.  The following table supplies these names */
+static const char *const yyTokenName[] = {
+%%
+};
+#endif /* NDEBUG */
+
+#ifndef NDEBUG
+/* For tracing reduce actions, the names of all rules are required.
+*/
+static const char *const yyRuleName[] = {
+%%
+};
+#endif /* NDEBUG */
+
+/* The following function deletes the "minor type" or semantic value
+** associated with a symbol.  The code used to do the deletions is derived
+** from the %destructor and/or %token_destructor directives of the input
+** grammar.
+*/
+static void yy_destructor(
+  yyParser *yypParser,    /* The parser */
+  YYCODETYPE yymajor,     /* Type code for object to destroy */
+  YYMINORTYPE *yypminor   /* The object to be destroyed */
+){
+  ParseARG_FETCH;
+  switch( yymajor ){
+/********* Begin destructor definitions ***************************************/
+%%
+/********* End destructor definitions *****************************************/
+    default:  break;   /* If no destructor action specified: do nothing */
+  }
+}
+static void yy_destroy(lemonrt_parser *yyrt, int yymajor, void *yypminor){
+  yy_destructor((yyParser*)yyrt, (YYCODETYPE)yymajor, (YYMINORTYPE*)yypminor);
+}
+
+/*
+** The following routine is called if the stack overflows, after the
+** engine has emptied the stack.
+*/
+static void yyStackOverflow(lemonrt_parser *yyrt){
+   yyParser *yypParser = (yyParser*)yyrt;
+   ParseARG_FETCH;
+/******** Begin %stack_overflow code ******************************************/
+%%
+/******** End %stack_overflow code ********************************************/
+   ParseARG_STORE; /* Suppress warning about unused %extra_argument var */
+}
+
+/* The following table contains information about every rule that
+** is used during the reduce.
+*/
+static const lemonrt_rule yyRuleInfo[] = {
+%%
+};
+
+/********** Begin reduce action functions *************************************/
+%%
+/********** End reduce action functions ***************************************/
+
+/*
+** Run the code of a reduce action.  The engine pops the right-hand side
+** and pushes the left-hand side afterwards.
+*/
+static void yy_reduce_action(
+  lemonrt_parser *yyrt,          /* The parser */
+  int yyruleno,                  /* Number of the rule by which to reduce */
+  yyStackEntry *yymsp,           /* The top of the parser's stack */
+  void *yyvp                     /* The top of the minor value stack */
+){
+  yyParser *yypParser = (yyParser*)yyrt;
+  YYMINORTYPE *yymvp = (YYMINORTYPE*)yyvp;
+  ParseARG_FETCH;
+  (void)yymsp;
+  (void)yymvp;
+  switch( yyruleno ){
+/********** Begin reduce actions **********************************************/
+%%
+/********** End reduce actions ************************************************/
+  };
+  ParseARG_STORE;
+}
+
+/*
+** The following code executes when the parse fails
+*/
+static void yy_parse_failed(lemonrt_parser *yyrt){
+  yyParser *yypParser = (yyParser*)yyrt;
+  ParseARG_FETCH;
+/************ Begin %parse_failure code ***************************************/
+%%
+/************ End %parse_failure code *****************************************/
+  ParseARG_STORE; /* Suppress warning about unused %extra_argument variable */
+}
+
+/*
+** The following code executes when a syntax error first occurs.
+*/
+static void yy_syntax_error(
+  lemonrt_parser *yyrt,          /* The parser */
+  int yymajor,                   /* The major type of the error token */
+  void *yypminor                 /* The minor type of the error token */
+){
+  yyParser *yypParser = (yyParser*)yyrt;
+  ParseARG_FETCH;
+#define TOKEN (((YYMINORTYPE*)yypminor)->yy0)
+/************ Begin %syntax_error code ****************************************/
+%%
+/************ End %syntax_error code ******************************************/
+  ParseARG_STORE; /* Suppress warning about unused %extra_argument variable */
+}
+
+/*
+** The following is executed when the parser accepts
+*/
+static void yy_accept(lemonrt_parser *yyrt){
+  yyParser *yypParser = (yyParser*)yyrt;
+  ParseARG_FETCH;
+/*********** Begin %parse_accept code *****************************************/
+%%
+/*********** End %parse_accept code *******************************************/
+  ParseARG_STORE; /* Suppress warning about unused %extra_argument variable */
+}
+
+/* The descriptor of the grammar, for the engine */
+static const lemonrt_grammar yyGrammar = {
+  YYNSTATE,
+  YYNRULE,
+  YYNOCODE,
+  (int)sizeof(YYMINORTYPE),
+  YYSTACKDEPTH>0 ? YYSTACKDEPTH : 0,
+#ifdef YYERRORSYMBOL
+  YYERRORSYMBOL,
+#else
+  0,
+#endif
+#ifdef YYNOERRORRECOVERY
+  1,
+#else
+  0,
+#endif
+#ifdef YYLAZYREDUCE
+  1,
+#else
+  0,
+#endif
+  YYFINGERPRINT,
+  YYNRHSMAX,
+  YY_MAX_SHIFT,
+  YY_MIN_SHIFTREDUCE,
+  YY_MAX_SHIFTREDUCE,
+  YY_MIN_REDUCE,
+  YY_MAX_REDUCE,
+  YY_ERROR_ACTION,
+  YY_ACCEPT_ACTION,
+  YY_NO_ACTION,
+  YY_ACTTAB_COUNT,
+  yy_action,
+  yy_lookahead,
+  YY_SHIFT_USE_DFLT,
+  YY_SHIFT_COUNT,
+  yy_shift_ofst,
+  YY_REDUCE_USE_DFLT,
+  YY_REDUCE_COUNT,
+  yy_reduce_ofst,
+  yy_default,
+#if defined(YYFALLBACK) && !defined(YYNOFALLBACKRETRY)
+  (int)(sizeof(yyFallback)/sizeof(yyFallback[0])),
+  yyFallback,
+#else
+  0,
+  0,
+#endif
+#if defined(YYWILDCARD) && !defined(YYNOFALLBACKRETRY)
+  YYWILDCARD,
+#else
+  0,
+#endif
+  yyRuleInfo,
+#ifndef NDEBUG
+  yyTokenName,
+  yyRuleName,
+#else
+  0,
+  0,
+#endif
+  yy_reduce_action,
+  yy_destroy,
+  yyStackOverflow,
+  yy_syntax_error,
+  yy_parse_failed,
+  yy_accept
+};
+
+/*
+** This function allocates a new parser.
+** The only argument is a pointer to a function which works like
+** malloc.
+*/
+#ifndef YYMALLOCARGTYPE
+# define YYMALLOCARGTYPE size_t
+#endif
+void *ParseAllocGrammar(void *(*)(YYMALLOCARGTYPE), const lemonrt_grammar*);
+void *ParseAlloc(void *(*mallocProc)(YYMALLOCARGTYPE)){
+  return ParseAllocGrammar(mallocProc, &yyGrammar);
+}
+
+/*
+** Allocate a new parser that runs with the grammar pGrammar in place of
+** the one compiled into this file.  pGrammar is normally obtained from
+** lemonrt_load() with ParseGrammar() as the code of the grammar, and
+** must have the same rules and semantic value types as this file.
+** lemonrt_load() refuses a table file written for other rules.
+*/
+void *ParseAllocGrammar(
+  void *(*mallocProc)(YYMALLOCARGTYPE),
+  const lemonrt_grammar *pGrammar
+){
+  yyParser *pParser;
+  pParser = (yyParser*)(*mallocProc)( (YYMALLOCARGTYPE)sizeof(yyParser) );
+  if( pParser ){
+    lemonrt_init(&pParser->yyrt, pGrammar);
+  }
+  return pParser;
+}
+
+/*
+** Return the descriptor of the grammar compiled into this file.
+*/
+const lemonrt_grammar *ParseGrammar(void){
+  return &yyGrammar;
+}
+
+/*
+** Deallocate and destroy a parser.  Destructors are called for
+** all stack elements before shutting the parser down.
+*/
+void ParseFree(
+  void *p,                    /* The parser to be deleted */
+  void (*freeProc)(void*)     /* Function used to reclaim memory */
+){
+  yyParser *pParser = (yyParser*)p;
+#ifndef YYPARSEFREENEVERNULL
+  if( pParser==0 ) return;
+#endif
+  lemonrt_finalize(&pParser->yyrt);
+  (*freeProc)((void*)pParser);
+}
+
+#ifndef NDEBUG
+/*
+** Turn parser tracing on or off.  The engine keeps one trace stream for
+** all the parsers that use it.
+*/
+void ParseTrace(FILE *TraceFILE, char *zTracePrompt){
+  lemonrt_trace(TraceFILE, zTracePrompt);
+}
+#endif /* NDEBUG */
+
+/*
+** Return the peak depth of the stack for a parser.
+*/
+int ParseStackPeak(void *p){
+  return lemonrt_stack_peak(&((yyParser*)p)->yyrt);
+}
+
+/* The main parser program.  See Parse() in lempar.c.
+*/
+void Parse(
+  void *yyp,                   /* The parser */
+  int yymajor,                 /* The major token code number */
+  ParseTOKENTYPE yyminor       /* The value for the token */
+  ParseARG_PDECL               /* Optional %extra_argument parameter */
+){
+  YYMINORTYPE yyminorunion;
+  yyParser *yypParser = (yyParser*)yyp;
+  ParseARG_STORE;
+  yyminorunion.yy0 = yyminor;
+  lemonrt_parse(&yypParser->yyrt, yymajor, &yyminorunion);
+}
@@ -0,0 +1,68 @@
+/*
+** The grammar of the tests.  Every value, of a token or of a nonterminal,
+** is a Node counted in the Ctx, so that a value destroyed twice or never
+** is caught.  Each statement appends its value to the log of the Ctx, and
+** each syntax error appends -1.
+*/
+%name Calc
+%token_type {Node*}
+%default_type {Node*}
+%extra_argument {Ctx *ctx}
+%include {
+#include "support.h"
+#define YYSNAPSHOTCOPY(P,X,D,S) \
+  (*(D) = *(S), \
+   (X)!=YYERRORSYMBOL ? node_copy((P)->ctx, (Node**)(D)) : (void)0)
+#define YYSNAPSHOTSAME(P,X,A,B) \
+  ((X)==YYERRORSYMBOL || node_same(*(Node**)(A), *(Node**)(B)))
+}
+%token_destructor { node_free(ctx, $$); }
+%default_destructor { node_free(ctx, $$); }
+%destructor error { (void)$$; }
+%syntax_error { ctx_log(ctx, -1); }
+%parse_accept { ctx->nAccept++; }
+%parse_failure { ctx->nFail++; }
+%stack_overflow { ctx->nOverflow++; }
+
+%left PLUS MINUS.
+%left TIMES.
+
+program ::= stmts(A).                  { node_free(ctx, A); }
+stmts(A) ::= stmts(B) stmt(C).         { A = B; node_free(ctx, C); }
+stmts(A) ::= .                         { A = node_new(ctx, 0); }
+stmt(A) ::= expr(B) SEMI.              { ctx_log(ctx, B->v); A = B; }
+stmt(A) ::= error SEMI.                { A = node_new(ctx, 0); }
+expr(A) ::= expr(B) PLUS expr(C).      { A = node_op(ctx, B, '+', C); }
+expr(A) ::= expr(B) MINUS expr(C).     { A = node_op(ctx, B, '-', C); }
+expr(A) ::= expr(B) TIMES expr(C).     { A = node_op(ctx, B, '*', C); }
+expr(A) ::= LP expr(B) RP.             { A = B; }
+expr(A) ::= NUM(A).
+
+%code {
+/*
+** Write and read the value of a symbol for ParseSerialize() and
+** ParseDeserialize(): the four bytes of the value of its node.  A value
+** out of the range of node_op() is not valid.  The error symbol has no
+** value to write.
+*/
+int calc_write_value(void *pArg, int major, void *pValue,
+                     unsigned char *a, int n){
+  (void)pArg;
+  if( major==YYERRORSYMBOL ) return 0;
+  if( n>=4 ) memcpy(a, &(*(Node**)pValue)->v, 4);
+  return 4;
+}
+int calc_read_value(void *pArg, int major, void *pValue,
+                    const unsigned char *a, int n){
+  int v;
+  if( major==YYERRORSYMBOL ){
+    ((YYMINORTYPE*)pValue)->YYERRSYMDT = 0;
+    return 0;
+  }
+  if( n<4 ) return -1;
+  memcpy(&v, a, 4);
+  if( v<0 || v>=10007 ) return -1;
+  *(Node**)pValue = node_new((Ctx*)pArg, v);
+  return 4;
+}
+}
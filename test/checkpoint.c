@@ -0,0 +1,151 @@
+/*
+** Test ParseCheckpoints(), ParseResume() and ParseSynced() on random
+** edits of random input.
+**
+** After each edit the parser is resumed from a checkpoint, and must then
+** be in the state a plain parse of the edited input reaches at that
+** offset, unless it starts again from the first token.  It is fed the edited input from there until ParseSynced()
+** reports the offset of a checkpoint, where it must again be in the state
+** of a plain parse.  States are compared with ParseSerialize(), values
+** included.
+**
+** Usage: checkpoint [SEED [DEPTH]]
+*/
+#include "support.h"
+#include "calc.h"
+
+/* Pass token i of *pTok to parser p */
+static void feed(void *p, const Tokens *pTok, int i, Ctx *c){
+  int major = pTok->aMajor[i];
+  Calc(p, major, major ? node_new(c, pTok->aVal[i]) : 0, c);
+}
+
+/*
+** Return the state of parser p, written by ParseSerialize() into a
+** buffer obtained from malloc().  Write its size into *pn.
+*/
+static unsigned char *state_of(void *p, int *pn){
+  int n = CalcSerialize(p, 0, 0, calc_write_value, 0);
+  unsigned char *a = (unsigned char*)malloc(n>0 ? n : 1);
+  if( a==0 ){
+    fprintf(stderr, "out of memory\n");
+    exit(1);
+  }
+  *pn = CalcSerialize(p, a, n, calc_write_value, 0);
+  return a;
+}
+
+/*
+** Return non-zero if parser p is in the state that a plain parse of the
+** first k tokens of *pTok reaches.
+*/
+static int same_as_plain(void *p, const Tokens *pTok, int k, Ctx *c){
+  void *q = CalcAlloc(malloc);
+  unsigned char *a, *b;
+  int na, nb, i, rc;
+  for(i=0; i<k; i++) feed(q, pTok, i, c);
+  a = state_of(p, &na);
+  b = state_of(q, &nb);
+  rc = na==nb && memcmp(a, b, na)==0;
+  free(a);
+  free(b);
+  CalcFree(q, free);
+  return rc;
+}
+
+/*
+** Replace the nOld tokens at iTok of *pTok with nNew tokens taken at
+** random from it.
+*/
+static void edit(Tokens *pTok, int iTok, int nOld, int nNew){
+  int n = pTok->n - nOld + nNew;
+  int *aMajor = (int*)malloc(n*sizeof(int));
+  int *aVal = (int*)malloc(n*sizeof(int));
+  int i;
+  if( aMajor==0 || aVal==0 ){
+    fprintf(stderr, "out of memory\n");
+    exit(1);
+  }
+  memcpy(aMajor, pTok->aMajor, iTok*sizeof(int));
+  memcpy(aVal, pTok->aVal, iTok*sizeof(int));
+  for(i=0; i<nNew; i++){
+    int j = rand()%(pTok->n-1);
+    aMajor[iTok+i] = pTok->aMajor[j];
+    aVal[iTok+i] = pTok->aVal[j];
+  }
+  i = iTok + nOld;
+  memcpy(aMajor+iTok+nNew, pTok->aMajor+i, (pTok->n-i)*sizeof(int));
+  memcpy(aVal+iTok+nNew, pTok->aVal+i, (pTok->n-i)*sizeof(int));
+  tokens_free(pTok);
+  pTok->aMajor = aMajor;
+  pTok->aVal = aVal;
+  pTok->n = n;
+}
+
+/*
+** Parse *pTok with checkpoints every nEvery tokens within nBudget bytes,
+** and at the end of each statement if bStmt, then edit it nEdit times.
+** Return the number of failures.
+*/
+static int test_edits(Tokens *pTok, unsigned int seed, int nEvery,
+                      size_t nBudget, int bStmt, int nEdit){
+  Ctx c;
+  void *p = CalcAlloc(malloc);
+  int i, e, nFail = 0, nSync = 0;
+  memset(&c, 0, sizeof(c));
+  srand(seed);
+  CalcCheckpoints(p, nEvery, nBudget, malloc, free);
+  for(i=0; i<pTok->n; i++){
+    feed(p, pTok, i, &c);
+    if( bStmt && pTok->aMajor[i]==SEMI ) CalcCheckpoint(p);
+  }
+  for(e=0; e<nEdit; e++){
+    int iTok = rand()%(pTok->n-1);
+    int nOld = rand()%3;
+    int nNew = rand()%3;
+    int iFrom;
+    if( iTok+nOld>pTok->n-1 ) nOld = pTok->n-1-iTok;
+    edit(pTok, iTok, nOld, nNew);
+    iFrom = CalcResume(p, iTok, nOld, nNew);
+    if( CHECK( iFrom>=0 && iFrom<=iTok ) ){
+      nFail++;
+      break;
+    }
+    nFail += CHECK( iFrom==0 || same_as_plain(p, pTok, iFrom, &c) );
+    for(i=iFrom; i<pTok->n && CalcSynced(p)<0; i++){
+      feed(p, pTok, i, &c);
+      if( bStmt && pTok->aMajor[i]==SEMI ) CalcCheckpoint(p);
+    }
+    if( CalcSynced(p)>=0 ){
+      /* The sync was found before token i-1 was fed */
+      nFail += CHECK( CalcSynced(p)==i-1 );
+      nFail += CHECK( CalcSynced(p)>=iTok+nNew );
+      nFail += CHECK( same_as_plain(p, pTok, i, &c) );
+      nSync++;
+    }
+  }
+  CalcFree(p, free);
+  nFail += CHECK( nSync>0 );
+  nFail += CHECK( c.nOverflow==0 );
+  nFail += CHECK( c.nLive==0 );
+  ctx_clear(&c);
+  return nFail;
+}
+
+int main(int argc, char **argv){
+  unsigned int seed = argc>1 ? (unsigned int)atoi(argv[1]) : 1;
+  int mxDepth = argc>2 ? atoi(argv[2]) : 20;
+  int nFail = 0, k;
+  for(k=0; k<6; k++){
+    Tokens tok;
+    tokens_make(&tok, seed+k, 100, mxDepth, k%2 ? 40 : 0);
+    switch( k/2 ){
+      case 0:  nFail += test_edits(&tok, seed+k, 16, 0, 0, 200);    break;
+      case 1:  nFail += test_edits(&tok, seed+k, 4, 4096, 0, 200);  break;
+      default: nFail += test_edits(&tok, seed+k, 0, 0, 1, 200);     break;
+    }
+    tokens_free(&tok);
+  }
+  printf("checkpoint: %d failures\n", nFail);
+  return nFail!=0;
+}
@@ -0,0 +1,184 @@
+/*
+** Test ParseSerialize() and ParseDeserialize().
+**
+** The state of a parser, written at random points of random input and
+** read into another parser, must parse the rest of the input as the
+** first parser does.  Truncated buffers, buffers with a wrong header and
+** buffers with any one byte changed must either be rejected, leaving
+** the parser empty, or load a state that parses on without tripping an
+** assert.  No value may leak or be freed twice.
+**
+** Usage: serialize [SEED [DEPTH]]
+*/
+#include "support.h"
+#include "calc.h"
+
+/* Pass token i of *pTok to parser p */
+static void feed(void *p, const Tokens *pTok, int i, Ctx *c){
+  int major = pTok->aMajor[i];
+  Calc(p, major, major ? node_new(c, pTok->aVal[i]) : 0, c);
+}
+
+/*
+** Return the state of parser p, written by ParseSerialize() into a
+** buffer obtained from malloc().  Write its size into *pn.
+*/
+static unsigned char *state_of(void *p, int *pn){
+  int n = CalcSerialize(p, 0, 0, calc_write_value, 0);
+  unsigned char *a = (unsigned char*)malloc(n>0 ? n : 1);
+  if( a==0 ){
+    fprintf(stderr, "out of memory\n");
+    exit(1);
+  }
+  *pn = CalcSerialize(p, a, n, calc_write_value, 0);
+  return a;
+}
+
+/* Bytes that the state of an empty parser takes */
+static int nEmpty;
+
+/*
+** Load the n bytes of a[] into parser q.  If they load, feed q a few
+** tokens of *pTok from iTok on and the end of the input.  Either way q
+** must end up empty.  Return 1 if the bytes loaded, 0 if they were
+** rejected, or -1 on a failure.
+*/
+static int load(void *q, const unsigned char *a, int n,
+                const Tokens *pTok, int iTok, Ctx *c){
+  int i;
+  if( CalcDeserialize(q, a, n, calc_read_value, c, c) ){
+    return CHECK( CalcSerialize(q, 0, 0, calc_write_value, 0)==nEmpty )
+           ? -1 : 0;
+  }
+  for(i=iTok; i<iTok+16 && i<pTok->n-1; i++) feed(q, pTok, i, c);
+  Calc(q, 0, 0, c);
+  return 1;
+}
+
+/*
+** Parse *pTok, and at random points load the state of the parser into
+** a second parser that then parses the rest of the input on its own.
+** It must log the rest of the statements of a plain parse.  Return the
+** number of failures.
+*/
+static int test_round_trip(const Tokens *pTok, const Ctx *pRef,
+                           unsigned int seed){
+  Ctx c;
+  void *p = CalcAlloc(malloc);
+  int i, nFail = 0, nTrip = 0;
+  memset(&c, 0, sizeof(c));
+  srand(seed);
+  for(i=0; i<pTok->n; i++){
+    if( pTok->aMajor[i] && rand()%16==0 ){
+      Ctx c2;
+      void *q = CalcAlloc(malloc);
+      unsigned char *a, *b;
+      int n, nb, j;
+      memset(&c2, 0, sizeof(c2));
+      a = state_of(p, &n);
+      nFail += CHECK( CalcDeserialize(q, a, n, calc_read_value, &c2, &c2)==0 );
+      b = state_of(q, &nb);
+      nFail += CHECK( nb==n && memcmp(a, b, n)==0 );
+      free(b);
+      for(j=i; j<pTok->n; j++) feed(q, pTok, j, &c2);
+      CalcFree(q, free);
+      free(a);
+      nFail += CHECK( c2.nLog==pRef->nLog-c.nLog );
+      nFail += CHECK( c2.nLog==0
+         || memcmp(c2.aLog, pRef->aLog+c.nLog, c2.nLog*sizeof(int))==0 );
+      nFail += CHECK( c2.nLive==0 );
+      ctx_clear(&c2);
+      nTrip++;
+    }
+    feed(p, pTok, i, &c);
+  }
+  CalcFree(p, free);
+  nFail += CHECK( nTrip>0 );
+  nFail += CHECK( c.nLive==0 );
+  ctx_clear(&c);
+  return nFail;
+}
+
+/*
+** Write the state of a parser at random points of *pTok, and load it
+** again truncated, with its header changed, and with each of its bytes
+** replaced by every other value.  Return the number of failures.
+*/
+static int test_malformed(const Tokens *pTok, unsigned int seed){
+  Ctx c;
+  void *p = CalcAlloc(malloc);
+  void *q = CalcAlloc(malloc);
+  int i, nFail = 0, nLoad = 0, nReject = 0;
+  memset(&c, 0, sizeof(c));
+  srand(seed);
+  for(i=0; i<pTok->n-1; i++){
+    feed(p, pTok, i, &c);
+    if( rand()%32==0 ){
+      unsigned char *a, *b;
+      int n, k, v, rc;
+      a = state_of(p, &n);
+      b = (unsigned char*)malloc(n);
+      if( b==0 ){
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+      }
+      for(k=0; k<n; k++){
+        /* Every prefix is short of an entry or of a value */
+        nFail += CHECK( load(q, a, k, pTok, i+1, &c)==0 );
+      }
+      for(k=0; k<3; k++){
+        /* The numbers of states and rules, and YYTABLEPRINT */
+        memcpy(b, a, n);
+        b[k] ^= 1;
+        nFail += CHECK( load(q, b, n, pTok, i+1, &c)==0 );
+      }
+      for(k=0; k<n; k++){
+        for(v=0; v<256; v++){
+          if( v==a[k] ) continue;
+          memcpy(b, a, n);
+          b[k] = (unsigned char)v;
+          rc = load(q, b, n, pTok, i+1, &c);
+          if( rc<0 ){
+            nFail++;
+          }else if( rc ){
+            nLoad++;
+          }else{
+            nReject++;
+          }
+        }
+      }
+      free(a);
+      free(b);
+    }
+  }
+  CalcFree(p, free);
+  CalcFree(q, free);
+  nFail += CHECK( nLoad>0 && nReject>0 );
+  nFail += CHECK( c.nLive==0 );
+  ctx_clear(&c);
+  return nFail;
+}
+
+int main(int argc, char **argv){
+  unsigned int seed = argc>1 ? (unsigned int)atoi(argv[1]) : 1;
+  int mxDepth = argc>2 ? atoi(argv[2]) : 20;
+  int nFail = 0, i, k;
+  void *p = CalcAlloc(malloc);
+  nEmpty = CalcSerialize(p, 0, 0, calc_write_value, 0);
+  CalcFree(p, free);
+  for(k=0; k<4; k++){
+    Tokens tok;
+    Ctx ref;
+    memset(&ref, 0, sizeof(ref));
+    tokens_make(&tok, seed+k, 40, mxDepth, k%2 ? 20 : 0);
+    p = CalcAlloc(malloc);
+    for(i=0; i<tok.n; i++) feed(p, &tok, i, &ref);
+    CalcFree(p, free);
+    nFail += test_round_trip(&tok, &ref, seed+k);
+    nFail += test_malformed(&tok, seed+k);
+    ctx_clear(&ref);
+    tokens_free(&tok);
+  }
+  printf("serialize: %d failures\n", nFail);
+  return nFail!=0;
+}
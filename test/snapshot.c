@@ -0,0 +1,135 @@
+/*
+** Test ParseSnapshot(), ParseRestore() and ParseFork() on random input.
+**
+** A parse interrupted by snapshots, detours through other tokens and
+** restores must log the same statements as a plain parse of the input,
+** as must a fork finished on its own.  No value may leak or be freed
+** twice.
+**
+** Usage: snapshot [SEED [DEPTH]]
+*/
+#include "support.h"
+
+/* Pass token i of *pTok to parser p */
+static void feed(void *p, const Tokens *pTok, int i, Ctx *c){
+  int major = pTok->aMajor[i];
+  Calc(p, major, major ? node_new(c, pTok->aVal[i]) : 0, c);
+}
+
+/* Parse all of *pTok with a plain parser, logging into *c */
+static void parse_plain(const Tokens *pTok, Ctx *c){
+  void *p = CalcAlloc(malloc);
+  int i;
+  for(i=0; i<pTok->n; i++) feed(p, pTok, i, c);
+  CalcFree(p, free);
+}
+
+/* Return non-zero if the log of c is entries iFrom to n-1 of the log of r */
+static int same_log(const Ctx *c, const Ctx *r, int iFrom, int n){
+  if( c->nLog!=n-iFrom ) return 0;
+  return n==iFrom
+      || memcmp(c->aLog, r->aLog+iFrom, (n-iFrom)*sizeof(int))==0;
+}
+
+/*
+** Parse *pTok taking snapshots at random, feeding the parser a detour of
+** random tokens after each and then restoring it, sometimes into another
+** parser.  Return the number of failures.
+*/
+static int test_restore(const Tokens *pTok, const Ctx *pRef,
+                        unsigned int seed){
+  Ctx c;
+  void *p = CalcAlloc(malloc);
+  int i, nFail = 0, nRestore = 0;
+  memset(&c, 0, sizeof(c));
+  srand(seed);
+  for(i=0; i<pTok->n; i++){
+    if( pTok->aMajor[i] && rand()%4==0 ){
+      void *pSnap = CalcSnapshot(p, malloc);
+      int nLog = c.nLog;
+      int nRepeat = 1 + rand()%2, k;
+      nFail += CHECK( pSnap!=0 );
+      for(k=0; k<nRepeat; k++){
+        int nDetour = rand()%8, j;
+        for(j=0; j<nDetour; j++){
+          int iTok = rand()%(pTok->n-1);
+          feed(p, pTok, iTok, &c);
+        }
+        if( rand()%3==0 ){
+          /* Move to another parser, which has seen a token of its own */
+          CalcFree(p, free);
+          p = CalcAlloc(malloc);
+          feed(p, pTok, rand()%(pTok->n-1), &c);
+        }
+        nFail += CHECK( CalcRestore(p, pSnap)==0 );
+        c.nLog = nLog;
+        nRestore++;
+      }
+      CalcSnapshotFree(p, pSnap, free);
+    }
+    feed(p, pTok, i, &c);
+  }
+  CalcFree(p, free);
+  nFail += CHECK( nRestore>0 );
+  nFail += CHECK( same_log(&c, pRef, 0, pRef->nLog) );
+  nFail += CHECK( c.nOverflow==0 );
+  nFail += CHECK( c.nLive==0 );
+  ctx_clear(&c);
+  return nFail;
+}
+
+/*
+** Fork the parser at random offsets of *pTok and finish each fork on its
+** own.  Each must log the rest of the statements of the plain parse.
+** Return the number of failures.
+*/
+static int test_fork(const Tokens *pTok, const Ctx *pRef, unsigned int seed){
+  Ctx c;
+  void *p = CalcAlloc(malloc);
+  int i, nFail = 0, nFork = 0;
+  memset(&c, 0, sizeof(c));
+  srand(seed);
+  for(i=0; i<pTok->n; i++){
+    if( pTok->aMajor[i] && rand()%16==0 ){
+      void *pFork = CalcFork(p, malloc, free);
+      Ctx c2;
+      int nLog = c.nLog, j;
+      memset(&c2, 0, sizeof(c2));
+      nFail += CHECK( pFork!=0 );
+      for(j=i; j<pTok->n; j++) feed(pFork, pTok, j, &c2);
+      CalcFree(pFork, free);
+      nFail += CHECK( same_log(&c2, pRef, nLog, pRef->nLog) );
+      c.nLive += c2.nLive;
+      ctx_clear(&c2);
+      nFork++;
+    }
+    feed(p, pTok, i, &c);
+  }
+  CalcFree(p, free);
+  nFail += CHECK( nFork>0 );
+  nFail += CHECK( same_log(&c, pRef, 0, pRef->nLog) );
+  nFail += CHECK( c.nLive==0 );
+  ctx_clear(&c);
+  return nFail;
+}
+
+int main(int argc, char **argv){
+  unsigned int seed = argc>1 ? (unsigned int)atoi(argv[1]) : 1;
+  int mxDepth = argc>2 ? atoi(argv[2]) : 20;
+  int nFail = 0, k;
+  for(k=0; k<8; k++){
+    Tokens tok;
+    Ctx ref;
+    memset(&ref, 0, sizeof(ref));
+    tokens_make(&tok, seed+k, 200, mxDepth, k%2 ? 40 : 0);
+    parse_plain(&tok, &ref);
+    nFail += CHECK( ref.nLive==0 );
+    nFail += CHECK( ref.nOverflow==0 );
+    nFail += test_restore(&tok, &ref, seed+k);
+    nFail += test_fork(&tok, &ref, seed+k);
+    ctx_clear(&ref);
+    tokens_free(&tok);
+  }
+  printf("snapshot: %d failures\n", nFail);
+  return nFail!=0;
+}
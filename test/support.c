@@ -0,0 +1,162 @@
+/*
+** Values, logs and token streams shared by the tests of test/calc.y.
+*/
+#include "support.h"
+#include "calc.h"
+
+/* Allocate a node of value v */
+Node *node_new(Ctx *c, int v){
+  Node *p = (Node*)malloc(sizeof(*p));
+  if( p==0 ){
+    fprintf(stderr, "out of memory\n");
+    exit(1);
+  }
+  p->v = v;
+  p->magic = NODE_MAGIC;
+  c->nLive++;
+  return p;
+}
+
+/* Free a node.  A node that is not live is a fatal error. */
+void node_free(Ctx *c, Node *p){
+  if( p==0 ) return;
+  if( p->magic!=NODE_MAGIC ){
+    fprintf(stderr, "node freed twice or never allocated\n");
+    abort();
+  }
+  p->magic = 0;
+  c->nLive--;
+  free(p);
+}
+
+/* Replace *pp by a copy of itself, for YYSNAPSHOTCOPY */
+void node_copy(Ctx *c, Node **pp){
+  if( *pp ) *pp = node_new(c, (*pp)->v);
+}
+
+/* Return non-zero if two nodes, either of which may be NULL, are equal */
+int node_same(const Node *pA, const Node *pB){
+  if( pA==0 || pB==0 ) return pA==pB;
+  return pA->v==pB->v;
+}
+
+/* Combine two nodes, which are freed */
+Node *node_op(Ctx *c, Node *pL, int op, Node *pR){
+  int v;
+  switch( op ){
+    case '+': v = pL->v + pR->v; break;
+    case '-': v = pL->v - pR->v; break;
+    default:  v = pL->v * pR->v; break;
+  }
+  node_free(c, pL);
+  node_free(c, pR);
+  return node_new(c, ((v % 10007) + 10007) % 10007);
+}
+
+/* Append v to the log */
+void ctx_log(Ctx *c, int v){
+  if( c->nLog>=c->nLogAlloc ){
+    c->nLogAlloc = c->nLogAlloc*2 + 64;
+    c->aLog = (int*)realloc(c->aLog, c->nLogAlloc*sizeof(int));
+    if( c->aLog==0 ){
+      fprintf(stderr, "out of memory\n");
+      exit(1);
+    }
+  }
+  c->aLog[c->nLog++] = v;
+}
+
+/* Release the log and zero the counters */
+void ctx_clear(Ctx *c){
+  free(c->aLog);
+  memset(c, 0, sizeof(*c));
+}
+
+/*
+** A generator of random but reproducible token streams.
+*/
+typedef struct Gen Gen;
+struct Gen {
+  unsigned int seed;    /* State of the random number generator */
+  int mxDepth;          /* Deepest nesting of parentheses */
+  int nJunk;            /* One token in nJunk is random, or 0 for none */
+  Tokens *p;            /* The stream being built */
+  int nAlloc;           /* Slots allocated in p->aMajor[] and p->aVal[] */
+};
+static unsigned int gen_rand(Gen *g){
+  g->seed = g->seed*1103515245 + 12345;
+  return (g->seed>>16) & 0x7fff;
+}
+static void gen_token(Gen *g, int major, int v){
+  Tokens *p = g->p;
+  if( p->n>=g->nAlloc ){
+    g->nAlloc = g->nAlloc*2 + 64;
+    p->aMajor = (int*)realloc(p->aMajor, g->nAlloc*sizeof(int));
+    p->aVal = (int*)realloc(p->aVal, g->nAlloc*sizeof(int));
+    if( p->aMajor==0 || p->aVal==0 ){
+      fprintf(stderr, "out of memory\n");
+      exit(1);
+    }
+  }
+  if( major && g->nJunk && gen_rand(g)%g->nJunk==0 ){
+    major = 1 + gen_rand(g)%(SEMI>LP ? SEMI : LP);
+  }
+  p->aMajor[p->n] = major;
+  p->aVal[p->n] = v;
+  p->n++;
+}
+static void gen_expr(Gen *g, int depth){
+  static const int aOp[] = { PLUS, MINUS, TIMES };
+  int n = 1 + gen_rand(g)%3, i;
+  for(i=0; i<n; i++){
+    if( i>0 ) gen_token(g, aOp[gen_rand(g)%3], 0);
+    if( depth<g->mxDepth && gen_rand(g)%3==0 ){
+      gen_token(g, LP, 0);
+      gen_expr(g, depth+1);
+      gen_token(g, RP, 0);
+    }else{
+      gen_token(g, NUM, gen_rand(g)%100);
+    }
+  }
+}
+
+/*
+** Fill *p with nStmt statements from seed, nested up to mxDepth
+** parentheses deep.  If nJunk is not 0, one token in nJunk is replaced
+** by a random one.
+*/
+void tokens_make(Tokens *p, unsigned int seed, int nStmt, int mxDepth,
+                 int nJunk){
+  Gen g;
+  int i;
+  memset(p, 0, sizeof(*p));
+  g.seed = seed;
+  g.mxDepth = mxDepth;
+  g.nJunk = nJunk;
+  g.p = p;
+  g.nAlloc = 0;
+  for(i=0; i<nStmt; i++){
+    if( i==nStmt/2 ){
+      /* One statement nested as deep as allowed */
+      int j;
+      for(j=0; j<mxDepth; j++) gen_token(&g, LP, 0);
+      gen_token(&g, NUM, 1);
+      for(j=0; j<mxDepth; j++) gen_token(&g, RP, 0);
+    }else{
+      gen_expr(&g, 0);
+    }
+    gen_token(&g, SEMI, 0);
+  }
+  gen_token(&g, 0, 0);
+}
+
+void tokens_free(Tokens *p){
+  free(p->aMajor);
+  free(p->aVal);
+}
+
+/* Report a failed check.  Return the number of failures, 0 or 1. */
+int check(int ok, const char *zExpr, int iLine){
+  if( !ok ) fprintf(stderr, "line %d: check failed: %s\n", iLine, zExpr);
+  return !ok;
+}
@@ -0,0 +1,73 @@
+/*
+** Values, logs and token streams shared by the tests of test/calc.y.
+*/
+#ifndef _SUPPORT_H_
+#define _SUPPORT_H_
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The value of a token or a nonterminal */
+typedef struct Node Node;
+struct Node {
+  int v;                /* The value */
+  int magic;            /* NODE_MAGIC while the node is live */
+};
+#define NODE_MAGIC 0x4e6f6465
+
+/* The %extra_argument of the parsers */
+typedef struct Ctx Ctx;
+struct Ctx {
+  int nLive;            /* Nodes allocated and not yet freed */
+  int *aLog;            /* Value of each statement, -1 for a syntax error */
+  int nLog;             /* Entries used in aLog[] */
+  int nLogAlloc;        /* Entries allocated for aLog[] */
+  int nAccept;          /* Parses accepted */
+  int nFail;            /* Parses failed */
+  int nOverflow;        /* Stack overflows */
+};
+
+/* A stream of tokens of calc.y */
+typedef struct Tokens Tokens;
+struct Tokens {
+  int *aMajor;          /* Token codes, ending with 0 */
+  int *aVal;            /* Values of the NUM tokens */
+  int n;                /* Number of tokens, counting the final 0 */
+};
+
+/* The parser generated from calc.y */
+void *CalcAlloc(void *(*)(size_t));
+void CalcFree(void*, void (*)(void*));
+void Calc(void*, int, Node*, Ctx*);
+void *CalcSnapshot(void*, void *(*)(size_t));
+int CalcRestore(void*, void*);
+void CalcSnapshotFree(void*, void*, void (*)(void*));
+void *CalcFork(void*, void *(*)(size_t), void (*)(void*));
+int CalcSerialize(void*, unsigned char*, int,
+                  int (*)(void*,int,void*,unsigned char*,int), void*);
+int CalcDeserialize(void*, const unsigned char*, int,
+                    int (*)(void*,int,void*,const unsigned char*,int), void*,
+                    Ctx*);
+void CalcCheckpoints(void*, int, size_t, void *(*)(size_t), void (*)(void*));
+void CalcCheckpoint(void*);
+int CalcResume(void*, int, int, int);
+int CalcSynced(void*);
+int calc_write_value(void*, int, void*, unsigned char*, int);
+int calc_read_value(void*, int, void*, const unsigned char*, int);
+
+Node *node_new(Ctx*, int);
+void node_free(Ctx*, Node*);
+void node_copy(Ctx*, Node**);
+int node_same(const Node*, const Node*);
+Node *node_op(Ctx*, Node*, int, Node*);
+void ctx_log(Ctx*, int);
+void ctx_clear(Ctx*);
+void tokens_make(Tokens*, unsigned int, int, int, int);
+void tokens_free(Tokens*);
+int check(int, const char*, int);
+
+#define CHECK(X) check((X), #X, __LINE__)
+
+#endif /* _SUPPORT_H_ */